@@ -0,0 +1,263 @@
+/***************************************************************************
+                          analyze.c  -  description
+                             -------------------
+    begin                : 2026/10/19
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/***** INCLUDES ************************************************************/
+
+#include <limits.h>
+#include "analyze.h"
+
+/***** DEFINITIONS *********************************************************/
+
+#define STATS_CACHE_MAGIC "LBreakoutHD level stats 2"
+
+/***** LOCAL FUNCTIONS *****************************************************/
+
+static int compare_int( const void *a, const void *b )
+{
+	int i = *(const int*)a, j = *(const int*)b;
+	return ( i > j ) - ( i < j );
+}
+
+/* median of 'count' values where INT_MAX means failed: -1 if less
+ * than half succeeded */
+static int median( int *values, int count )
+{
+	qsort( values, count, sizeof( int ), compare_int );
+	if ( values[count / 2] == INT_MAX )
+		return -1;
+	return values[count / 2];
+}
+
+/* return position of 'hash' in cache or where it would be inserted */
+static int stats_cache_find( StatsCache *cache, unsigned long long hash )
+{
+	int l = 0, r = cache->count, m;
+
+	while ( l < r ) {
+		m = ( l + r ) / 2;
+		if ( cache->stats[m].hash < hash )
+			l = m + 1;
+		else
+			r = m;
+	}
+	return l;
+}
+
+/* add empty stats for 'hash' unless already present */
+static void stats_cache_add( StatsCache *cache, unsigned long long hash )
+{
+	int pos = stats_cache_find( cache, hash );
+
+	if ( pos < cache->count && cache->stats[pos].hash == hash )
+		return;
+	if ( cache->count == cache->size ) {
+		cache->size = cache->size ? 2 * cache->size : 256;
+		cache->stats = realloc( cache->stats, cache->size * sizeof( LevelStats ) );
+	}
+	memmove( &cache->stats[pos + 1], &cache->stats[pos],
+			( cache->count - pos ) * sizeof( LevelStats ) );
+	memset( &cache->stats[pos], 0, sizeof( LevelStats ) );
+	cache->stats[pos].hash = hash;
+	cache->count++;
+}
+
+/* remove stats for 'hash' if present */
+static void stats_cache_remove( StatsCache *cache, unsigned long long hash )
+{
+	int pos = stats_cache_find( cache, hash );
+
+	if ( pos == cache->count || cache->stats[pos].hash != hash )
+		return;
+	memmove( &cache->stats[pos], &cache->stats[pos + 1],
+			( cache->count - pos - 1 ) * sizeof( LevelStats ) );
+	cache->count--;
+}
+
+/* fill stats of 'level' from its static layout and 'attempts' results */
+static void level_stats_set( LevelStats *stats, Level *level,
+		int rel_warp_limit, SimJob *jobs, int attempts )
+{
+	int *times = salloc( attempts, sizeof( int ) );
+	int *warp_times = salloc( attempts, sizeof( int ) );
+	int i, lost = 0;
+
+	stats->attempts = attempts;
+	stats->cleared = stats->warp_reached = 0;
+	for ( i = 0; i < attempts; i++ ) {
+		SimResult *r = &jobs[i].result;
+		times[i] = r->cleared ? r->time : INT_MAX;
+		warp_times[i] = r->warp_time >= 0 ? r->warp_time : INT_MAX;
+		stats->cleared += r->cleared;
+		stats->warp_reached += ( r->warp_time >= 0 );
+		lost += r->balls_lost;
+	}
+	stats->clear_time = median( times, attempts );
+	stats->warp_time = median( warp_times, attempts );
+	stats->balls_lost = (float)lost / attempts;
+
+	/* same as bricks_init() */
+	stats->bricks = level->normal_brick_count;
+	stats->warp_limit = ( 100 - rel_warp_limit ) * level->normal_brick_count / 100;
+	level_get_unreachable( level, &stats->walled, &stats->energy );
+
+	free( times );
+	free( warp_times );
+}
+
+/***** PUBLIC FUNCTIONS ****************************************************/
+
+/* load cache from file. if 'fname' is NULL, the file does not exist
+ * or was created with other settings an empty cache is returned. */
+StatsCache *stats_cache_load( const char *fname, SimConfig *cfg, int attempts, unsigned int seed )
+{
+	StatsCache *cache = salloc( 1, sizeof( StatsCache ) );
+	SimConfig fcfg;
+	LevelStats s;
+	char magic[64];
+	unsigned int fseed;
+	int fversion, fattempts, count, i;
+	FILE *file;
+
+	cache->cfg = *cfg;
+	cache->attempts = attempts;
+	cache->seed = seed;
+	if ( fname == 0 || ( file = fopen( fname, "r" ) ) == 0 )
+		return cache;
+
+	memset( &fcfg, 0, sizeof( SimConfig ) );
+	if ( fgets( magic, sizeof( magic ), file ) == 0 ||
+			strncmp( magic, STATS_CACHE_MAGIC, strlen( STATS_CACHE_MAGIC ) ) ||
+			fscanf( file, "%d %d %d %d %d %d %d %u %d", &fversion,
+				&fcfg.skill, &fcfg.diff, &fcfg.rel_warp_limit,
+				&fcfg.max_time, &fcfg.step,
+				&fattempts, &fseed, &count ) != 9 ||
+			fversion != GAME_LOGIC_VERSION ||
+			memcmp( &fcfg, cfg, sizeof( SimConfig ) ) ||
+			fattempts != attempts || fseed != seed ) {
+		fclose( file );
+		return cache;
+	}
+	for ( i = 0; i < count; i++ ) {
+		if ( fscanf( file, "%llx %d %d %d %f %d %d %d %d %d %d",
+				&s.hash, &s.attempts, &s.cleared, &s.clear_time,
+				&s.balls_lost, &s.bricks, &s.walled, &s.energy,
+				&s.warp_limit, &s.warp_reached, &s.warp_time ) != 11 ) {
+			fprintf( stderr, "%s: broken entry %d\n", fname, i );
+			break;
+		}
+		stats_cache_add( cache, s.hash );
+		*stats_cache_get( cache, s.hash ) = s;
+	}
+	fclose( file );
+	return cache;
+}
+int stats_cache_save( StatsCache *cache, const char *fname )
+{
+	SimConfig *cfg = &cache->cfg;
+	LevelStats *s;
+	FILE *file;
+	int i, count = 0;
+
+	if ( ( file = fopen( fname, "w" ) ) == 0 ) {
+		fprintf( stderr, "couldn't open %s\n", fname );
+		return 0;
+	}
+	for ( i = 0; i < cache->count; i++ )
+		if ( cache->stats[i].attempts > 0 )
+			count++;
+	fprintf( file, "%s\n%d %d %d %d %d %d %d %u %d\n", STATS_CACHE_MAGIC,
+			GAME_LOGIC_VERSION,
+			cfg->skill, cfg->diff, cfg->rel_warp_limit, cfg->max_time,
+			cfg->step, cache->attempts, cache->seed, count );
+	for ( i = 0; i < cache->count; i++ ) {
+		s = &cache->stats[i];
+		if ( s->attempts == 0 )
+			continue;
+		fprintf( file, "%016llx %d %d %d %.2f %d %d %d %d %d %d\n",
+				s->hash, s->attempts, s->cleared, s->clear_time,
+				s->balls_lost, s->bricks, s->walled, s->energy,
+				s->warp_limit, s->warp_reached, s->warp_time );
+	}
+	fclose( file );
+	return 1;
+}
+void stats_cache_delete( StatsCache **cache )
+{
+	if ( *cache == 0 )
+		return;
+	free( (*cache)->stats );
+	free( *cache );
+	*cache = 0;
+}
+
+/* return cached stats of level with 'hash' or NULL */
+LevelStats *stats_cache_get( StatsCache *cache, unsigned long long hash )
+{
+	int pos = stats_cache_find( cache, hash );
+
+	if ( pos < cache->count && cache->stats[pos].hash == hash )
+		return &cache->stats[pos];
+	return 0;
+}
+
+/* analyze all levels not yet in cache by running simulations with the
+ * settings of the cache in parallel (see sim_run()) and add them to it.
+ * 'stats' (may be NULL) is filled with the results in order of 'levels'.
+ * Return number of newly analyzed levels or -1 if 'cancel' (may be NULL)
+ * was set by another thread, the cache is unchanged then. */
+int levels_analyze( Level **levels, int count, StatsCache *cache,
+		int threads, LevelStats *stats, SDL_atomic_t *cancel )
+{
+	int attempts = cache->attempts;
+	Level **queue = salloc( count, sizeof( Level* ) );
+	SimJob *jobs;
+	int i, k, queued = 0;
+
+	/* identical levels are only played once */
+	for ( i = 0; i < count; i++ ) {
+		if ( stats_cache_get( cache, levels[i]->hash ) )
+			continue;
+		stats_cache_add( cache, levels[i]->hash );
+		queue[queued++] = levels[i];
+	}
+
+	if ( queued > 0 ) {
+		jobs = salloc( queued * attempts, sizeof( SimJob ) );
+		for ( i = 0; i < queued; i++ )
+			for ( k = 0; k < attempts; k++ ) {
+				jobs[i * attempts + k].level = queue[i];
+				jobs[i * attempts + k].seed = cache->seed + k;
+			}
+		if ( sim_run( jobs, queued * attempts, &cache->cfg, threads, cancel ) == 0 ) {
+			/* canceled: incomplete results are not kept */
+			for ( i = 0; i < queued; i++ )
+				stats_cache_remove( cache, queue[i]->hash );
+			free( jobs );
+			free( queue );
+			return -1;
+		}
+		for ( i = 0; i < queued; i++ )
+			level_stats_set( stats_cache_get( cache, queue[i]->hash ),
+					queue[i], cache->cfg.rel_warp_limit,
+					&jobs[i * attempts], attempts );
+		free( jobs );
+	}
+
+	if ( stats )
+		for ( i = 0; i < count; i++ )
+			stats[i] = *stats_cache_get( cache, levels[i]->hash );
+	free( queue );
+	return queued;
+}
@@ -0,0 +1,74 @@
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef __ANALYZE_H
+#define __ANALYZE_H
+
+/***** INCLUDES ************************************************************/
+
+#include "sim.h"
+
+/***** TYPE DEFINITIONS ****************************************************/
+
+/* difficulty and solvability of a level. times are medians of all
+ * attempts with failed attempts counting as slowest, -1 if less than
+ * half of the attempts succeeded. */
+typedef struct {
+	unsigned long long hash; 	/* level content, see level_update_hash() */
+	int	attempts; 		/* 0 if not analyzed yet */
+	int	cleared; 		/* attempts that cleared all bricks */
+	int	clear_time; 		/* median in ms */
+	float	balls_lost; 		/* average per attempt */
+	int	bricks; 		/* destructible bricks */
+	int	walled; 		/* bricks not reachable at all */
+	int	energy; 		/* bricks only reachable by energy ball */
+	int	warp_limit; 		/* warp if less bricks are left */
+	int	warp_reached; 		/* attempts that reached warp limit */
+	int	warp_time; 		/* median in ms */
+} LevelStats;
+
+/* stats of analyzed levels by hash. results are only valid for the
+ * settings and GAME_LOGIC_VERSION they have been created with so the
+ * cache is bound to them. */
+typedef struct {
+	SimConfig cfg;
+	int	attempts; 	/* per level */
+	unsigned int seed; 	/* of first attempt */
+	LevelStats *stats; 	/* sorted by hash */
+	int	count, size;
+} StatsCache;
+
+/***** PUBLIC FUNCTIONS ****************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* load cache from file. if 'fname' is NULL, the file does not exist
+ * or was created with other settings an empty cache is returned. */
+StatsCache *stats_cache_load( const char *fname, SimConfig *cfg, int attempts, unsigned int seed );
+int stats_cache_save( StatsCache *cache, const char *fname );
+void stats_cache_delete( StatsCache **cache );
+
+/* return cached stats of level with 'hash' or NULL */
+LevelStats *stats_cache_get( StatsCache *cache, unsigned long long hash );
+
+/* analyze all levels not yet in cache by running simulations with the
+ * settings of the cache in parallel (see sim_run()) and add them to it.
+ * 'stats' (may be NULL) is filled with the results in order of 'levels'.
+ * Return number of newly analyzed levels or -1 if 'cancel' (may be NULL)
+ * was set by another thread, the cache is unchanged then. */
+int levels_analyze( Level **levels, int count, StatsCache *cache,
+		int threads, LevelStats *stats, SDL_atomic_t *cancel );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
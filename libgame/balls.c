@@ -34,11 +34,11 @@ int ball_rad = 6;
 int ball_dia = 12;
 int ball_w = 12;
 int ball_h = 12;
-extern Game *cur_game;
+extern GAME_TLS Game *cur_game;
 
-int last_ball_brick_reflect_x = -1; /* HACK: used to play local sound */
-int last_ball_paddle_reflect_x = -1; /* HACK: used to play local sound */
-int last_ball_attach_x = -1; /* HACK: used to play local sound */
+GAME_TLS int last_ball_brick_reflect_x = -1; /* HACK: used to play local sound */
+GAME_TLS int last_ball_paddle_reflect_x = -1; /* HACK: used to play local sound */
+GAME_TLS int last_ball_attach_x = -1; /* HACK: used to play local sound */
 
 /*
 ====================================================================
@@ -67,6 +67,164 @@ static void ball_print_target_info( Ball *ball )
 }
 #endif
 
+/*
+====================================================================
+Fixed point physics (cur_game->fixed_physics): ball integration,
+targets and reflections only use integer math so the result does
+not depend on compiler, CPU or optimization. Positions are kept in
+1/1024 pixels and velocities in 1/2^20 pixels per ms. Both fit
+into the mantissa of a float so Ball keeps its float members which
+are always on this grid. Perpendiculars use the unit of positions.
+====================================================================
+*/
+enum {
+	FIX_POS = 10,
+	FIX_VEL = 20,
+	FIX_VHMASK = 23853, /* ball_vhmask * 65536 */
+	FIX_VVMASK = 371674 /* ball_vvmask * 65536 */
+};
+static int fix_pos( float v )
+{
+	return (int)floor( (double)v * ( 1 << FIX_POS ) + 0.5 );
+}
+static float unfix_pos( int v )
+{
+	return (float)v / ( 1 << FIX_POS );
+}
+static int fix_vel( double v )
+{
+	return (int)floor( v * ( 1 << FIX_VEL ) + 0.5 );
+}
+static float unfix_vel( int v )
+{
+	return (float)v / ( 1 << FIX_VEL );
+}
+/* a / 2^shift rounded to nearest */
+static int fix_div( long long a, int shift )
+{
+	if ( a < 0 )
+		return -(int)( ( -a + ( 1LL << ( shift - 1 ) ) ) >> shift );
+	return (int)( ( a + ( 1LL << ( shift - 1 ) ) ) >> shift );
+}
+/* move ball along its velocity */
+static void ball_move_fixed( Ball *b, int ms )
+{
+	b->cur.x = unfix_pos( fix_pos( b->cur.x ) +
+			fix_div( (long long)fix_vel( b->vel.x ) * ms, FIX_VEL - FIX_POS ) );
+	b->cur.y = unfix_pos( fix_pos( b->cur.y ) +
+			fix_div( (long long)fix_vel( b->vel.y ) * ms, FIX_VEL - FIX_POS ) );
+}
+/* set velocity in 2 degree steps from direction vx,vy (any unit) */
+static void ball_set_vel_fixed( Ball *b, int vx, int vy, double v )
+{
+	b->angle = fvec2angle( vx, vy );
+	angle2fvec( b->angle, &vx, &vy );
+	fvec_set_length( &vx, &vy, fix_vel( v ) );
+	b->vel.x = unfix_vel( vx );
+	b->vel.y = unfix_vel( vy );
+}
+/* set speed without changing direction */
+static void ball_set_speed_fixed( Ball *b, int v )
+{
+	int vx = fix_vel( b->vel.x ), vy = fix_vel( b->vel.y );
+
+	fvec_set_length( &vx, &vy, v );
+	b->vel.x = unfix_vel( vx );
+	b->vel.y = unfix_vel( vy );
+}
+static void ball_set_speed( Ball *b, double v )
+{
+	if ( cur_game->fixed_physics )
+		ball_set_speed_fixed( b, fix_vel( v ) );
+	else
+		vector_set_length( &b->vel, v );
+}
+/* reflect vx,vy at perp (see ball_reflect_vel()) */
+static void fix_reflect( int *vx, int *vy, Vector perp )
+{
+	long long px = fix_pos( perp.x ), py = fix_pos( perp.y );
+	long long dot = px * *vx + py * *vy;
+
+	*vx -= (int)( 2 * px * dot / ( 1LL << ( 2 * FIX_POS ) ) );
+	*vy -= (int)( 2 * py * dot / ( 1LL << ( 2 * FIX_POS ) ) );
+}
+/* same as ball_mask_vel() for vx,vy of any unit */
+static void fix_mask_vel( int *vx, int *vy, int old_vx, int entropy )
+{
+	long long ax, ay;
+	int entropy_level = 0; /* per mille */
+
+	if ( *vx == 0 && *vy == 0 ) return;
+
+	if ( *vx == 0 )
+		*vx = ( old_vx < 0 ) ? 1 : -1;
+
+	if ( entropy == BALL_ADD_ENTROPY )
+		entropy_level = ( GAME_RAND() % 81 ) + 40;
+
+	ax = abs( *vx ); ay = abs( *vy );
+	if ( ay * 65536 < FIX_VHMASK * ax ) {
+		/* mask angles from 70 to 110 and -110 to -70 */
+		*vy = (int)( FIX_VHMASK * ax / 65536 ) * ( ( *vy < 0 ) ? -1 : 1 );
+		if ( entropy == BALL_ADD_ENTROPY )
+			*vx -= *vx * entropy_level / 1000;
+	}
+	else
+		if ( ay * 65536 > FIX_VVMASK * ax ) {
+			/* mask angles from -10 to 10 and 170 to 190 */
+			*vx = (int)( ay * 65536 / FIX_VVMASK ) * ( ( *vx < 0 ) ? -1 : 1 );
+			if ( entropy == BALL_ADD_ENTROPY )
+				*vx += *vx * entropy_level / 1000;
+		}
+		else
+			if ( entropy == BALL_ADD_ENTROPY ) {
+				if ( GAME_RAND() % 2 )
+					entropy_level = -entropy_level;
+				*vx += *vx * entropy_level / 1000;
+			}
+
+	/* avoid 45� angles */
+	if ( *vx == *vy )
+		*vx = *vx * 98 / 100;
+}
+/* reflect at target like ball_reflect_vel() */
+static void ball_reflect_vel_fixed( Ball *b, int chaos_reflect, int entropy )
+{
+	int vx = fix_vel( b->vel.x ), vy = fix_vel( b->vel.y ), old_vx = vx;
+
+	if ( !chaos_reflect )
+		fix_reflect( &vx, &vy, b->target.perp_vector );
+	else {
+		vx = GAME_RANDOM( -10000, 10000 ) * ( ( 1 << FIX_VEL ) / 10000 );
+		vy = GAME_RANDOM( -10000, 10000 ) * ( ( 1 << FIX_VEL ) / 10000 );
+	}
+	if ( b->target.side >= CORNER_UPPER_LEFT && !chaos_reflect )
+		fix_mask_vel( &vx, &vy, old_vx, entropy );
+	else
+		fix_mask_vel( &vx, &vy, old_vx, BALL_NO_ENTROPY );
+	ball_set_vel_fixed( b, vx, vy, cur_game->ball_v );
+}
+/* reflect at paddle like ball_handle_paddle_contact(), return 0 if
+ * the ball would not be brought back to the playing field */
+static int ball_reflect_at_paddle_fixed( Ball *b, Paddle *paddle, Vector perp )
+{
+	int vx = fix_vel( b->vel.x ), vy = fix_vel( b->vel.y ), old_vx = vx;
+
+	fix_reflect( &vx, &vy, perp );
+	if ( (paddle->type == PADDLE_TOP && vy < 0) ||
+	     (paddle->type == PADDLE_BOTTOM && vy > 0) )
+		return 0;
+
+	/* normal paddle has friction if middle part was hit */
+	if ( !cur_game->paddle_is_convex && perp.x == 0 )
+		vx += fix_div( (long long)fix_vel( paddle->v_x ) *
+				fix_pos( paddle->friction ), FIX_POS );
+
+	fix_mask_vel( &vx, &vy, old_vx, BALL_NO_ENTROPY );
+	ball_set_vel_fixed( b, vx, vy, cur_game->ball_v );
+	return 1;
+}
+
 /*
 ====================================================================
 Clear contents of target.
@@ -99,13 +257,49 @@ void ball_attach( Ball *ball, Paddle *paddle )
 }
 /*
 ====================================================================
+Set velocity of ball reflected at its target (normed perp_vector).
+Corner reflections get a little entropy if 'entropy' is
+BALL_ADD_ENTROPY.
+====================================================================
+*/
+static void ball_reflect_vel( Ball *b, int chaos_reflect, int entropy )
+{
+	float old_vx = b->vel.x;
+	Vector n;
+
+	if ( cur_game->fixed_physics ) {
+		ball_reflect_vel_fixed( b, chaos_reflect, entropy );
+		return;
+	}
+	if ( !chaos_reflect ) {
+		/* normal reflection */
+		n.x = (1-2*b->target.perp_vector.x*b->target.perp_vector.x)*b->vel.x + 
+		      ( -2*b->target.perp_vector.x*b->target.perp_vector.y)*b->vel.y;
+		n.y = ( -2*b->target.perp_vector.x*b->target.perp_vector.y)*b->vel.x + 
+		      (1-2*b->target.perp_vector.y*b->target.perp_vector.y)*b->vel.y;
+		b->vel.x = n.x;
+		b->vel.y = n.y;
+	}
+	else {
+		b->vel.x = ((float)GAME_RANDOM( -10000, 10000 )) / 10000;
+		b->vel.y = (float)(GAME_RANDOM( -10000, 10000 )) / 10000;
+	}	
+	if ( b->target.side >= CORNER_UPPER_LEFT && !chaos_reflect )
+		ball_mask_vel( b, old_vx, entropy );
+	else
+		ball_mask_vel( b, old_vx, BALL_NO_ENTROPY );
+	/* only use 2 degree steps */
+	b->angle = vec2angle( &b->vel );
+	angle2vec( b->angle, &b->vel );
+	vector_set_length( &b->vel, cur_game->ball_v );
+}
+/*
+====================================================================
 Reflect ball at brick assume normed perp_vector.
 ====================================================================
 */
 void ball_check_brick_reflection( Ball *b )
 {
-	float old_vx;
-	Vector n;
 	int reflect;
 	int chaos_reflect;
 	int hit_type;
@@ -173,37 +367,16 @@ void ball_check_brick_reflection( Ball *b )
 	if ( reflect ) {
 		cur_game->mod.brick_reflected_ball_count++;
                 last_ball_brick_reflect_x = b->x; /* HACK: used to play local sound */
-		old_vx = b->vel.x;
-		if ( !chaos_reflect ) {
-			/* normal reflection */
-			n.x = (1-2*b->target.perp_vector.x*b->target.perp_vector.x)*b->vel.x + 
-			      ( -2*b->target.perp_vector.x*b->target.perp_vector.y)*b->vel.y;
-			n.y = ( -2*b->target.perp_vector.x*b->target.perp_vector.y)*b->vel.x + 
-			      (1-2*b->target.perp_vector.y*b->target.perp_vector.y)*b->vel.y;
-			b->vel.x = n.x;
-			b->vel.y = n.y;
-		}
-		else {
-			b->vel.x = ((float)RANDOM( -10000, 10000 )) / 10000;
-			b->vel.y = (float)(RANDOM( -10000, 10000 )) / 10000;
-		}	
-		if ( b->target.side >= CORNER_UPPER_LEFT && !chaos_reflect )
-			ball_mask_vel( b, old_vx, BALL_ADD_ENTROPY );
-		else
-			ball_mask_vel( b, old_vx, BALL_NO_ENTROPY );
-		/* only use 2 degree steps */
-		b->angle = vec2angle( &b->vel );
-		angle2vec( b->angle, &b->vel );
-		vector_set_length( &b->vel, cur_game->ball_v );
+		ball_reflect_vel( b, chaos_reflect, BALL_ADD_ENTROPY );
 
 		/* reset contact time: this ball is working for its paddle so it
 		 * was cheating if it would be allowed to bring a new ball to 
 		 * game */
-		b->paddle->last_ball_contact = SDL_GetTicks();
+		b->paddle->last_ball_contact = cur_game->time;
 	}
 	
 	/* remove brick -- if weak ball there is a 40% chance that no damage is done to the brick */
-	if ( !cur_game->extra_active[EX_WEAK_BALL] || rand() % 10 < 6 ) {
+	if ( !cur_game->extra_active[EX_WEAK_BALL] || GAME_RAND() % 10 < 6 ) {
 		/* if explosive ball und brick is destructible by normal means set as explosive */
 		if ( cur_game->extra_active[EX_EXPL_BALL] )
 		if ( cur_game->bricks[b->target.mx][b->target.my].dur > 0 ) {
@@ -244,31 +417,37 @@ void ball_handle_paddle_contact( Ball *ball, Paddle *paddle, Vector perp_vector
 		return;
 	
 	/* reflect */
-	/* a simple 2x2 matrix does this for us */
-	c.x = (1-2*perp_vector.x*perp_vector.x)*ball->vel.x + 
-	      ( -2*perp_vector.x*perp_vector.y)*ball->vel.y;
-	c.y = ( -2*perp_vector.x*perp_vector.y)*ball->vel.x + 
-	      (1-2*perp_vector.y*perp_vector.y)*ball->vel.y;
-	/* if this new velocity vector does not bring back the ball to the playing field
-	   thus the lower hemispherical parts of the paddle were hit we consider this
-	   to be no reflection at all to prevent balls from getting stuck when 'bonus floor'
-	   is active */
-	if ( (paddle->type == PADDLE_TOP && c.y < 0) ||
-  	     (paddle->type == PADDLE_BOTTOM && c.y > 0) )
-		return;
-
-	/* set new speed vector */
-	ball->vel.x = c.x; ball->vel.y = c.y;
-
-	/* normal paddle has friction if middle part was hit */
-	if (!cur_game->paddle_is_convex && perp_vector.x == 0)
-		ball->vel.x += paddle->v_x * paddle->friction;
+	if ( cur_game->fixed_physics ) {
+		if ( !ball_reflect_at_paddle_fixed( ball, paddle, perp_vector ) )
+			return;
+	}
+	else {
+		/* a simple 2x2 matrix does this for us */
+		c.x = (1-2*perp_vector.x*perp_vector.x)*ball->vel.x + 
+		      ( -2*perp_vector.x*perp_vector.y)*ball->vel.y;
+		c.y = ( -2*perp_vector.x*perp_vector.y)*ball->vel.x + 
+		      (1-2*perp_vector.y*perp_vector.y)*ball->vel.y;
+		/* if this new velocity vector does not bring back the ball to the playing field
+		   thus the lower hemispherical parts of the paddle were hit we consider this
+		   to be no reflection at all to prevent balls from getting stuck when 'bonus floor'
+		   is active */
+		if ( (paddle->type == PADDLE_TOP && c.y < 0) ||
+		     (paddle->type == PADDLE_BOTTOM && c.y > 0) )
+			return;
+
+		/* set new speed vector */
+		ball->vel.x = c.x; ball->vel.y = c.y;
+
+		/* normal paddle has friction if middle part was hit */
+		if (!cur_game->paddle_is_convex && perp_vector.x == 0)
+			ball->vel.x += paddle->v_x * paddle->friction;
 
-	ball_mask_vel( ball, old_vx, BALL_NO_ENTROPY );
-	/* only use 2 degree steps */
-	ball->angle = vec2angle( &ball->vel );
-	angle2vec( ball->angle, &ball->vel );
-	vector_set_length( &ball->vel, cur_game->ball_v );
+		ball_mask_vel( ball, old_vx, BALL_NO_ENTROPY );
+		/* only use 2 degree steps */
+		ball->angle = vec2angle( &ball->vel );
+		angle2vec( ball->angle, &ball->vel );
+		vector_set_length( &ball->vel, cur_game->ball_v );
+	}
 	
 	/* reset position if in wall */
 	if ( ball->x < BRICK_WIDTH ) {
@@ -310,7 +489,7 @@ void ball_handle_paddle_contact( Ball *ball, Paddle *paddle, Vector perp_vector
 	ball->get_target = 1;
 
 	/* reset contact time */
-	paddle->last_ball_contact = SDL_GetTicks();
+	paddle->last_ball_contact = cur_game->time;
 }
 /*
 ====================================================================
@@ -372,6 +551,83 @@ the ball before update. Used to compute direction.
 ====================================================================
 */
 enum { CONTACT_LEFT = 1, CONTACT_MIDDLE, CONTACT_RIGHT };
+static void ball_check_paddle_reflection_fixed( Ball *ball, Paddle *paddle )
+{
+	/* same as below with positions in 1/1024 pixels */
+	int     unit = 1 << FIX_POS;
+	int     cx = fix_pos( ball->cur.x ) + ball_rad * unit;
+	int     cy = fix_pos( ball->cur.y ) + ball_rad * unit;
+	int     vx = fix_vel( ball->vel.x ), vy = fix_vel( ball->vel.y );
+	int     hemi_y = paddle->y + ( paddle->h >> 1 );
+	int     left_hemi_x = paddle->x + ( paddle->h >> 1 );
+	int     right_hemi_x = paddle->x + paddle->w - ( paddle->h >> 1 );
+	int     hemi_r = ( ball_rad ) + ( paddle->h >> 1 );
+	int     paddle_center_x = paddle->x + ( paddle->w >> 1 );
+	int     hx, dx, dy, nx, ny, b, s, pt_x, pt_y, contact = 0;
+	long long dist, t;
+	Vector  perp_vector;
+
+	if ( vy == 0 )
+		return;
+	/* intersect ball line with imaginary paddle line */
+	if ( paddle->type == PADDLE_TOP )
+		pt_y = ( paddle->y + paddle->h - 1 + ball_rad ) * unit;
+	else
+		pt_y = ( paddle->y - ball_rad ) * unit;
+	pt_x = cx + (int)( (long long)( pt_y - cy ) * vx / vy );
+	if ( pt_x < left_hemi_x * unit || pt_x > right_hemi_x * unit ) {
+		/* intersect hemisphere if ball center is inside of it */
+		hx = ( pt_x < left_hemi_x * unit ) ? left_hemi_x : right_hemi_x;
+		dx = cx - hx * unit;
+		dy = cy - hemi_y * unit;
+		dist = (long long)dx * dx + (long long)dy * dy;
+		if ( dist <= (long long)hemi_r * unit * hemi_r * unit ) {
+			/* solve |center + t * norm_vel - hemi_center| = hemi_r */
+			nx = vx; ny = vy;
+			fvec_set_length( &nx, &ny, unit );
+			b = (int)( ( (long long)nx * dx + (long long)ny * dy ) / unit );
+			s = isqrt( (long long)b * b - dist +
+					(long long)hemi_r * unit * hemi_r * unit );
+			/* use lower point for top paddle and upper point for
+			 * bottom paddle */
+			t = -b + s;
+			if ( ( paddle->type == PADDLE_TOP ) != ( ny * t > ny * (-b - s) ) )
+				t = -b - s;
+			pt_x = cx + (int)( t * nx / unit );
+			pt_y = cy + (int)( t * ny / unit );
+			/* use vector between hemi_sphere center and ball center
+			 * as reflection perp */
+			fvec_set_length( &dx, &dy, unit );
+			perp_vector = vector_get( unfix_pos( dx ), unfix_pos( dy ) );
+			contact = ( hx == left_hemi_x ) ? CONTACT_LEFT : CONTACT_RIGHT;
+		}
+	}
+	else {
+		contact = CONTACT_MIDDLE; /* contact with middle part */
+		perp_vector = vector_get( 0, 1 ); /* reflect at horizontal line */
+	}
+
+	if ( contact ) {
+		/* reset idle time */
+		ball->idle_time = 0;
+		/* reset position if ball will be attached */
+		if ( paddle_slimy( paddle ) ) {
+			ball->cur.x = unfix_pos( pt_x - ball_rad * unit );
+			ball->cur.y = unfix_pos( pt_y - ball_rad * unit );
+			ball->x = (int)ball->cur.x; ball->y = (int)ball->cur.y;
+		}
+		/* convex perpendicular: from intersection to the crossing of
+		 * paddle center and the 45 degree line through left hemisphere */
+		if ( cur_game->paddle_is_convex ) {
+			dy = ( paddle->type == PADDLE_TOP ) ? -1 : 1;
+			perp_vector.x = unfix_pos( paddle_center_x * unit - pt_x );
+			perp_vector.y = unfix_pos( ( hemi_y + dy * ( paddle_center_x -
+						left_hemi_x ) ) * unit - pt_y );
+		}
+		/* handle contact: attach, reflect, sound... */
+		ball_handle_paddle_contact( ball, paddle, perp_vector );
+	}
+}
 void ball_check_paddle_reflection( Ball *ball, Paddle *paddle )
 {
 	Line    ball_line; /* balls velocity line */
@@ -401,6 +657,11 @@ void ball_check_paddle_reflection( Ball *ball, Paddle *paddle )
 	 * by velocity and position of ball that it hits the paddle 
 	 */
 
+	if ( cur_game->fixed_physics ) {
+		ball_check_paddle_reflection_fixed( ball, paddle );
+		return;
+	}
+
 	/*  basic idea:
 	    The paddle is constructed of a middle rectangle and two hemispheres.
 	    We check the center line of the ball with the imaginary paddle that's size
@@ -961,9 +1222,15 @@ void balls_update( int ms )
 					else
 						ball->vel.y = -1.2;
 					/* only use 2 degree steps */
-					ball->angle = vec2angle( &ball->vel );
-					angle2vec( ball->angle, &ball->vel );
-					vector_set_length( &ball->vel, cur_game->ball_v );
+					if ( cur_game->fixed_physics )
+						ball_set_vel_fixed( ball, 10 * fire_dir,
+								ball->vel.y < 0 ? -12 : 12,
+								cur_game->ball_v );
+					else {
+						ball->angle = vec2angle( &ball->vel );
+						angle2vec( ball->angle, &ball->vel );
+						vector_set_length( &ball->vel, cur_game->ball_v );
+					}
 				}
 				ball->get_target = 1;
 				list_add( cur_game->balls, ball );
@@ -975,7 +1242,7 @@ void balls_update( int ms )
 		 * then in NMP a ball is created and attached */
 		if ( cur_game->game_type == GT_NETWORK && cur_game->level_type != LT_PINGPONG )
 		if ( cur_game->paddles[i]->attached_ball_count == 0 )
-		if ( SDL_GetTicks() >= cur_game->paddles[i]->last_ball_contact + BALL_RESPAWN_TIME ) {
+		if ( cur_game->time >= cur_game->paddles[i]->last_ball_contact + BALL_RESPAWN_TIME ) {
 			x = cur_game->paddles[i]->x + (cur_game->paddles[i]->w - ball_w) / 2;
 			if ( cur_game->paddles[i]->type == PADDLE_BOTTOM )
 				y = cur_game->paddles[i]->y - ball_dia;
@@ -1003,8 +1270,9 @@ void balls_update( int ms )
                 if ( cur_game->extra_active[EX_FAST] )
                     cur_game->ball_v = cur_game->ball_v_max;
                 else
+                    /* in double to be exact as in balls_inc_vel() */
                     cur_game->ball_v = cur_game->diff->v_start + 
-                        cur_game->diff->v_add * cur_game->speedup_level;
+                        (double)cur_game->diff->v_add * cur_game->speedup_level;
             }
         }
         
@@ -1022,7 +1290,18 @@ void balls_update( int ms )
 			double v = cur_game->ball_v +
 					p*(cur_game->accelerated_ball_speed
 							- cur_game->ball_v);
-			vector_set_length(&ball->vel, v);
+			if (cur_game->fixed_physics) {
+				/* same in integers */
+				int v0 = fix_vel(cur_game->ball_v);
+				int v1 = fix_vel(cur_game->accelerated_ball_speed);
+				int d = bottomY - by;
+				if (d < 0)
+					d = 0;
+				if (d > bottomY - topY)
+					d = bottomY - topY;
+				ball_set_speed_fixed(ball, v0 + (v1 - v0) * d / (bottomY - topY));
+			} else
+				vector_set_length(&ball->vel, v);
 		}
         } else
         	balls_set_velocity( cur_game->balls, cur_game->ball_v );
@@ -1050,10 +1329,14 @@ void balls_update( int ms )
 			ball->vel.x = ( ball->paddle->x + ( ball->paddle->w >> 1 ) ) - 
 				      ( ball->cur.x + ball_rad );
 			ball->vel.y = ( ball->paddle->y - ball_rad + 2 ) - ( ball->cur.y + ball_rad );
-			vector_set_length( &ball->vel, cur_game->ball_v_max );
+			ball_set_speed( ball, cur_game->ball_v_max );
 			/* new position */
-			ball->cur.x += ball->vel.x * ms;
-			ball->cur.y += ball->vel.y * ms;
+			if ( cur_game->fixed_physics )
+				ball_move_fixed( ball, ms );
+			else {
+				ball->cur.x += ball->vel.x * ms;
+				ball->cur.y += ball->vel.y * ms;
+			}
 			ball->x = (int)ball->cur.x;
 			ball->y = (int)ball->cur.y;
 			/* check if paddle is reached and attach the ball */
@@ -1092,8 +1375,12 @@ void balls_update( int ms )
 			
 			/* new position if NOT attached*/
 			if ( !ball->attached ) {
-				ball->cur.x += ball->vel.x * ms;
-				ball->cur.y += ball->vel.y * ms;
+				if ( cur_game->fixed_physics )
+					ball_move_fixed( ball, ms );
+				else {
+					ball->cur.x += ball->vel.x * ms;
+					ball->cur.y += ball->vel.y * ms;
+				}
 				ball->x = (int)ball->cur.x;
 				ball->y = (int)ball->cur.y;
 			}
@@ -1169,13 +1456,13 @@ void balls_update( int ms )
 				while ( top-- > 0 )
 					cur_game->paddles[PADDLE_TOP]->score =
 						90 * cur_game->paddles[PADDLE_TOP]->score / 100;
-				cur_game->paddles[PADDLE_TOP]->last_ball_contact = SDL_GetTicks();
+				cur_game->paddles[PADDLE_TOP]->last_ball_contact = cur_game->time;
 			}
 			if ( bottom ) {
 				while ( bottom-- > 0 )
 					cur_game->paddles[PADDLE_BOTTOM]->score =
 						90 * cur_game->paddles[PADDLE_BOTTOM]->score / 100;
-				cur_game->paddles[PADDLE_BOTTOM]->last_ball_contact = SDL_GetTicks();
+				cur_game->paddles[PADDLE_BOTTOM]->last_ball_contact = cur_game->time;
 			}
 		}
 	}
@@ -1248,7 +1535,7 @@ void ball_mask_vel(Ball *b, float old_vx, int entropy )
 	}
 
 	if ( entropy == BALL_ADD_ENTROPY )
-		entropy_level = (float)((rand() % 81)+40)/1000.0;
+		entropy_level = (float)((GAME_RAND() % 81)+40)/1000.0;
 
 	m = b->vel.y / b->vel.x;
 	if (fabs(m) < ball_vhmask) {
@@ -1272,7 +1559,7 @@ void ball_mask_vel(Ball *b, float old_vx, int entropy )
 		}
 		else 
 			if ( entropy == BALL_ADD_ENTROPY ) {
-				if ( rand() % 2 )
+				if ( GAME_RAND() % 2 )
 					entropy_level = -entropy_level;
 				b->vel.x += b->vel.x * entropy_level;
 			}
@@ -1378,6 +1665,45 @@ int ball_is_in_brick(Ball *b, BC_Hit *brick_hits) {
 	return num_hits;
 }
 
+/** Set side and perp vector of target by the check point that hit it. */
+static void target_set_side(Target *target, int bcp)
+{
+	switch (bcp) {
+	case BCP_TOP:
+		target->perp_vector = vector_get(0, 1);
+		target->side = SIDE_BOTTOM;
+		break;
+	case BCP_RIGHT:
+		target->perp_vector = vector_get(1, 0);
+		target->side = SIDE_LEFT;
+		break;
+	case BCP_BOTTOM:
+		target->perp_vector = vector_get(0, 1);
+		target->side = SIDE_TOP;
+		break;
+	case BCP_LEFT:
+		target->perp_vector = vector_get(1, 0);
+		target->side = SIDE_RIGHT;
+		break;
+	case BCP_TOPRIGHT:
+		target->perp_vector = vector_get(-1, 1);
+		target->side = CORNER_LOWER_LEFT;
+		break;
+	case BCP_BOTTOMRIGHT:
+		target->perp_vector = vector_get(1, 1);
+		target->side = CORNER_UPPER_LEFT;
+		break;
+	case BCP_BOTTOMLEFT:
+		target->perp_vector = vector_get(-1, 1);
+		target->side = CORNER_UPPER_RIGHT;
+		break;
+	case BCP_TOPLEFT:
+		target->perp_vector = vector_get(1, 1);
+		target->side = CORNER_LOWER_RIGHT;
+		break;
+	}
+}
+
 /** Get target by moving along trajectory and checking for clipping. */
 void ball_get_target_clipping(Ball *ball)
 {
@@ -1400,9 +1726,11 @@ void ball_get_target_clipping(Ball *ball)
 		ball->cur.x += pmod.x;
 		ball->cur.y += pmod.y;
 
-		/* is ball leaving screen legally? */
+		/* is ball leaving screen legally? (top is open in network game) */
 		if (ball->cur.y + ball_dia >= 480)
 			goto restore;
+		if (cur_game->game_type == GT_NETWORK && ball->cur.y < 0)
+			goto restore;
 		/* is ball leaving screen illegally? */
 		if (ball->cur.x < 0 || ball->cur.y < 0 ||
 					ball->cur.x + ball_dia >= 640) {
@@ -1458,40 +1786,7 @@ void ball_get_target_clipping(Ball *ball)
 	ball->target.y = ball->cur.y;
 
 	/* determine side and perp vector */
-	switch (target_idx) {
-	case BCP_TOP:
-		ball->target.perp_vector = vector_get(0, 1);
-		ball->target.side = SIDE_BOTTOM;
-		break;
-	case BCP_RIGHT:
-		ball->target.perp_vector = vector_get(1, 0);
-		ball->target.side = SIDE_LEFT;
-		break;
-	case BCP_BOTTOM:
-		ball->target.perp_vector = vector_get(0, 1);
-		ball->target.side = SIDE_TOP;
-		break;
-	case BCP_LEFT:
-		ball->target.perp_vector = vector_get(1, 0);
-		ball->target.side = SIDE_RIGHT;
-		break;
-	case BCP_TOPRIGHT:
-		ball->target.perp_vector = vector_get(-1, 1);
-		ball->target.side = CORNER_LOWER_LEFT;
-		break;
-	case BCP_BOTTOMRIGHT:
-		ball->target.perp_vector = vector_get(1, 1);
-		ball->target.side = CORNER_UPPER_LEFT;
-		break;
-	case BCP_BOTTOMLEFT:
-		ball->target.perp_vector = vector_get(-1, 1);
-		ball->target.side = CORNER_UPPER_RIGHT;
-		break;
-	case BCP_TOPLEFT:
-		ball->target.perp_vector = vector_get(1, 1);
-		ball->target.side = CORNER_LOWER_RIGHT;
-		break;
-	}
+	target_set_side(&ball->target, target_idx);
 
 restore:
 	ball->cur = oldpos; /* restore old position */
@@ -1504,6 +1799,132 @@ restore:
 #endif
 }
 
+/** Same as ball_is_in_brick() for position px,py in 1/1024 pixels. */
+static int ball_is_in_brick_fixed(Ball *b, int px, int py, BC_Hit *brick_hits)
+{
+	int unit = 1 << FIX_POS;
+	int r = ball_rad * unit, d = ball_rad * 724; /* 0.707*radius */
+	int points[BCP_NUM][2] = { /* clockwise, beginning at top */
+		{0,-r}, {d-unit,-d},
+		{r-unit,0}, {d-unit,d-unit},
+		{0,r-unit}, {-d,d-unit},
+		{-r,0}, {-d,-d}
+	};
+	/* backside points by moving direction: top right, top left,
+	 * bottom right, bottom left */
+	static const int backside[4][3] = {
+		{BCP_LEFT, BCP_BOTTOMLEFT, BCP_BOTTOM},
+		{BCP_RIGHT, BCP_BOTTOMRIGHT, BCP_BOTTOM},
+		{BCP_LEFT, BCP_TOPLEFT, BCP_TOP},
+		{BCP_RIGHT, BCP_TOPRIGHT, BCP_TOP}
+	};
+	int dir = (b->vel.y < 0 ? 0 : 2) + (b->vel.x > 0 ? 0 : 1);
+	int num_hits = 0;
+	int mx, my;
+
+	if (brick_hits)
+		for (int i = 0; i < BCP_NUM; i++)
+			brick_hits[i].hit = 0;
+
+	for (int i = 0; i < BCP_NUM; i++) {
+		mx = (px + r + points[i][0]) / (BRICK_WIDTH * unit);
+		my = (py + r + points[i][1]) / (BRICK_HEIGHT * unit);
+
+		if (mx < 0 || my < 0 || mx >= MAP_WIDTH || my >= MAP_HEIGHT)
+			continue;
+		if (cur_game->bricks[mx][my].type == MAP_EMPTY)
+			continue;
+		/* ignore "backside points" of ball */
+		if (i == backside[dir][0] || i == backside[dir][1] || i == backside[dir][2])
+			continue;
+		num_hits++;
+		if (brick_hits) {
+			brick_hits[i].hit = 1;
+			brick_hits[i].mx = mx;
+			brick_hits[i].my = my;
+		}
+	}
+
+	return num_hits;
+}
+
+/** Get target like ball_get_target() with ball_get_target_clipping()
+ * but in fixed point. */
+static void ball_get_target_fixed(Ball *ball)
+{
+	int unit = 1 << FIX_POS;
+	int px = fix_pos(ball->cur.x), py = fix_pos(ball->cur.y);
+	int mx = fix_vel(ball->vel.x), my = fix_vel(ball->vel.y);
+	BC_Hit bhits[BCP_NUM], last_bhits[BCP_NUM];
+	int target_idx = -1;
+
+	/* reset position along trajectory if inside a brick */
+	if (ball_is_in_brick_fixed(ball, px, py, 0)) {
+		fvec_set_length(&mx, &my, 2 * unit);
+		do {
+			px -= mx;
+			py -= my;
+		} while (ball_is_in_brick_fixed(ball, px, py, 0));
+		ball->cur.x = unfix_pos(px);
+		ball->cur.y = unfix_pos(py);
+		ball->x = ball->cur.x;
+		ball->y = ball->cur.y;
+	}
+
+	/* balls moving back to paddle must not be reflected */
+	if ( ball->moving_back ) return;
+	/* attached balls MUST NOT be reflected!!!! */
+	if ( ball->attached ) return;
+	/* balls already out of the screen though still visible don't need new reflection, too */
+	if ( ball->cur.y + ball_dia >= 480 - 1 ) return;
+	if ( cur_game->game_type == GT_NETWORK && ball->cur.y <= 1 ) return;
+
+	/* move ball forward until we have a hit */
+	mx = fix_vel(ball->vel.x), my = fix_vel(ball->vel.y);
+	fvec_set_length(&mx, &my, ball_rad / 2 * unit);
+	while (ball_is_in_brick_fixed(ball, px, py, bhits) == 0) {
+		px += mx;
+		py += my;
+
+		/* is ball leaving screen legally? (top is open in network game) */
+		if (py + ball_dia * unit >= 480 * unit)
+			return;
+		if (cur_game->game_type == GT_NETWORK && py < 0)
+			return;
+		/* is ball leaving screen illegally? return it */
+		if (px < 0 || py < 0 || px + ball_dia * unit >= 640 * unit) {
+			printf("Oops... ball leaving screen illegally at %f,%f\n",
+					unfix_pos(px), unfix_pos(py));
+			ball->idle_time = 0;
+			ball->moving_back = 1;
+			ball->return_allowed = 0;
+			return;
+		}
+	}
+
+	/* move back in single steps until there is no more collision */
+	fvec_set_length(&mx, &my, unit);
+	do {
+		memcpy(last_bhits,bhits,sizeof(bhits)); /* remember last collisions */
+		px -= mx;
+		py -= my;
+	} while (ball_is_in_brick_fixed(ball, px, py, bhits) > 0);
+
+	/* select first clockwise hit */
+	for (int i = 0; i < BCP_NUM && target_idx == -1; i++)
+		if (last_bhits[i].hit)
+			target_idx = i;
+	if (target_idx == -1)
+		return;
+
+	ball->target.exists = 1;
+	ball->target.mx = last_bhits[target_idx].mx;
+	ball->target.my = last_bhits[target_idx].my;
+	ball->target.x = unfix_pos(px);
+	ball->target.y = unfix_pos(py);
+	target_set_side(&ball->target, target_idx);
+}
+
 /*
 ====================================================================
 Get target for a ball.
@@ -1546,6 +1967,11 @@ void ball_get_target( Ball *ball )
 	if (ball->vel.x == 0 && ball->vel.y == 0)
 		return;
 
+	if (cur_game->fixed_physics) {
+		ball_get_target_fixed(ball);
+		return;
+	}
+
 	/* check if we somehow ended up in a brick and reset position along trajectory.
 	 * should actually not happen except for moving bricks, e.g., in minigame invaders,
 	 * but it seems to happen sometimes on other occasions as well ... */
@@ -1573,6 +1999,7 @@ void ball_get_target( Ball *ball )
 	if ( ball->attached ) return;
 	/* balls already out of the screen though still visible don't need new reflection, too */
 	if ( ball->cur.y + ball_dia >= 480 - 1 ) return;
+	if ( cur_game->game_type == GT_NETWORK && ball->cur.y <= 1 ) return;
 
 	if (cur_game->bcc_type == BCC_CLIPPING) {
 		ball_get_target_clipping(ball);
@@ -1921,19 +2348,20 @@ void ball_get_target( Ball *ball )
 	/* workaround: if we have no target but the ball would exit the screen illegally
 	 * return it to paddle. */
 	if (ball->target.exists == 0) {
-		if (ball->vel.y < 0) {
+		if (ball->vel.y < 0 && cur_game->game_type == GT_LOCAL) {
 			/* ball is moving up, but no targets? impossible! */
 			printf("FATAL: No target for ball moving up!\n");
 			bad_target = 1;
 		} else {
-			/* if ball is moving down: the intersection of the open
-			 * bottom line with the ball's tangents must be within
+			/* if ball is moving down (or up in network game): the
+			 * intersection of the open bottom (top) line with the
+			 * ball's tangents must be within
 			 * BRICK_WIDTH + ball_radius and
 			 * map width - BRICK_WIDTH - ball_radius. If not the ball
 			 * somehow tunnels through the outer walls... nope, sir! */
 			Coord pos;
 			Line bottom;
-			line_set(&bottom, 0, MAP_HEIGHT*BRICK_HEIGHT, 0);
+			line_set(&bottom, 0, (ball->vel.y < 0) ? 0 : MAP_HEIGHT*BRICK_HEIGHT, 0);
 
 			for (int i = 0; i < 2; i++) {
 				line_set(&tang, tang_pts[i].x, tang_pts[i].y, mono);
@@ -1948,7 +2376,7 @@ void ball_get_target( Ball *ball )
 				}
 			}
 			if (bad_target) {
-				printf("FATAL: No target but ball will not exit through bottom!\n");
+				printf("FATAL: No target but ball will not exit through open side!\n");
 				printf("  bottom intersection: %f,%f", pos.x, pos.y);
 			}
 		}
@@ -1989,7 +2417,7 @@ void balls_inc_vel( int ms )
 	list_reset( cur_game->balls );
 	while ( ( ball = list_next( cur_game->balls ) ) != 0 ) {
 		if ( ball->attached ) continue;
-		vector_set_length( &ball->vel, cur_game->ball_v );
+		ball_set_speed( ball, cur_game->ball_v );
 	}
 }
 /*
@@ -2013,12 +2441,22 @@ void balls_return( Paddle *paddle )
 /* set random starting angle for ball according to its paddle */
 void ball_set_random_angle( Ball *ball, double ball_v )
 {
+	int dx, dy;
+
+	if ( cur_game->fixed_physics ) {
+		dy = ( ball->paddle->type == PADDLE_TOP ) ? 100 : -100;
+		dx = (GAME_RAND() % 145) + 6;
+		if ( GAME_RAND() % 2 )
+			dx = -dx;
+		ball_set_vel_fixed( ball, dx, dy, ball_v );
+		return;
+	}
 	if ( ball->paddle->type == PADDLE_TOP )
 		ball->vel.y = 1.0;
 	else
 		ball->vel.y = -1.0;
-	ball->vel.x = (float)((rand() % 145) + 6);
-	if ( rand() % 2 )
+	ball->vel.x = (float)((GAME_RAND() % 145) + 6);
+	if ( GAME_RAND() % 2 )
 		ball->vel.x /= -100.0;
 	else
 		ball->vel.x /= 100.0;
@@ -2041,7 +2479,7 @@ void balls_set_velocity( List *balls, double vel )
    
     list_reset( balls );
     while ( ( b = list_next( balls ) ) )
-        vector_set_length( &b->vel, vel );
+        ball_set_speed( b, vel );
 }
 
 /*
@@ -2083,9 +2521,14 @@ int balls_detach_from_paddle( Paddle *paddle, int dir )
 			else
 				ball->vel.y = -1.2;
 			/* only use 2 degree steps */
-			ball->angle = vec2angle( &ball->vel );
-			angle2vec( ball->angle, &ball->vel );
-			vector_set_length( &ball->vel, cur_game->ball_v );
+			if ( cur_game->fixed_physics )
+				ball_set_vel_fixed( ball, 10 * dir,
+						ball->vel.y < 0 ? -12 : 12, cur_game->ball_v );
+			else {
+				ball->angle = vec2angle( &ball->vel );
+				angle2vec( ball->angle, &ball->vel );
+				vector_set_length( &ball->vel, cur_game->ball_v );
+			}
 		}
 		ball->get_target = 1;
 		fired = 1;
@@ -2093,7 +2536,7 @@ int balls_detach_from_paddle( Paddle *paddle, int dir )
 
 	/* if no balls are attached anymore set last contact time */
 	if ( fired && paddle->attached_ball_count == 0 )
-		paddle->last_ball_contact = SDL_GetTicks();
+		paddle->last_ball_contact = cur_game->time;
 	
 	return fired;
 }
@@ -2103,3 +2546,112 @@ int balls_get_radius()
 {
 	return ball_rad;
 }
+
+/*
+====================================================================
+Predict the next 'count' contacts of 'ball' with bricks (including
+walls) and the paddle level without changing the game. Hit bricks
+are removed or weakened for the following contacts and restored
+afterwards. Prediction stops at paddle level, at chaotic reflections
+and after PREDICT_MAX_CHANGES changed bricks, corners are reflected
+without entropy.
+Return number of contacts.
+====================================================================
+*/
+enum { PREDICT_MAX_CHANGES = 32 }; /* more than any caller asks for */
+int ball_predict( Ball *ball, BallContact *contacts, int count )
+{
+	Game *game = cur_game;
+	Ball b = *ball;
+	Paddle *paddle;
+	Brick *brick;
+	BallContact *c;
+	struct { Brick *brick; int type, dur; } changes[PREDICT_MAX_CHANGES];
+	float plane = 0, t, time = 0;
+	int n = 0, i, changed = 0, metal, bcc_type = game->bcc_type;
+
+	if ( b.attached || b.moving_back || ( b.vel.x == 0 && b.vel.y == 0 ) )
+		return 0;
+
+	/* targets are computed from the brick grid and not by moving the
+	 * ball. bricks are changed in the game itself and the old values
+	 * kept in 'changes' so that the game does not need to be copied. */
+	game->bcc_type = BCC_TRAJECTORY;
+	if ( !b.target.exists || b.get_target )
+		ball_get_target( &b );
+
+	while ( n < count && !b.moving_back ) {
+		c = &contacts[n];
+
+		/* paddle level reached before next brick? */
+		paddle = 0;
+		if ( b.vel.y > 0 ) {
+			paddle = game->paddles[PADDLE_BOTTOM];
+			plane = paddle->y - ball_dia;
+			if ( b.cur.y > plane || ( b.target.exists && b.target.y <= plane ) )
+				paddle = 0;
+		}
+		else if ( b.vel.y < 0 && game->paddle_count > 1 ) {
+			paddle = game->paddles[PADDLE_TOP];
+			plane = paddle->y + paddle->h;
+			if ( b.cur.y < plane || ( b.target.exists && b.target.y >= plane ) )
+				paddle = 0;
+		}
+		if ( paddle ) {
+			t = ( plane - b.cur.y ) / b.vel.y;
+			c->type = CONTACT_PADDLE;
+			c->x = b.cur.x + b.vel.x * t;
+			c->y = plane;
+			c->mx = c->my = -1;
+			c->paddle = paddle->type;
+			c->time = time + t;
+			n++;
+			break;
+		}
+		if ( !b.target.exists )
+			break;
+
+		/* the predicted ball keeps its own speed which may differ from
+		 * ball_v (e.g. while the speed is still adjusted) */
+		time += VEC_DIST( b.cur, b.target ) / VLEN( b.vel.x, b.vel.y );
+		c->type = CONTACT_BRICK;
+		c->x = b.target.x;
+		c->y = b.target.y;
+		c->mx = b.target.mx;
+		c->my = b.target.my;
+		c->paddle = -1;
+		c->time = time;
+		n++;
+
+		/* same rules as ball_check_brick_reflection() */
+		brick = &game->bricks[c->mx][c->my];
+		if ( game->extra_active[EX_CHAOS] || brick->type == MAP_BRICK_CHAOS )
+			break;
+		metal = game->extra_active[EX_METAL] && brick->type != MAP_WALL;
+		if ( metal || brick->dur > 0 ) {
+			if ( changed == PREDICT_MAX_CHANGES )
+				break;
+			changes[changed].brick = brick;
+			changes[changed].type = brick->type;
+			changes[changed].dur = brick->dur;
+			changed++;
+			if ( metal || brick->dur <= 1 || game->extra_active[EX_EXPL_BALL] )
+				brick->type = MAP_EMPTY;
+			else
+				brick->dur--;
+		}
+		b.cur.x = b.target.x; b.x = (int)b.cur.x;
+		b.cur.y = b.target.y; b.y = (int)b.cur.y;
+		if ( !metal )
+			ball_reflect_vel( &b, 0, BALL_NO_ENTROPY );
+		ball_get_target( &b );
+	}
+
+	/* a brick may have been changed more than once so restore backwards */
+	for ( i = changed - 1; i >= 0; i-- ) {
+		changes[i].brick->type = changes[i].type;
+		changes[i].brick->dur = changes[i].dur;
+	}
+	game->bcc_type = bcc_type;
+	return n;
+}
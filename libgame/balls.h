@@ -158,6 +158,19 @@ void ball_clear_target( Target *t );
 /** Get radius, same for all balls. */
 int balls_get_radius();
 
+/*
+====================================================================
+Predict the next 'count' contacts of 'ball' with bricks (including
+walls) and the paddle level without changing the game. Hit bricks
+are removed or weakened for the following contacts and restored
+afterwards. Prediction stops at paddle level, at chaotic reflections
+and after PREDICT_MAX_CHANGES changed bricks, corners are reflected
+without entropy.
+Return number of contacts.
+====================================================================
+*/
+int ball_predict( Ball *ball, BallContact *contacts, int count );
+
 #ifdef __cplusplus
 };
 #endif
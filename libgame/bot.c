@@ -0,0 +1,256 @@
+/***************************************************************************
+                          bot.c  -  description
+                             -------------------
+    begin                : 2026/10/19
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/***** INCLUDES ************************************************************/
+
+#include "bot.h"
+
+/***** EXTERNAL VARIABLES **************************************************/
+
+extern GAME_TLS Game *cur_game;
+extern int ball_dia;
+
+/***** LOCAL TYPE DEFINITIONS **********************************************/
+
+typedef struct {
+	float	max_vx;
+	int	think_delay, aim_error, fire_delay;
+	int	catch_extras, avoid_mali;
+	int	look_ahead;
+} BotSkill;
+
+/***** LOCAL VARIABLES *****************************************************/
+
+static BotSkill skills[BOT_SKILL_COUNT] = {
+	{ 0.35, 250, 40, 1500, 0, 0,  0 },
+	{ 0.60, 120, 16,  800, 1, 0,  4 },
+	{ 1.20,  40,  4,  300, 1, 1, 16 }
+};
+
+/***** LOCAL FUNCTIONS *****************************************************/
+
+/* extras that harm the player */
+static int bot_is_malus( int type )
+{
+	switch ( type ) {
+		case EX_SHORTEN:
+		case EX_FROZEN:
+		case EX_FAST:
+		case EX_DARKNESS:
+		case EX_CHAOS:
+		case EX_GHOST_PADDLE:
+		case EX_DISABLE:
+		case EX_MALUS_MAGNET:
+		case EX_WEAK_BALL:
+			return 1;
+	}
+	return 0;
+}
+
+/* predict x of ball center when reaching paddle level. bricks are
+ * considered for up to 'look_ahead' contacts, if the paddle is not
+ * reached by then only side walls are considered. return time in ms
+ * or -1 if the ball does not move towards paddle. */
+static float bot_predict_ball( Paddle *paddle, Ball *ball, int look_ahead, float *x )
+{
+	BallContact contacts[BOT_MAX_LOOK_AHEAD], *c;
+	float t, dist, left, width, px;
+	int n;
+
+	if ( ball->attached )
+		return -1;
+	if ( look_ahead > 0 && ( n = ball_predict( ball, contacts, look_ahead ) ) > 0 ) {
+		c = &contacts[n - 1];
+		if ( c->type == CONTACT_PADDLE && c->paddle == paddle->type ) {
+			*x = c->x + ball_dia / 2;
+			return c->time;
+		}
+	}
+	if ( paddle->type == PADDLE_BOTTOM ) {
+		if ( ball->vel.y <= 0 ) return -1;
+		dist = paddle->y - ( ball->cur.y + ball_dia );
+	}
+	else {
+		if ( ball->vel.y >= 0 ) return -1;
+		dist = ball->cur.y - ( paddle->y + paddle->h );
+	}
+	if ( dist < 0 ) 
+		return -1; /* already passed */
+	t = dist / fabs( ball->vel.y );
+
+	/* fold position into field between side walls */
+	left = BRICK_WIDTH;
+	width = 640 - 2 * BRICK_WIDTH - ball_dia;
+	px = ball->cur.x + ball->vel.x * t - left;
+	px = fmod( px, 2 * width );
+	if ( px < 0 ) px += 2 * width;
+	if ( px > width ) px = 2 * width - px;
+	*x = left + px + ball_dia / 2;
+	return t;
+}
+
+/* time in ms until extra reaches paddle level or -1 if never */
+static float bot_predict_extra( Paddle *paddle, Extra *ex )
+{
+	float dist;
+	if ( paddle->type == PADDLE_BOTTOM ) {
+		if ( ex->dir < 0 ) return -1;
+		dist = paddle->y - ( ex->y + BRICK_HEIGHT );
+	}
+	else {
+		if ( ex->dir > 0 ) return -1;
+		dist = ex->y - ( paddle->y + paddle->h );
+	}
+	if ( dist < 0 ) return -1;
+	return dist / 0.05; /* velocity used in extras_update() */
+}
+
+/* choose paddle center to aim at */
+static void bot_think( Bot *bot, Paddle *paddle )
+{
+	Ball *ball, *lowest = 0;
+	Extra *ex;
+	float t, x, ball_t = -1, ball_x = 0, center;
+	float best_t = -1, best_x = 0;
+
+	center = paddle->cur_x + paddle->w / 2;
+
+	/* most urgent ball */
+	list_reset( cur_game->balls );
+	while ( ( ball = list_next( cur_game->balls ) ) ) {
+		if ( ( t = bot_predict_ball( paddle, ball, bot->look_ahead, &x ) ) >= 0 &&
+				( ball_t < 0 || t < ball_t ) ) {
+			ball_t = t;
+			ball_x = x;
+		}
+		if ( !ball->attached && ( lowest == 0 || 
+				( paddle->type == PADDLE_BOTTOM && ball->cur.y > lowest->cur.y ) ||
+				( paddle->type == PADDLE_TOP && ball->cur.y < lowest->cur.y ) ) )
+			lowest = ball;
+	}
+
+	/* catch extra if it can be done before ball arrives */
+	if ( bot->catch_extras ) {
+		list_reset( cur_game->extras );
+		while ( ( ex = list_next( cur_game->extras ) ) ) {
+			if ( bot->avoid_mali && bot_is_malus( ex->type ) )
+				continue;
+			if ( ( t = bot_predict_extra( paddle, ex ) ) < 0 )
+				continue;
+			x = ex->x + BRICK_WIDTH / 2;
+			if ( fabs( x - center ) / bot->max_vx > t )
+				continue; /* too far */
+			if ( ball_t >= 0 && t + fabs( ball_x - x ) / bot->max_vx +
+					bot->think_delay > ball_t )
+				continue; /* would miss ball */
+			if ( best_t < 0 || t < best_t ) {
+				best_t = t;
+				best_x = x;
+			}
+		}
+	}
+
+	if ( best_t >= 0 )
+		bot->target_x = best_x;
+	else if ( ball_t >= 0 )
+		bot->target_x = ball_x;
+	else if ( lowest )
+		bot->target_x = lowest->cur.x + ball_dia / 2;
+	else
+		bot->target_x = center; /* balls attached, stay */
+
+	/* error and offset to vary reflection angle */
+	bot->aim_offset = 0;
+	if ( bot->aim_error > 0 )
+		bot->aim_offset = GAME_RAND() % ( 2 * bot->aim_error + 1 ) - bot->aim_error;
+	bot->aim_offset += ( GAME_RAND() % ( paddle->w / 4 + 1 ) ) - paddle->w / 8;
+}
+
+/***** PUBLIC FUNCTIONS ****************************************************/
+
+Bot *bot_create( int skill )
+{
+	Bot *bot;
+
+	if ( skill < 0 ) skill = 0;
+	if ( skill >= BOT_SKILL_COUNT ) skill = BOT_SKILL_COUNT - 1;
+	bot = salloc( 1, sizeof( Bot ) );
+	bot->skill = skill;
+	bot->max_vx = skills[skill].max_vx;
+	bot->think_delay = skills[skill].think_delay;
+	bot->aim_error = skills[skill].aim_error;
+	bot->fire_delay = skills[skill].fire_delay;
+	bot->catch_extras = skills[skill].catch_extras;
+	bot->avoid_mali = skills[skill].avoid_mali;
+	bot->look_ahead = skills[skill].look_ahead;
+	bot->fire_time = bot->fire_delay;
+	return bot;
+}
+void bot_delete( Bot **bot )
+{
+	if ( *bot == 0 ) return;
+	free( *bot ); *bot = 0;
+}
+
+void bot_update( Bot *bot, int id, int ms )
+{
+	Paddle *paddle;
+	float dx, step, x;
+	int fire = 0;
+
+	if ( id < 0 || id >= cur_game->paddle_count )
+		return;
+	paddle = cur_game->paddles[id];
+
+	if ( ( bot->think_time -= ms ) <= 0 ) {
+		bot->think_time = bot->think_delay;
+		bot_think( bot, paddle );
+	}
+
+	/* move towards target with limited velocity */
+	x = paddle->cur_x;
+	paddle->bot_vx = 0;
+	if ( !paddle->frozen ) {
+		dx = bot->target_x + bot->aim_offset - ( x + paddle->w / 2 );
+		step = bot->max_vx * ms;
+		if ( dx > step ) dx = step;
+		if ( dx < -step ) dx = -step;
+		x += dx;
+		if ( ms > 0 )
+			paddle->bot_vx = dx / ms;
+	}
+	paddle->v_x = paddle->bot_vx; /* for friction */
+
+	/* release attached balls (or bring new ones to a PINGPONG level)
+	 * after a while, fire weapon always */
+	if ( paddle->attached_ball_count > 0 || ( cur_game->level_type == LT_PINGPONG &&
+			paddle->ball_ammo > 0 ) ) {
+		if ( ( bot->fire_time -= ms ) <= 0 ) {
+			bot->fire_time = bot->fire_delay;
+			fire = 1;
+		}
+	}
+	else
+		bot->fire_time = bot->fire_delay;
+	if ( paddle->extra_active[EX_WEAPON] )
+		fire = 1;
+
+	/* x must not be 0 as this means unchanged */
+	if ( x < 1 ) x = 1;
+	if ( GAME_RAND() % 2 )
+		game_set_paddle_state( id, x, 0, fire, 0, 0 );
+	else
+		game_set_paddle_state( id, x, 0, 0, fire, 0 );
+}
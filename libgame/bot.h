@@ -0,0 +1,67 @@
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef __BOT_H
+#define __BOT_H
+
+/***** INCLUDES ************************************************************/
+
+#include "game.h"
+
+/***** TYPE DEFINITIONS ****************************************************/
+
+enum {
+	BOT_MAX_LOOK_AHEAD = 16
+};
+
+enum {
+	BOT_EASY = 0,
+	BOT_MEDIUM,
+	BOT_HARD,
+	BOT_SKILL_COUNT
+};
+
+/* autopilot for a paddle of the current game. it only reads the game
+ * state (balls, extras, paddle) and sets the paddle state just like a
+ * player would by game_set_paddle_state(). */
+typedef struct {
+	int	skill;
+	float	max_vx; 	/* max paddle velocity in pix/msec */
+	int	think_delay; 	/* reaction time: ms between target updates */
+	int	think_time; 	/* ms until next target update */
+	int	aim_error; 	/* max random error of target in pix */
+	int	aim_offset; 	/* current error + offset on paddle */
+	int	fire_delay; 	/* ms attached balls are held */
+	int	fire_time;
+	int	catch_extras; 	/* go for falling extras if time allows */
+	int	avoid_mali; 	/* ignore bad extras */
+	int	look_ahead; 	/* ball contacts predicted, see ball_predict() */
+	float	target_x; 	/* desired paddle center */
+} Bot;
+
+/***** PUBLIC FUNCTIONS ****************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* create/delete bot of skill BOT_EASY to BOT_HARD */
+Bot *bot_create( int skill );
+void bot_delete( Bot **bot );
+
+/* think about target and move paddle 'id' of current game towards it
+ * for 'ms' milliseconds. paddle->bot_vx holds resulting velocity.
+ * call before game_update(). */
+void bot_update( Bot *bot, int id, int ms );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
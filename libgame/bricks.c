@@ -21,7 +21,7 @@
 #include "bricks.h"
 #include "mathfuncs.h"
 
-extern Game *cur_game;
+extern GAME_TLS Game *cur_game;
 extern int ball_dia;
 
 /* extras conversion table */
@@ -191,7 +191,7 @@ void brick_remove( int mx, int my, int type, Vector imp, Paddle *paddle )
 		for ( i = mx - 1; i <= mx + 1; i++ )
 		for ( j = my - 1; j <= my + 1; j++ )
 			if ( cur_game->bricks[i][j].type == MAP_EMPTY )
-				brick_grow( i, j, RANDOM( BRICK_GROW_FIRST, BRICK_GROW_LAST ) );
+				brick_grow( i, j, GAME_RANDOM( BRICK_GROW_FIRST, BRICK_GROW_LAST ) );
 	}
 
 	/* decrease brick count if no indestructible brick was destroyed */
@@ -358,7 +358,7 @@ static void select_random_duck( Game *game )
     i = 0; 
     while (game->blDuckPositions[i<<1]==-1) i++;
     /* get number to go */
-    k = rand()%game->blNumDucks;
+    k = GAME_RAND()%game->blNumDucks;
     /* go */
     while (k>0)
     {
@@ -376,8 +376,8 @@ static void bricks_create_new_prey( Game *game, int mx, int my)
     /* get position */
 	if (mx==-1 || my==-1)
 		do {
-			mx = RANDOM(game->blHunterAreaX1+2,game->blHunterAreaX2-2);
-			my = RANDOM(game->blHunterAreaY1+2,game->blHunterAreaY2-2);
+			mx = GAME_RANDOM(game->blHunterAreaX1+2,game->blHunterAreaX2-2);
+			my = GAME_RANDOM(game->blHunterAreaY1+2,game->blHunterAreaY2-2);
 		} while (game->bricks[mx][my].type != MAP_EMPTY);
     /* set brick */
     brick_set_by_id(game,mx,my,game->blHunterPreyId);
@@ -466,8 +466,8 @@ static void bricks_add_invader(Game *game)
 	 * this area so MAXLIMIT must not exceed the number of possible
 	 * slots otherwise we loop infinitely */
 	do {
-		mx = RANDOM(1,MAP_WIDTH-2);
-		my = RANDOM(1,4);
+		mx = GAME_RANDOM(1,MAP_WIDTH-2);
+		my = GAME_RANDOM(1,4);
 	} while (game->bricks[mx][my].type != MAP_EMPTY);
 
 	for (i = 0; i < INVADERS_MAXLIMIT; i++)
@@ -481,10 +481,10 @@ static void bricks_add_invader(Game *game)
 	}
 
 	game->blNumInvaders++;
-	inv->id = RANDOM(BRICK_GROW_FIRST,BRICK_GROW_LAST);
+	inv->id = GAME_RANDOM(BRICK_GROW_FIRST,BRICK_GROW_LAST);
 	inv->x = mx;
 	inv->y = my;
-	delay_set(&inv->delay,RANDOM(95,105)*game->blInvaderTime/100);
+	delay_set(&inv->delay,GAME_RANDOM(95,105)*game->blInvaderTime/100);
 #ifdef WITH_BUG_REPORT
 	printf("added invader[%d]: id=%d,mx=%d,my=%d,delay=%d\n", i,
 				inv->id, inv->x, inv->y, inv->delay.limit);
@@ -556,13 +556,13 @@ static void brick_create_instable( Game *game, int life_time )
   int mx,my,id;
 
     /* choose id of a normal brick */
-  id = RANDOM(10,17);
+  id = GAME_RANDOM(10,17);
     
   /* do again if nothing added due to ball or existing brick */
   do
     {
-      mx = RANDOM(1,MAP_WIDTH-2);
-      my = RANDOM(1,1+EDIT_HEIGHT-1); /* only senseful for local game */
+      mx = GAME_RANDOM(1,MAP_WIDTH-2);
+      my = GAME_RANDOM(1,1+EDIT_HEIGHT-1); /* only senseful for local game */
     }  
   while (game->bricks[mx][my].type!=MAP_EMPTY);
 
@@ -1129,7 +1129,7 @@ void bricks_add_mod( int x, int y, int mod, int dest_type, Vector imp, Paddle *p
 	}
 	
 	if (mod==HT_GROW)
-		hit->brick_id = RANDOM( BRICK_GROW_FIRST, BRICK_GROW_LAST );
+		hit->brick_id = GAME_RANDOM( BRICK_GROW_FIRST, BRICK_GROW_LAST );
 ;
 }
 void bricks_add_grow_mod( int x, int y, int id )
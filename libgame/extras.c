@@ -24,7 +24,7 @@
 #include "extras.h"
 
 extern int ball_w, ball_dia;
-extern Game *cur_game;
+extern GAME_TLS Game *cur_game;
 
 /*
 ====================================================================
@@ -67,10 +67,10 @@ void extra_use( Paddle *paddle, int extra_type )
 
 	if ( cur_game->diff->allow_maluses ) {
 		while( extra_type == EX_RANDOM )
-			extra_type = rand() % (EX_NUMBER);
+			extra_type = GAME_RAND() % (EX_NUMBER);
 	} else {
 		while ( extra_type == EX_RANDOM || extra_is_malus( extra_type ) )
-			extra_type = rand() % (EX_NUMBER);
+			extra_type = GAME_RAND() % (EX_NUMBER);
 	}
 
 	/* store modification */
@@ -308,7 +308,7 @@ void extras_update( int ms )
 				case EX_SLOW:
 				case EX_FAST:
 					cur_game->ball_v = cur_game->diff->v_start + 
-						cur_game->diff->v_add * cur_game->speedup_level;
+						(double)cur_game->diff->v_add * cur_game->speedup_level;
                                         balls_set_velocity( cur_game->balls, cur_game->ball_v );
 					break;
 				case EX_CHAOS:
@@ -332,7 +332,7 @@ void extras_update( int ms )
 				        paddle_set_slime( cur_game->paddles[j], 0 );
 					/* release all balls from paddle */
 					balls_detach_from_paddle( cur_game->paddles[j],
-								  ((rand()%2==1)?-1:1) );
+								  ((GAME_RAND()%2==1)?-1:1) );
 					break;
 				case EX_WEAPON: weapon_install( cur_game->paddles[j], 0 ); break;
 				case EX_FROZEN:
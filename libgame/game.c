@@ -25,7 +25,7 @@ extern int ball_w, ball_dia;
 
 /***** EXPORTS *************************************************************/
 
-Game *cur_game = 0;
+GAME_TLS Game *cur_game = 0;
 
 /***** FORWARDED DECLARATIONS **********************************************/
 
@@ -90,6 +90,56 @@ static void game_setup_title_and_author( Game *game, Level *level )
     }
 }
 
+/* save items of 'list' of 'size' bytes. lists that don't own their
+ * items (brick lists) just keep the pointers. */
+static void game_save_list( List *list, GameSnapshotList *copy, int size )
+{
+	ListEntry *entry;
+	int i = 0;
+
+	if ( !list->auto_delete )
+		size = sizeof( void* );
+	if ( list->count > copy->size ) {
+		copy->size = list->count;
+		copy->items = realloc( copy->items, copy->size * size );
+	}
+	for ( entry = list->head->next; entry != list->tail; entry = entry->next, i++ )
+		if ( list->auto_delete )
+			memcpy( (char*)copy->items + i * size, entry->item, size );
+		else
+			((void**)copy->items)[i] = entry->item;
+	copy->count = list->count;
+}
+/* overwrite items in list by the saved ones, add the missing and
+ * delete the ones left over */
+static void game_restore_list( List *list, GameSnapshotList *copy, int size )
+{
+	ListEntry *entry = list->head->next;
+	void *item;
+	int i;
+
+	for ( i = 0; i < copy->count; i++ ) {
+		if ( !list->auto_delete )
+			item = ((void**)copy->items)[i];
+		else
+			item = (char*)copy->items + i * size;
+		if ( entry == list->tail ) {
+			if ( list->auto_delete )
+				item = memcpy( salloc( 1, size ), item, size );
+			list_add( list, item );
+			continue;
+		}
+		if ( list->auto_delete )
+			memcpy( entry->item, item, size );
+		else
+			entry->item = item;
+		entry = entry->next;
+	}
+	while ( list->count > copy->count )
+		list_delete_entry( list, list->tail->prev );
+	list_reset( list );
+}
+
 /***** PUBLIC FUNCTIONS ****************************************************/
 
 /* create/delete game context */
@@ -105,6 +155,9 @@ Game *game_create( int game_type, int diff, int rel_warp_limit )
 		game->diff = &net_diffs[diff];
 	game->rel_warp_limit = rel_warp_limit;
 	
+	/* random seed, use game_set_seed() for reproducible games */
+	game->rand_state = rand();
+	
 	/* init angles for reflection */
 	init_angles();
 
@@ -179,7 +232,7 @@ void game_init( Game *game, Level *level )
   game_setup_title_and_author( game, level );
 
   /* set level type. is level::type except for normal level with no bricks: pingpong */
-  if (level->type==LT_NORMAL && game->game_type == GT_NETWORK && game->brick_count == 0 )
+  if (level->type==LT_NORMAL && game->game_type == GT_NETWORK && level->normal_brick_count == 0 )
     game->level_type = LT_PINGPONG;
   else
   {
@@ -250,6 +303,13 @@ void game_set_current( Game *game )
 	cur_game = game;
 }
 
+/* seed the random numbers of the game. same seed, level and input
+ * result in the same game. */
+void game_set_seed( Game *game, unsigned int seed )
+{
+	game->rand_state = seed;
+}
+
 /* set score of paddle 'id'. 0 is bottom paddle and 1 is top paddle */
 void game_set_score( int id, int score ) 
 {
@@ -334,6 +394,7 @@ void game_update( int ms )
 {
 	int i;
 
+	cur_game->time += ms;
 	extras_update( ms );
 	walls_update( ms );
 	shots_update( ms );
@@ -343,7 +404,7 @@ void game_update( int ms )
 		paddle_update( cur_game->paddles[i], ms );
 		/* release all balls from paddle if invisible */
 		if (!paddle_solid(cur_game->paddles[i]))
-		    balls_detach_from_paddle( cur_game->paddles[i], ((rand()%2==1)?-1:1) );
+		    balls_detach_from_paddle( cur_game->paddles[i], ((GAME_RAND()%2==1)?-1:1) );
 	  }
 		  
 	balls_update( ms );
@@ -507,3 +568,177 @@ void game_set_bcc_type(int type)
 {
 	cur_game->bcc_type = type;
 }
+
+/* use integer math for balls so that results are the same on any
+ * machine and build (see balls.c) */
+void game_set_fixed_physics( int fixed )
+{
+	cur_game->fixed_physics = fixed;
+}
+
+/* get difficulty id 'game' was created with */
+int game_get_diff( Game *game )
+{
+	if ( game->game_type == GT_LOCAL )
+		return game->diff - diffs;
+	return game->diff - net_diffs;
+}
+
+/* save the state of 'game' into 'snapshot' or set it back to it. a
+ * snapshot can only be restored to the game it was taken from as
+ * pointers to paddles and bricks are kept. restoring reuses the list
+ * items of the game, so both are quick enough to be done every frame
+ * (rollback of network games). */
+void game_save( Game *game, GameSnapshot *snapshot )
+{
+	int i;
+
+	snapshot->game = *game;
+	for ( i = 0; i < game->paddle_count; i++ )
+		snapshot->paddles[i] = *game->paddles[i];
+	game_save_list( game->balls, &snapshot->balls, sizeof( Ball ) );
+	game_save_list( game->shots, &snapshot->shots, sizeof( Shot ) );
+	game_save_list( game->extras, &snapshot->extras, sizeof( Extra ) );
+	game_save_list( game->exp_bricks, &snapshot->exp_bricks, 0 );
+	game_save_list( game->heal_bricks, &snapshot->heal_bricks, 0 );
+}
+void game_restore( Game *game, GameSnapshot *snapshot )
+{
+	int i;
+
+	if ( snapshot->game.balls != game->balls ) {
+		fprintf( stderr, "snapshot is of another game\n" );
+		return;
+	}
+	/* lists and paddles are the same pointers */
+	*game = snapshot->game;
+	for ( i = 0; i < game->paddle_count; i++ )
+		*game->paddles[i] = snapshot->paddles[i];
+	game_restore_list( game->balls, &snapshot->balls, sizeof( Ball ) );
+	game_restore_list( game->shots, &snapshot->shots, sizeof( Shot ) );
+	game_restore_list( game->extras, &snapshot->extras, sizeof( Extra ) );
+	game_restore_list( game->exp_bricks, &snapshot->exp_bricks, 0 );
+	game_restore_list( game->heal_bricks, &snapshot->heal_bricks, 0 );
+}
+
+/* free the arrays of a snapshot (not the snapshot itself) */
+void game_snapshot_free( GameSnapshot *snapshot )
+{
+	free( snapshot->balls.items );
+	free( snapshot->shots.items );
+	free( snapshot->extras.items );
+	free( snapshot->exp_bricks.items );
+	free( snapshot->heal_bricks.items );
+	memset( snapshot, 0, sizeof( GameSnapshot ) );
+}
+
+/* hash of the game state that is changed by game_update() (bricks,
+ * balls, shots, extras, paddles, timers and random state). games
+ * with the same hash after each update behaved identically. floats
+ * are hashed bitwise so any change in rounding shows up. pointers
+ * are hashed by what they point to. */
+#define HASH( h, v ) h = hash_data( &(v), sizeof( v ), h )
+unsigned long long game_get_hash( Game *game )
+{
+	unsigned long long h = 14695981039346656037ULL;
+	Brick *brick;
+	Paddle *paddle;
+	Ball *ball;
+	Shot *shot;
+	Extra *extra;
+	int i, j, type;
+
+	for ( i = 0; i < MAP_WIDTH; i++ )
+		for ( j = 0; j < MAP_HEIGHT; j++ ) {
+			brick = &game->bricks[i][j];
+			HASH( h, brick->type ); HASH( h, brick->id );
+			HASH( h, brick->dur ); HASH( h, brick->extra );
+			HASH( h, brick->score ); HASH( h, brick->exp_time );
+			HASH( h, brick->heal_time );
+		}
+	list_reset( game->exp_bricks );
+	while ( ( brick = list_next( game->exp_bricks ) ) ) {
+		HASH( h, brick->mx ); HASH( h, brick->my );
+	}
+	list_reset( game->heal_bricks );
+	while ( ( brick = list_next( game->heal_bricks ) ) ) {
+		HASH( h, brick->mx ); HASH( h, brick->my );
+	}
+
+	for ( i = 0; i < game->paddle_count; i++ ) {
+		paddle = game->paddles[i];
+		HASH( h, paddle->score ); HASH( h, paddle->cur_x );
+		HASH( h, paddle->x ); HASH( h, paddle->y );
+		HASH( h, paddle->w ); HASH( h, paddle->h );
+#ifdef PADDLE_FRICTION
+		HASH( h, paddle->v_x );
+#endif
+		HASH( h, paddle->wanted_w ); HASH( h, paddle->len );
+		HASH( h, paddle->friction_delay ); HASH( h, paddle->frozen );
+		HASH( h, paddle->slime ); HASH( h, paddle->attract );
+		HASH( h, paddle->resize_delay ); HASH( h, paddle->invis );
+		HASH( h, paddle->invis_delay );
+		HASH( h, paddle->weapon_cur ); HASH( h, paddle->weapon_inst );
+		HASH( h, paddle->weapon_fire_delay ); HASH( h, paddle->weapon_ammo );
+		HASH( h, paddle->ball_fire_delay ); HASH( h, paddle->ball_ammo );
+		HASH( h, paddle->last_ball_contact );
+		HASH( h, paddle->attached_ball_count );
+		HASH( h, paddle->extra_active ); HASH( h, paddle->extra_time );
+		HASH( h, paddle->wall_y ); HASH( h, paddle->wall_alpha );
+		HASH( h, paddle->balls_reflected ); HASH( h, paddle->balls_lost );
+		HASH( h, paddle->extras_collected ); HASH( h, paddle->bricks_cleared );
+	}
+
+	list_reset( game->balls );
+	while ( ( ball = list_next( game->balls ) ) ) {
+		type = ball->paddle ? ball->paddle->type : -1;
+		HASH( h, ball->cur ); HASH( h, ball->vel ); HASH( h, ball->angle );
+		HASH( h, ball->attached ); HASH( h, type );
+		HASH( h, ball->moving_back ); HASH( h, ball->idle_time );
+		HASH( h, ball->return_allowed ); HASH( h, ball->target );
+		HASH( h, ball->get_target );
+	}
+	list_reset( game->shots );
+	while ( ( shot = list_next( game->shots ) ) ) {
+		type = shot->paddle ? shot->paddle->type : -1;
+		HASH( h, shot->x ); HASH( h, shot->y ); HASH( h, shot->target );
+		HASH( h, shot->next_too ); HASH( h, type ); HASH( h, shot->dir );
+		HASH( h, shot->get_target );
+	}
+	list_reset( game->extras );
+	while ( ( extra = list_next( game->extras ) ) ) {
+		HASH( h, extra->x ); HASH( h, extra->y ); HASH( h, extra->alpha );
+		HASH( h, extra->type ); HASH( h, extra->offset ); HASH( h, extra->dir );
+	}
+
+	HASH( h, game->bricks_left ); HASH( h, game->warp_limit );
+	HASH( h, game->extra_active ); HASH( h, game->extra_time );
+	HASH( h, game->ball_v ); HASH( h, game->speedup_delay );
+	HASH( h, game->speedup_level );
+	HASH( h, game->level_over ); HASH( h, game->winner );
+	HASH( h, game->rand_state ); HASH( h, game->time );
+
+	/* bonus levels */
+	HASH( h, game->totalBonusLevelScore ); HASH( h, game->blNumCompletedRuns );
+	HASH( h, game->blRatioSum ); HASH( h, game->blActionTime );
+	HASH( h, game->blDelay ); HASH( h, game->blMaxScore );
+	HASH( h, game->blGameOver ); HASH( h, game->bl_jj_mx );
+	HASH( h, game->bl_jj_my ); HASH( h, game->bl_jj_time );
+	HASH( h, game->blCancerCount ); HASH( h, game->blBarrierLevel );
+	HASH( h, game->blBarrierMoves ); HASH( h, game->blNumDucks );
+	HASH( h, game->blBallAttached ); HASH( h, game->blCurrentDuck );
+	HASH( h, game->blHunterX ); HASH( h, game->blHunterY );
+	HASH( h, game->blHunterPreyX ); HASH( h, game->blHunterPreyY );
+	HASH( h, game->blHunterTimeLeft ); HASH( h, game->blInvaderLimit );
+	HASH( h, game->blNumInvaders ); HASH( h, game->blNumKilledInvaders );
+	HASH( h, game->blInvaderTime );
+	for ( i = 0; i < game->blTotalNumDucks && game->blDuckPositions; i++ ) {
+		HASH( h, game->blDuckPositions[i * 2] );
+		HASH( h, game->blDuckPositions[i * 2 + 1] );
+	}
+	for ( i = 0; i < INVADERS_MAXLIMIT; i++ ) {
+		HASH( h, game->blInvaders[i].x ); HASH( h, game->blInvaders[i].y );
+		HASH( h, game->blInvaders[i].delay );
+	}
+	return h;
+}
@@ -28,6 +28,20 @@
 
 /***** TYPE DEFINITIONS ****************************************************/
 
+/* copy of a game's state to go back to, see game_save(). items of the
+ * ball, shot and extra lists are copied, the brick lists keep their
+ * pointers into the brick map. the arrays only grow so saving into the
+ * same snapshot again needs no allocation. */
+typedef struct {
+	void	*items;
+	int	count, size;
+} GameSnapshotList;
+typedef struct {
+	Game	game;
+	Paddle	paddles[2];
+	GameSnapshotList balls, shots, extras, exp_bricks, heal_bricks;
+} GameSnapshot;
+
 /***** PUBLIC FUNCTIONS ****************************************************/
 
 #ifdef __cplusplus
@@ -52,6 +66,10 @@ void game_finalize( Game *game );
 /* set the game context the subfunctions will apply their changes to */
 void game_set_current( Game *game );
 
+/* seed the random numbers of the game. same seed, level and input
+ * result in the same game. */
+void game_set_seed( Game *game, unsigned int seed );
+
 /* set score of paddle 'id'. 0 is bottom paddle and 1 is top paddle */
 void game_set_score( int id, int score );
 
@@ -124,6 +142,28 @@ void game_update_stats( int id, GameStats *stats );
 /* set algorithm for getting ball targets (ball collision check) */
 void game_set_bcc_type(int type);
 
+/* use integer math for balls so that results are the same on any
+ * machine and build (see balls.c) */
+void game_set_fixed_physics( int fixed );
+
+/* get difficulty id 'game' was created with */
+int game_get_diff( Game *game );
+
+/* save the state of 'game' into 'snapshot' or set it back to it. a
+ * snapshot can only be restored to the game it was taken from as
+ * pointers to paddles and bricks are kept. restoring reuses the list
+ * items of the game, so both are quick enough to be done every frame
+ * (rollback of network games). */
+void game_save( Game *game, GameSnapshot *snapshot );
+void game_restore( Game *game, GameSnapshot *snapshot );
+/* free the arrays of a snapshot (not the snapshot itself) */
+void game_snapshot_free( GameSnapshot *snapshot );
+
+/* hash of the game state that is changed by game_update() (bricks,
+ * balls, shots, extras, paddles, timers and random state). games
+ * with the same hash after each update behaved identically. */
+unsigned long long game_get_hash( Game *game );
+
 #ifdef __cplusplus
 }
 #endif
@@ -40,6 +40,19 @@
 #define _(str) (str)
 #endif
 
+/* globals that belong to the current game context are thread local so
+ * that independent games can be run in parallel threads */
+#ifdef _MSC_VER
+#define GAME_TLS __declspec(thread)
+#else
+#define GAME_TLS __thread
+#endif
+
+/* version of the game logic (ball physics, bricks, extras, autopilot).
+ * increase it whenever a change alters how a game plays out so that
+ * stored results like level stats are not reused */
+#define GAME_LOGIC_VERSION 1
+
 typedef struct {
 	int x, y, w, h;
 } ScreenRect;
@@ -222,13 +235,53 @@ typedef struct Level {
   char 	extras[EDIT_WIDTH][EDIT_HEIGHT];
   int   normal_brick_count;
   int   type; /* normal or type of bonus level */
+  unsigned long long hash; /* of bricks and extras as loaded, identifies
+			      level regardless of set and name */
 } Level;
+/* compiled levelsets: header, set table and Level records as in memory
+ * so levels can be used directly from the mapped file. bricks and extras
+ * keep their map characters like levels loaded from text, they are
+ * converted by brick_conv_table when a level is initialized as before
+ * since game, editor and level hash all work on the characters. */
+#define LEVELBIN_MAGIC "LBRBIN01"
+typedef struct {
+	char	magic[8];
+	int	level_size; /* sizeof(Level) of compiling build */
+	int	set_count;
+	int	level_count;
+	int	reserved;
+	unsigned long long key; /* identifies source files */
+} LevelBinHeader;
+typedef struct {
+	char	name[32];
+	int	version, update;
+	int	first, count; /* range of level records */
+} LevelBinSet;
+typedef struct {
+	char	*data; /* whole file */
+	size_t	size;
+	int	mapped; /* data is mmapped, otherwise allocated */
+	LevelBinHeader *header;
+	LevelBinSet *sets;
+	Level	*levels;
+} LevelBin;
+
+/* reference to a level not yet loaded */
+typedef struct {
+	int	set; /* index in ref_sets or -1 for bonus level */
+	int	id; /* level in set file or bonus level type */
+} LevelRef;
+
 typedef struct {
 	char	name[20];
 	int 	count;
 	int	version, update;
 	int	cur_level; /* id of current level */
 	Level	**levels;
+	LevelBin *bin; /* if set, levels within it are views into the file */
+	LevelRef *refs; /* if set, levels are NULL until first access */
+	char	**ref_sets; /* levelset names used by refs */
+	int	ref_set_count;
 } LevelSet;
 
 typedef struct {
@@ -372,6 +425,19 @@ typedef struct {
                            and clear this flag */
 } Ball;
 
+/* predicted contact of a ball, see ball_predict() */
+enum {
+	CONTACT_BRICK = 0, /* brick or wall at mx,my */
+	CONTACT_PADDLE 	/* level of paddle is reached */
+};
+typedef struct {
+	int	type;
+	float	x, y; 	/* position of ball (upper left corner) */
+	int	mx, my; /* brick or -1 */
+	int	paddle; /* PADDLE_BOTTOM, PADDLE_TOP or -1 */
+	float	time; 	/* ms from now */
+} BallContact;
+
 typedef struct {
     float   x, y;
     Target  target;
@@ -484,6 +550,7 @@ typedef struct {
 	int		balls_return_by_click;
 	int		balls_use_random_angle;
 	int		bcc_type; /* ball collision check type */
+	int		fixed_physics; /* integer ball physics, see balls.c */
         float           accelerated_ball_speed;
 	int		frag_limit; /* number of points a player must gain to win a 
 				       pingpong level */
@@ -551,6 +618,10 @@ typedef struct {
   int blInvaderTime;        /* within a wave invaders will speed up too */
   int blInvaderScore;       /* score per invader kill */
   Invader blInvaders[INVADERS_MAXLIMIT]; /* current positions, if x != -1 */
+
+  /* per game state so games are independent of each other */
+  unsigned long long rand_state; /* see GAME_RAND() */
+  int time; /* ms passed in game_update() */
 } Game;
 
 #define SETBIT( data, bit ) data |= (1L << bit )
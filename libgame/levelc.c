@@ -0,0 +1,38 @@
+/***************************************************************************
+                          levelc.c  -  levelset compiler
+                             -------------------
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/* Compile levelsets into one binary file as used for freakout mode.
+ * Set names are relative to the installation levels directory unless
+ * they start with ~ (home directory) or /. The key is computed from
+ * the sets as given so the game will only accept the file if it uses
+ * the same names (e.g. levelc ~/.lbreakouthd/levels.bin LBreakout1 ...). */
+
+#include "levels.h"
+
+int main( int argc, char **argv )
+{
+	List *sets;
+	int i, ok;
+
+	if ( argc < 3 ) {
+		fprintf( stderr, "Usage: %s OUTFILE SET...\n", argv[0] );
+		return 1;
+	}
+	sets = list_create( LIST_NO_AUTO_DELETE, 0 );
+	for ( i = 2; i < argc; i++ )
+		list_add( sets, argv[i] );
+	ok = levelset_compile( sets, argv[1], levelsets_get_key( sets ) );
+	list_delete( sets );
+	return ok ? 0 : 1;
+}
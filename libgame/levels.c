@@ -15,6 +15,13 @@
  *                                                                         *
  ***************************************************************************/
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 #include "levels.h"
 
 /*
@@ -57,6 +64,173 @@ char *get_home_dir() {
 	return (getenv( "HOME" )?getenv( "HOME" ):fallback);
 }
 
+/* build full path of levelset file 'fname' */
+static void levelset_get_path( const char *fname, char *path, int size )
+{
+	if ( fname[0] == '~') {
+		snprintf( path, size-1, "%s/%s/levels/%s",
+			get_home_dir(), CONFIG_DIR_NAME, fname + 1 );
+	}
+	else
+	if ( fname[0] != '/' ) /* keep global pathes */
+		snprintf( path, size-1, "%s/levels/%s", SRC_DIR, fname );
+	else
+		snprintf( path, size-1, "%s", fname );
+}
+
+/* compare (hash, position) pairs by hash then position */
+static int compare_hash_pos( const void *a, const void *b )
+{
+	const unsigned long long *p = a, *q = b;
+	if ( p[0] != q[0] )
+		return ( p[0] < q[0] ) ? -1 : 1;
+	if ( p[1] != q[1] )
+		return ( p[1] < q[1] ) ? -1 : 1;
+	return 0;
+}
+
+/* return allocated array of count flags which are set for levels that
+ * have the same hash as a level before them. 0 is an unknown hash. */
+static char *levels_get_duplicates( unsigned long long *hashes, int count )
+{
+	unsigned long long *pairs;
+	char *dups = salloc( count + 1, 1 );
+	int i;
+
+	pairs = salloc( count + 1, 2 * sizeof( unsigned long long ) );
+	for ( i = 0; i < count; i++ ) {
+		pairs[2*i] = hashes[i];
+		pairs[2*i+1] = i;
+	}
+	qsort( pairs, count, 2 * sizeof( unsigned long long ), compare_hash_pos );
+	for ( i = 1; i < count; i++ )
+		if ( pairs[2*i] != 0 && pairs[2*i] == pairs[2*i-2] )
+			dups[pairs[2*i+1]] = 1;
+	free( pairs );
+	return dups;
+}
+
+/* remove levels from list that are identical to an earlier one and
+ * delete them if 'delete' is True */
+static void levels_remove_duplicates( List *levels, int delete )
+{
+	unsigned long long *hashes;
+	char *dups;
+	Level *level;
+	int i, num;
+
+	if ( levels->count == 0 ) return;
+	hashes = salloc( levels->count, sizeof( unsigned long long ) );
+	list_reset( levels ); i = 0;
+	while ( ( level = list_next( levels ) ) )
+		hashes[i++] = level->hash;
+	dups = levels_get_duplicates( hashes, levels->count );
+	list_reset( levels ); i = 0; num = 0;
+	while ( ( level = list_next( levels ) ) )
+		if ( dups[i++] ) {
+			list_delete_current( levels );
+			if ( delete )
+				level_delete( level );
+			num++;
+		}
+	if ( num > 0 )
+		printf( "%i duplicate levels skipped\n", num );
+	free( dups );
+	free( hashes );
+}
+
+/* create bonus level of type as list item for levels_shuffle() */
+static void *create_bonus_level( int type )
+{
+	Level *level = level_create_empty("LGames", "Bonus Level");
+	level->type = type;
+	return level;
+}
+static void *create_bonus_ref( int type )
+{
+	LevelRef *ref = salloc( 1, sizeof( LevelRef ) );
+	ref->set = -1;
+	ref->id = type;
+	return ref;
+}
+
+/* shake items (levels or level references) in list with fixed seed and
+ * insert a bonus level created by create_bonus after every four items
+ * if addBonusLevels is not 0 (it is the seed then). random generator
+ * is reinitiated with current time when done. */
+static void levels_shuffle( List *levels, int seed, int addBonusLevels,
+			void *(*create_bonus)( int type ) )
+{
+	int i, j, num;
+	ListEntry *entry;
+	void **pointers, *level;
+
+	if ( levels->count == 0 ) return;
+	
+    /* shake the levels a bit */
+    srand(seed);
+    list_reset( levels ); i = 0;
+    pointers = calloc( levels->count, sizeof( void* ) );
+    while ( ( level = list_next( levels ) ) ) {
+        i = rand() % levels->count;
+        while ( pointers[i] ) {
+            i++;
+            if ( i == levels->count )
+                i = 0;
+        }
+        pointers[i] = level;
+    }
+    entry = levels->head->next;
+    for ( i = 0; i < levels->count; i++ ) {
+        entry->item = pointers[i];
+        entry = entry->next;
+    }
+    free( pointers );
+    /* add bonus levels every four normal levels */
+    if (addBonusLevels)
+    {
+        srand(addBonusLevels);
+        num = levels->count / 4;
+        for (i=0,j=4;i<num;i++)
+        {
+            level = create_bonus(RANDOM(LT_JUMPING_JACK,LT_LAST-1));
+            list_insert(levels,level,j);
+            j += 5;
+        }
+    }
+    srand(time(0));
+}
+
+/* skip to level 'id' in levelset file (counted from 0). file
+ * position is at its "Level:" line then. Return True if found. */
+static int level_seek( FILE *file, int id )
+{
+	char buffer[1024];
+	long pos;
+	int dummy;
+
+	levelset_get_version( file, &dummy, &dummy );
+	while ( 1 ) {
+		pos = ftell( file );
+		if ( !next_line( file, buffer ) )
+			return 0;
+		if ( strncmp( "Level:", buffer, 6 ) )
+			continue;
+		if ( id-- == 0 )
+			break;
+	}
+	fseek( file, pos, SEEK_SET );
+	return 1;
+}
+
+/* check whether level is a view into the compiled sets of 'set' */
+static int level_is_mapped( LevelSet *set, Level *level )
+{
+	if ( set->bin == 0 ) return 0;
+	return ( level >= set->bin->levels &&
+		level < set->bin->levels + set->bin->header->level_count );
+}
+
 /*
 ====================================================================
 Publics
@@ -72,16 +246,7 @@ FILE *levelset_open( const char *fname, char *mode )
 {
 	FILE *file;
 	char path[512];
-	if ( fname[0] == '~') {
-		snprintf( path, sizeof(path)-1, "%s/%s/levels/%s",
-			get_home_dir(), CONFIG_DIR_NAME, fname + 1 );
-	}
-	else
-	if ( fname[0] != '/' ) /* keep global pathes */
-		snprintf( path, sizeof(path)-1, "%s/levels/%s", SRC_DIR, fname );
-	else
-		snprintf( path, sizeof(path)-1, "%s", fname );
-				
+	levelset_get_path( fname, path, sizeof(path) );
 	if ( ( file = fopen( path, mode ) ) == 0 ) {
 		fprintf( stderr, "couldn't open %s\n", path );
 		return 0;
@@ -209,48 +374,14 @@ LevelSet *levelset_load_all( List *levelsets, int seed, int addBonusLevels )
 	char *setname;
 	int version, update;
 	List *levels = list_create( LIST_NO_AUTO_DELETE, 0 );
-	int i, j, num;
-	ListEntry *entry;
-	Level **pointers, *level;
 
         /* use sets from install directory only (no preceding ~) */
 	list_reset( levelsets );
 	while ( (setname = list_next( levelsets )) && setname[0] != '~' )
         levels_load( setname, levels, &version, &update );
 	
-    /* shake the levels a bit */
-    srand(seed);
-    list_reset( levels ); i = 0;
-    pointers = calloc( levels->count, sizeof( Level* ) );
-    while ( ( level = list_next( levels ) ) ) {
-        i = rand() % levels->count;
-        while ( pointers[i] ) {
-            i++;
-            if ( i == levels->count )
-                i = 0;
-        }
-        pointers[i] = level;
-    }
-    entry = levels->head->next;
-    for ( i = 0; i < levels->count; i++ ) {
-        entry->item = pointers[i];
-        entry = entry->next;
-    }
-    free( pointers );
-    /* add bonus levels every four normal levels */
-    if (addBonusLevels)
-    {
-        srand(addBonusLevels);
-        num = levels->count / 4;
-        for (i=0,j=4;i<num;i++)
-        {
-            level = level_create_empty("LGames", "Bonus Level");
-            level->type = RANDOM(LT_JUMPING_JACK,LT_LAST-1);
-            list_insert(levels,level,j);
-            j += 5;
-        }
-    }
-    srand(time(0));
+	levels_remove_duplicates( levels, 1 );
+	levels_shuffle( levels, seed, addBonusLevels, create_bonus_level );
         
 	version = 1; update = 0;
 	set = levelset_build_from_list( levels, TOURNAMENT, version, update );
@@ -263,6 +394,339 @@ LevelSet *levelset_load_all( List *levelsets, int seed, int addBonusLevels )
 }
 /*
 ====================================================================
+Get key for listed levelsets. It covers the names, modification
+time and size of the files (up to the first custom set as in
+levelset_load_all) and the size of a level record.
+====================================================================
+*/
+unsigned long long levelsets_get_key( List *levelsets )
+{
+	unsigned long long key = 14695981039346656037ULL;
+	struct stat st;
+	char path[512];
+	char *setname;
+	long long stamp[2];
+	int size = sizeof( Level );
+
+	key = hash_data( &size, sizeof(size), key );
+	list_reset( levelsets );
+	while ( (setname = list_next( levelsets )) && setname[0] != '~' ) {
+		key = hash_data( setname, strlen(setname) + 1, key );
+		levelset_get_path( setname, path, sizeof(path) );
+		stamp[0] = stamp[1] = 0;
+		if ( stat( path, &st ) == 0 ) {
+			stamp[0] = st.st_mtime;
+			stamp[1] = st.st_size;
+		}
+		key = hash_data( stamp, sizeof(stamp), key );
+	}
+	return key;
+}
+/*
+====================================================================
+Compile all levels of listed levelsets (up to the first custom set
+as in levelset_load_all) into file 'fname' with 'key'. The file is
+written under a temporary name and renamed when complete so it may
+be compiled while the game is running.
+Return Value: True if successful.
+====================================================================
+*/
+int levelset_compile( List *levelsets, const char *fname, unsigned long long key )
+{
+	LevelBinHeader header;
+	LevelBinSet *sets;
+	List *levels = list_create( LIST_AUTO_DELETE, level_delete );
+	FILE *file;
+	char *setname, tmpname[512];
+	Level *level;
+	int num, ok = 1;
+
+	/* load levels and fill set table */
+	sets = calloc( levelsets->count, sizeof( LevelBinSet ) );
+	num = 0;
+	list_reset( levelsets );
+	while ( (setname = list_next( levelsets )) && setname[0] != '~' ) {
+		if ( setname[0] == '!' )
+			continue;
+		snprintf( sets[num].name, 32, "%s", setname );
+		sets[num].first = levels->count;
+		if ( !levels_load( setname, levels, &sets[num].version, &sets[num].update ) ) {
+			/* drop whatever was loaded of this set */
+			while ( levels->count > sets[num].first )
+				list_delete_pos( levels, levels->count - 1 );
+			continue;
+		}
+		sets[num].count = levels->count - sets[num].first;
+		num++;
+	}
+	
+	memset( &header, 0, sizeof(header) );
+	memcpy( header.magic, LEVELBIN_MAGIC, 8 );
+	header.level_size = sizeof( Level );
+	header.set_count = num;
+	header.level_count = levels->count;
+	header.key = key;
+	
+	snprintf( tmpname, sizeof(tmpname), "%s.tmp", fname );
+	if ( ( file = fopen( tmpname, "wb" ) ) == 0 ) {
+		fprintf( stderr, "couldn't open %s\n", tmpname );
+		ok = 0;
+	}
+	else {
+		if ( fwrite( &header, sizeof(header), 1, file ) != 1 )
+			ok = 0;
+		if ( num > 0 && fwrite( sets, sizeof(LevelBinSet), num, file ) != num )
+			ok = 0;
+		list_reset( levels );
+		while ( ok && ( level = list_next( levels ) ) )
+			if ( fwrite( level, sizeof(Level), 1, file ) != 1 )
+				ok = 0;
+		if ( fclose( file ) != 0 )
+			ok = 0;
+		if ( ok ) {
+#ifdef WIN32
+			remove( fname ); /* rename does not replace here */
+#endif
+			if ( rename( tmpname, fname ) != 0 )
+				ok = 0;
+		}
+		if ( !ok ) {
+			fprintf( stderr, "couldn't write %s\n", fname );
+			remove( tmpname );
+		}
+		else
+			printf( "%s: %i sets, %i levels\n", fname, num, levels->count );
+	}
+	free( sets );
+	list_delete( levels );
+	return ok;
+}
+/*
+====================================================================
+Open compiled levelsets. The file is mapped privately so levels may
+be modified in memory without changing it. Return NULL if file does
+not exist, is broken or 'key' does not match (if not 0).
+====================================================================
+*/
+LevelBin *levelbin_open( const char *fname, unsigned long long key )
+{
+	LevelBin *bin = 0;
+	LevelBinHeader *header;
+	struct stat st;
+	size_t size;
+	int i;
+#ifdef WIN32
+	FILE *file;
+
+	if ( stat( fname, &st ) != 0 || st.st_size < sizeof(LevelBinHeader) )
+		return 0;
+	if ( ( file = fopen( fname, "rb" ) ) == 0 )
+		return 0;
+	bin = salloc( 1, sizeof( LevelBin ) );
+	bin->size = st.st_size;
+	bin->data = malloc( bin->size );
+	if ( fread( bin->data, bin->size, 1, file ) != 1 ) {
+		fclose( file );
+		goto failure;
+	}
+	fclose( file );
+#else
+	int fd;
+	void *data;
+
+	if ( ( fd = open( fname, O_RDONLY ) ) == -1 )
+		return 0;
+	if ( fstat( fd, &st ) != 0 || st.st_size < sizeof(LevelBinHeader) ) {
+		close( fd );
+		return 0;
+	}
+	data = mmap( 0, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0 );
+	close( fd );
+	if ( data == MAP_FAILED ) {
+		fprintf( stderr, "couldn't map %s\n", fname );
+		return 0;
+	}
+	bin = salloc( 1, sizeof( LevelBin ) );
+	bin->data = data;
+	bin->size = st.st_size;
+	bin->mapped = 1;
+#endif
+	/* check header and sizes */
+	header = (LevelBinHeader*)bin->data;
+	if ( memcmp( header->magic, LEVELBIN_MAGIC, 8 ) ||
+			header->level_size != sizeof( Level ) ||
+			(key && header->key != key) ||
+			header->set_count < 0 || header->level_count < 0 )
+		goto failure;
+	size = sizeof( LevelBinHeader ) +
+		header->set_count * sizeof( LevelBinSet ) +
+		header->level_count * sizeof( Level );
+	if ( size != bin->size )
+		goto failure;
+	bin->header = header;
+	bin->sets = (LevelBinSet*)(bin->data + sizeof( LevelBinHeader ));
+	bin->levels = (Level*)(bin->sets + header->set_count);
+	for ( i = 0; i < header->set_count; i++ )
+		if ( bin->sets[i].first < 0 || bin->sets[i].count < 0 ||
+				bin->sets[i].first + bin->sets[i].count > header->level_count )
+			goto failure;
+	return bin;
+failure:
+	levelbin_close( &bin );
+	return 0;
+}
+void levelbin_close( LevelBin **bin )
+{
+	if ( *bin == 0 ) return;
+#ifndef WIN32
+	if ( (*bin)->mapped ) 
+		munmap( (*bin)->data, (*bin)->size );
+	else
+#endif
+		free( (*bin)->data );
+	free( *bin ); *bin = 0;
+}
+/*
+====================================================================
+Same as levelset_load_all but take levels from compiled sets.
+Levels are not copied, so the set owns the bin on success. On
+failure the bin is closed.
+====================================================================
+*/
+LevelSet *levelset_load_all_bin( LevelBin *bin, int seed, int addBonusLevels )
+{
+	LevelSet *set;
+	List *levels = list_create( LIST_NO_AUTO_DELETE, 0 );
+	int i;
+
+	for ( i = 0; i < bin->header->level_count; i++ )
+		list_add( levels, &bin->levels[i] );
+	
+	levels_remove_duplicates( levels, 0 );
+	levels_shuffle( levels, seed, addBonusLevels, create_bonus_level );
+	
+	set = levelset_build_from_list( levels, TOURNAMENT, 1, 0 );
+	if ( set == 0 ) {
+		fprintf( stderr, "empty levelset: %s\n", TOURNAMENT );
+		levelbin_close( &bin );
+	}
+	else {
+		set->bin = bin;
+		printf( "%s v%i.%02i: %i levels (compiled)\n", TOURNAMENT, 
+			set->version, set->update, set->count );
+	}
+	return set;
+}
+/*
+====================================================================
+Build index of all levels in listed levelsets (up to the first
+custom set) without loading them.
+====================================================================
+*/
+LevelSet *levelset_load_all_lazy( List *levelsets, int *counts,
+		unsigned long long **hashes, int seed, int addBonusLevels )
+{
+	LevelSet *set;
+	List *refs = list_create( LIST_AUTO_DELETE, 0 );
+	LevelRef *ref;
+	char *setname, *dups;
+	unsigned long long *all;
+	int i, j, k, total, num = 0;
+
+	/* get duplicates in order of levels_load() */
+	total = 0;
+	list_reset( levelsets );
+	while ( (setname = list_next( levelsets )) && setname[0] != '~' )
+		total += counts[num++];
+	all = salloc( total + 1, sizeof( unsigned long long ) );
+	for ( i = 0, k = 0; i < num; i++ )
+		for ( j = 0; j < counts[i]; j++, k++ )
+			if ( hashes && hashes[i] )
+				all[k] = hashes[i][j];
+	dups = levels_get_duplicates( all, total );
+	
+	/* build references of unique levels */
+	for ( i = 0, k = 0; i < num; i++ )
+		for ( j = 0; j < counts[i]; j++, k++ ) {
+			if ( dups[k] )
+				continue;
+			ref = salloc( 1, sizeof( LevelRef ) );
+			ref->set = i;
+			ref->id = j;
+			list_add( refs, ref );
+		}
+	if ( refs->count < total )
+		printf( "%i duplicate levels skipped\n", total - refs->count );
+	free( dups );
+	free( all );
+	if ( refs->count == 0 ) {
+		fprintf( stderr, "empty levelset: %s\n", TOURNAMENT );
+		list_delete( refs );
+		return 0;
+	}
+	
+	levels_shuffle( refs, seed, addBonusLevels, create_bonus_ref );
+
+	set = salloc( 1, sizeof( LevelSet ) );
+	snprintf( set->name, 20, "%s", TOURNAMENT );
+	set->version = 1; set->update = 0;
+	set->count = refs->count;
+	set->levels = salloc( set->count, sizeof( Level* ) );
+	set->refs = salloc( set->count, sizeof( LevelRef ) );
+	list_reset( refs ); i = 0;
+	while ( (ref = list_next( refs )) )
+		set->refs[i++] = *ref;
+	list_delete( refs );
+	set->ref_set_count = num;
+	set->ref_sets = salloc( num, sizeof( char* ) );
+	list_reset( levelsets );
+	for ( i = 0; i < num; i++ )
+		set->ref_sets[i] = strdup( list_next( levelsets ) );
+	printf( "%s v%i.%02i: %i levels (on demand)\n", TOURNAMENT, 
+		set->version, set->update, set->count );
+	return set;
+}
+Level *levelset_load_ref( LevelSet *set, int id )
+{
+	LevelRef *ref;
+	Level *level;
+	FILE *file;
+
+	if ( set->refs == 0 || id < 0 || id >= set->count )
+		return 0;
+	ref = &set->refs[id];
+	if ( ref->set == -1 )
+		return create_bonus_level( ref->id );
+	if ( ( file = levelset_open( set->ref_sets[ref->set], "rb" ) ) == 0 )
+		return 0;
+	level = 0;
+	if ( level_seek( file, ref->id ) )
+		level = level_load( file );
+	fclose( file );
+	if ( level == 0 )
+		fprintf( stderr, "couldn't load level %i of %s\n",
+			ref->id, set->ref_sets[ref->set] );
+	return level;
+}
+/*
+====================================================================
+Get level by id. If not loaded yet it is loaded now. A level that
+cannot be loaded is replaced by an empty one so id is always valid.
+====================================================================
+*/
+Level *levelset_get_level( LevelSet *set, int id )
+{
+	if ( set->levels[id] == 0 ) {
+		set->levels[id] = levelset_load_ref( set, id );
+		if ( set->levels[id] == 0 ) {
+			char str[20] = "none";
+			set->levels[id] = level_create_empty( str, str );
+		}
+	}
+	return set->levels[id];
+}
+/*
+====================================================================
 Build a levelset from a level list and delete the list.
 The levels are taken from the list so it must not have AUTO_DELETE
 enabled!
@@ -364,10 +828,18 @@ void levelset_delete( LevelSet **set )
 	if ( *set == 0 ) return;
 	if ( (*set)->levels ) {
 		for ( i = 0; i < (*set)->count; i++ )
-			if ( (*set)->levels[i] )
+			if ( (*set)->levels[i] && !level_is_mapped( *set, (*set)->levels[i] ) )
 				level_delete( (*set)->levels[i] );
 		free( (*set)->levels );
 	}
+	levelbin_close( &(*set)->bin );
+	if ( (*set)->refs )
+		free( (*set)->refs );
+	if ( (*set)->ref_sets ) {
+		for ( i = 0; i < (*set)->ref_set_count; i++ )
+			free( (*set)->ref_sets[i] );
+		free( (*set)->ref_sets );
+	}
 	free( *set ); *set = 0;
 }
 void levelset_list_delete( void *ptr )
@@ -383,13 +855,13 @@ levels remain, NULL is returned.
 */
 Level* levelset_get_first( LevelSet *set )
 {
-	return set->levels[0];
+	return levelset_get_level( set, 0 );
 }
 Level* levelset_get_next( LevelSet *set )
 {
 	if ( set->cur_level == set->count )
 		return 0;
-	return set->levels[set->cur_level++];
+	return levelset_get_level( set, set->cur_level++ );
 }
 /*
 ====================================================================
@@ -451,12 +923,8 @@ Level* level_load( FILE *file )
 		for ( j = 0; j < EDIT_WIDTH; j++ )
 			level->extras[j][i] = buffer[j];
 	}
-        /* count destructible bricks */
-        level->normal_brick_count = 0;
-        for ( i = 0; i < EDIT_HEIGHT; i++ )
-            for ( j = 0; j < EDIT_WIDTH; j++ )
-	        if ( is_destructible(level->bricks[j][i]) )
-                    level->normal_brick_count++;
+	level_update_hash( level );
+	level_count_bricks( level );
 	/* a normally loaded level is always of type LT_NORMAL */
 	level->type = LT_NORMAL;
 	/* return level */
@@ -484,10 +952,107 @@ Level* level_create_empty( char *author, char *name )
         }
     /* empty level is always of type LT_NORMAL */
     level->type = LT_NORMAL;
+    level_update_hash( level );
     return level;
 }
 /*
 ====================================================================
+Compute hash of bricks and extras.
+====================================================================
+*/
+void level_update_hash( Level *level )
+{
+	unsigned long long h = 14695981039346656037ULL;
+	h = hash_data( level->bricks, sizeof( level->bricks ), h );
+	h = hash_data( level->extras, sizeof( level->extras ), h );
+	level->hash = h;
+}
+/*
+====================================================================
+Count destructible bricks (normal_brick_count). Done on load, must
+be called again if level was modified.
+====================================================================
+*/
+void level_count_bricks( Level *level )
+{
+	int i, j;
+	level->normal_brick_count = 0;
+	for ( i = 0; i < EDIT_WIDTH; i++ )
+		for ( j = 0; j < EDIT_HEIGHT; j++ )
+			if ( is_destructible( level->bricks[i][j] ) )
+				level->normal_brick_count++;
+}
+/* mark all tiles a ball coming from below can get to. without
+ * energy ball indestructible bricks block like walls. */
+static int level_tile_open( Level *level, int x, int y, int energy )
+{
+	char c = level->bricks[x][y];
+	return c != 'E' && ( energy || ( c != '#' && c != '@' ) );
+}
+static void level_fill( Level *level, int reached[EDIT_WIDTH][EDIT_HEIGHT], int energy )
+{
+	int stack[EDIT_WIDTH * EDIT_HEIGHT][2];
+	int top = 0, i, j, x, y, dx, dy;
+
+	memset( reached, 0, sizeof( int ) * EDIT_WIDTH * EDIT_HEIGHT );
+	/* below the bricks the arena is open */
+	for ( i = 0; i < EDIT_WIDTH; i++ )
+		if ( level_tile_open( level, i, EDIT_HEIGHT - 1, energy ) ) {
+			reached[i][EDIT_HEIGHT - 1] = 1;
+			stack[top][0] = i; stack[top][1] = EDIT_HEIGHT - 1;
+			top++;
+		}
+	while ( top > 0 ) {
+		top--;
+		x = stack[top][0]; y = stack[top][1];
+		/* ball moves to direct neighbours, explosion reaches diagonal
+		 * ones as well but only destructible bricks */
+		for ( dx = -1; dx <= 1; dx++ )
+			for ( dy = -1; dy <= 1; dy++ ) {
+				i = x + dx; j = y + dy;
+				if ( i < 0 || j < 0 || i >= EDIT_WIDTH || j >= EDIT_HEIGHT )
+					continue;
+				if ( reached[i][j] || !level_tile_open( level, i, j, energy ) )
+					continue;
+				if ( dx != 0 && dy != 0 && ( level->bricks[x][y] != '*' ||
+						!is_destructible( level->bricks[i][j] ) ) )
+					continue;
+				reached[i][j] = 1;
+				stack[top][0] = i; stack[top][1] = j;
+				top++;
+			}
+	}
+}
+/*
+====================================================================
+Count destructible bricks that can't be reached by a ball coming
+from below. 'walled' are enclosed by walls (E) and can't be
+reached at all, 'energy' can only be reached by an energy ball as
+they are enclosed by indestructible bricks (#, @). Explosive
+bricks are considered to destroy their neighbours.
+====================================================================
+*/
+void level_get_unreachable( Level *level, int *walled, int *energy )
+{
+	int with_energy[EDIT_WIDTH][EDIT_HEIGHT];
+	int without_energy[EDIT_WIDTH][EDIT_HEIGHT];
+	int i, j;
+
+	level_fill( level, with_energy, 1 );
+	level_fill( level, without_energy, 0 );
+	*walled = *energy = 0;
+	for ( i = 0; i < EDIT_WIDTH; i++ )
+		for ( j = 0; j < EDIT_HEIGHT; j++ ) {
+			if ( !is_destructible( level->bricks[i][j] ) )
+				continue;
+			if ( !with_energy[i][j] )
+				(*walled)++;
+			else if ( !without_energy[i][j] )
+				(*energy)++;
+		}
+}
+/*
+====================================================================
 Delete level pointer.
 ====================================================================
 */
@@ -56,6 +56,42 @@ and reinit random generator with current time when done.
 LevelSet *levelset_load_all( List *levelsets, int seed, int addBonusLevels );
 /*
 ====================================================================
+Compiled levelsets. Identical levels (by hash) are only used once
+in all variants of the superset.
+levelsets_get_key() returns a key for the names
+and file stamps of the listed levelsets. levelset_compile() writes
+all levels of the listed sets in binary form to fname (full path).
+levelbin_open() maps such a file if its key matches (0 accepts any
+key). levelset_load_all_bin() works like levelset_load_all() but
+uses levels from the file directly without copying; the bin is owned
+by the returned set then and unmapped when the set is deleted.
+====================================================================
+*/
+unsigned long long levelsets_get_key( List *levelsets );
+int levelset_compile( List *levelsets, const char *fname, unsigned long long key );
+LevelBin *levelbin_open( const char *fname, unsigned long long key );
+void levelbin_close( LevelBin **bin );
+LevelSet *levelset_load_all_bin( LevelBin *bin, int seed, int addBonusLevels );
+/*
+====================================================================
+Same as levelset_load_all() but only build an index of references
+to the levels which are loaded on first access by
+levelset_get_level(). 'counts' holds the number of levels for each
+listed levelset so no file has to be read. 'hashes' holds the
+level hashes for each set to skip duplicates. It may be NULL as may
+be any entry for which no hashes are known (0 is unknown, too). Levels are ordered
+exactly as by levelset_load_all().
+levelset_load_ref() loads a referenced level without storing it in
+the set (which is not changed then so this may be used by another
+thread). NULL is returned if the level can't be loaded.
+====================================================================
+*/
+LevelSet *levelset_load_all_lazy( List *levelsets, int *counts,
+		unsigned long long **hashes, int seed, int addBonusLevels );
+Level *levelset_load_ref( LevelSet *set, int id );
+Level *levelset_get_level( LevelSet *set, int id );
+/*
+====================================================================
 Build a levelset from a level list and delete the list.
 The levels are taken from the list so it must not have AUTO_DELETE
 enabled!
@@ -111,6 +147,29 @@ Create an empty level
 Level* level_create_empty( char *author, char *name );
 /*
 ====================================================================
+Compute hash of bricks and extras. Done on load and creation, must
+be called again if level was modified.
+====================================================================
+*/
+void level_update_hash( Level *level );
+/*
+====================================================================
+Count destructible bricks (normal_brick_count). Done on load, must
+be called again if level was modified.
+====================================================================
+*/
+void level_count_bricks( Level *level );
+/*
+====================================================================
+Count destructible bricks that can't be reached by a ball coming
+from below. 'walled' are enclosed by walls (E) and can't be
+reached at all, 'energy' can only be reached by an energy ball as
+they are enclosed by indestructible bricks (#, @).
+====================================================================
+*/
+void level_get_unreachable( Level *level, int *walled, int *energy );
+/*
+====================================================================
 Delete level pointer.
 ====================================================================
 */
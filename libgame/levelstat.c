@@ -0,0 +1,172 @@
+/***************************************************************************
+                          levelstat.c  -  level difficulty report
+                             -------------------
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/* Report difficulty and solvability of all levels of the given sets (or
+ * all installed sets with -a): median clear time, lost balls, bricks that
+ * can't be reached and whether the warp limit is reachable. Results are
+ * cached by level content in the file given by -c so that only new or
+ * changed levels are simulated next time (e.g. levelstat -a -c stats.txt).
+ * Notes: "stuck" means neither clear nor warp is possible, "warp" means
+ * the level can only be finished by warp, "energy" means an energy ball
+ * is needed to clear it. */
+
+#include <unistd.h>
+#include <dirent.h>
+#include <SDL2/SDL.h>
+#include "analyze.h"
+
+static int compare_str( const void *a, const void *b )
+{
+	return strcmp( *(char* const*)a, *(char* const*)b );
+}
+
+/* add names of all installed sets to 'names' */
+static void add_installed_sets( List *names )
+{
+	char path[512], *list[1024];
+	struct dirent *entry;
+	DIR *dir;
+	int i, count = 0;
+
+	snprintf( path, sizeof( path ), "%s/levels", SRC_DIR );
+	if ( ( dir = opendir( path ) ) == 0 ) {
+		fprintf( stderr, "couldn't open %s\n", path );
+		return;
+	}
+	while ( ( entry = readdir( dir ) ) != 0 && count < 1024 )
+		if ( entry->d_name[0] != '.' )
+			list[count++] = strdup( entry->d_name );
+	closedir( dir );
+	qsort( list, count, sizeof( char* ), compare_str );
+	for ( i = 0; i < count; i++ )
+		list_add( names, list[i] );
+}
+
+static void print_time( int ms )
+{
+	if ( ms < 0 )
+		printf( "     -  " );
+	else
+		printf( " %6.1fs", ms / 1000.0 );
+}
+
+static const char *get_note( LevelStats *s )
+{
+	if ( s->walled + s->energy >= s->warp_limit && s->walled + s->energy > 0 )
+		return ( s->walled >= s->warp_limit ) ? "stuck" : "energy";
+	if ( s->walled > 0 )
+		return "warp";
+	if ( s->energy > 0 )
+		return "energy";
+	return "";
+}
+
+int main( int argc, char **argv )
+{
+	SimConfig cfg;
+	StatsCache *cache;
+	LevelSet **sets;
+	Level **levels;
+	LevelStats *stats, *s;
+	List *names;
+	char *name, *cname = 0;
+	int threads = 0, attempts = 10, seed = 0, all = 0;
+	int c, i, j, k, set_count = 0, total = 0, analyzed = 0, stuck = 0;
+	Uint32 start;
+
+	sim_config_default( &cfg );
+	cfg.max_time = 300000;
+	while ( ( c = getopt( argc, argv, "aj:n:s:b:d:w:t:c:" ) ) != -1 ) {
+		switch ( c ) {
+			case 'a': all = 1; break;
+			case 'j': threads = atoi( optarg ); break;
+			case 'n': attempts = atoi( optarg ); break;
+			case 's': seed = atoi( optarg ); break;
+			case 'b': cfg.skill = atoi( optarg ); break;
+			case 'd': cfg.diff = atoi( optarg ); break;
+			case 'w': cfg.rel_warp_limit = atoi( optarg ); break;
+			case 't': cfg.max_time = atoi( optarg ) * 1000; break;
+			case 'c': cname = optarg; break;
+			default: optind = argc; all = 0; break;
+		}
+	}
+	if ( ( !all && optind >= argc ) || attempts < 1 ||
+			cfg.skill < 0 || cfg.skill >= BOT_SKILL_COUNT ||
+			cfg.diff < 0 || cfg.diff >= DIFF_COUNT ) {
+		fprintf( stderr, "Usage: %s [-j threads] [-n attempts] [-s seed] "
+				"[-b bot skill 0-2] [-d diff 0-4] [-w warp percent] "
+				"[-t max secs] [-c cache file] -a | SET...\n", argv[0] );
+		return 1;
+	}
+
+	names = list_create( LIST_AUTO_DELETE, LIST_NO_CALLBACK );
+	if ( all )
+		add_installed_sets( names );
+	for ( i = optind; i < argc; i++ )
+		list_add( names, strdup( argv[i] ) );
+
+	/* all levels are analyzed in one batch to keep all cores busy */
+	sets = salloc( names->count, sizeof( LevelSet* ) );
+	list_reset( names );
+	while ( ( name = list_next( names ) ) != 0 ) {
+		/* bonus levels have no regular end so only normal levels are played */
+		if ( ( sets[set_count] = levelset_load( name, 0 ) ) == 0 )
+			continue;
+		total += sets[set_count]->count;
+		set_count++;
+	}
+	levels = salloc( total + 1, sizeof( Level* ) );
+	stats = salloc( total + 1, sizeof( LevelStats ) );
+	for ( i = 0, k = 0; i < set_count; i++ )
+		for ( j = 0; j < sets[i]->count; j++ )
+			levels[k++] = sets[i]->levels[j];
+
+	cache = stats_cache_load( cname, &cfg, attempts, seed );
+	start = SDL_GetTicks();
+	analyzed = levels_analyze( levels, total, cache, threads, stats, 0 );
+	if ( cname )
+		stats_cache_save( cache, cname );
+
+	for ( i = 0, k = 0; i < set_count; i++ ) {
+		printf( "%s (%d levels)\n", sets[i]->name, sets[i]->count );
+		for ( j = 0; j < sets[i]->count; j++, k++ ) {
+			s = &stats[k];
+			printf( "%3d %-24s %3d%%", j + 1, levels[k]->name,
+					100 * s->cleared / s->attempts );
+			print_time( s->clear_time );
+			printf( " %5.1f %3d/%-3d %3d/%-3d %3d%%",
+					s->balls_lost, s->walled, s->energy,
+					s->bricks, s->warp_limit,
+					100 * s->warp_reached / s->attempts );
+			print_time( s->warp_time );
+			printf( " %s\n", get_note( s ) );
+			if ( s->walled >= s->warp_limit && s->walled > 0 )
+				stuck++;
+		}
+	}
+	printf( "%d levels, %d simulated, %d stuck, %.1fs\n"
+			"columns: clear rate, median clear time, lost balls, "
+			"unreachable/energy only bricks, bricks/warp limit, "
+			"warp rate, median warp time, notes\n",
+			total, analyzed, stuck, ( SDL_GetTicks() - start ) / 1000.0 );
+
+	stats_cache_delete( &cache );
+	for ( i = 0; i < set_count; i++ )
+		levelset_delete( &sets[i] );
+	free( sets );
+	free( levels );
+	free( stats );
+	list_delete( names );
+	return 0;
+}
@@ -15,6 +15,7 @@
  *                                                                         *
  ***************************************************************************/
 
+#include <SDL2/SDL.h>
 #include "gamedefs.h"
 #include "mathfuncs.h"
 
@@ -211,16 +212,41 @@ int circle_intersect( Vector m, int r, Vector pos, Vector v, Vector *t1, Vector
 
 /* convert vector to angle/2 0-180 and vice versa */
 static Vector impact_vectors[180]; /* clockwise impact vectors in 2 degree steps */
+static SDL_atomic_t impact_vectors_state; /* 0 = empty, 1 = filling, 2 = done */
 
 void init_angles( void )
 {
 	int i;
 	
+	/* table is shared by all games which may be created on worker
+	 * threads so the first caller fills it and the others wait */
+	if ( SDL_AtomicGet( &impact_vectors_state ) == 2 )
+		return;
+	if ( !SDL_AtomicCAS( &impact_vectors_state, 0, 1 ) ) {
+		while ( SDL_AtomicGet( &impact_vectors_state ) != 2 )
+			SDL_Delay( 1 );
+		return;
+	}
 	/* create vectors for all degrees in 2� steps */
 	for ( i = 0; i < 180; i++ ) {
 		impact_vectors[i].x = cos( 6.28 * i / 180 );
 		impact_vectors[i].y = sin( 6.28 * i / 180 );
 	}
+	SDL_AtomicSet( &impact_vectors_state, 2 );
+}
+
+/*
+====================================================================
+Pseudo random numbers (0 to 2^31-1) from state. GAME_RAND() uses
+the state of the current game context so that games are
+reproducible by seed and do not interfere with each other.
+====================================================================
+*/
+int rand_next( unsigned long long *state )
+{
+	/* 64 bit LCG (Knuth MMIX), upper bits have the best quality */
+	*state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+	return (int)(*state >> 33);
 }
 
 int vec2angle( Vector *vec )
@@ -259,4 +285,141 @@ void angle2vec( int angle, Vector *vec )
 	*vec = impact_vectors[angle];
 }
 
+/*
+====================================================================
+Integer versions for fixed point physics which give the same result
+on any machine as they use neither libm nor floats. The tables are
+impact_vectors in 1/65536 and the tangents where vec2angle() steps
+to the next degree.
+====================================================================
+*/
+static const int impact_fvectors[2][180] = { {
+	65536, 65496, 65377, 65177, 64899, 64541, 64105, 63591,
+	63000, 62332, 61588, 60769, 59876, 58910, 57872, 56765,
+	55588, 54343, 53032, 51657, 50218, 48719, 47160, 45544,
+	43873, 42148, 40372, 38546, 36674, 34757, 32798, 30799,
+	28762, 26691, 24587, 22453, 20291, 18105, 15897, 13670,
+	11426, 9168, 6899, 4621, 2338, 52, -2234, -4517,
+	-6795, -9065, -11323, -13568, -15796, -18005, -20192, -22355,
+	-24490, -26595, -28669, -30707, -32708, -34669, -36588, -38462,
+	-40289, -42068, -43795, -45469, -47088, -48649, -50151, -51592,
+	-52971, -54284, -55532, -56712, -57823, -58864, -59833, -60730,
+	-61552, -62299, -62971, -63566, -64084, -64523, -64884, -65166,
+	-65369, -65492, -65536, -65500, -65384, -65188, -64913, -64559,
+	-64127, -63616, -63028, -62364, -61623, -60808, -59918, -58956,
+	-57921, -56817, -55643, -54401, -53093, -51721, -50285, -48789,
+	-47233, -45619, -43950, -42228, -40454, -38631, -36761, -34846,
+	-32888, -30891, -28856, -26786, -24683, -22551, -20391, -18206,
+	-15999, -13772, -11529, -9271, -7003, -4725, -2442, -157,
+	2130, 4413, 6691, 8961, 11220, 13466, 15695, 17905,
+	20093, 22257, 24393, 26500, 28575, 30615, 32617, 34580,
+	36501, 38377, 40207, 41988, 43718, 45394, 47015, 48579,
+	50084, 51528, 52909, 54226, 55477, 56660, 57774, 58818,
+	59791, 60690, 61516, 62267, 62942, 63540, 64062, 64505,
+	64869, 65155, 65362, 65489 }, {
+	0, 2286, 4569, 6847, 9116, 11374, 13619, 15847,
+	18055, 20242, 22404, 24538, 26643, 28716, 30753, 32753,
+	34713, 36631, 38504, 40331, 42108, 43834, 45507, 47124,
+	48684, 50185, 51625, 53001, 54314, 55560, 56738, 57848,
+	58887, 59855, 60749, 61570, 62316, 62985, 63579, 64094,
+	64532, 64892, 65172, 65373, 65494, 65536, 65498, 65380,
+	65183, 64906, 64550, 64116, 63604, 63014, 62348, 61605,
+	60788, 59897, 58933, 57897, 56791, 55615, 54372, 53063,
+	51689, 50252, 48754, 47197, 45582, 43912, 42188, 40413,
+	38589, 36717, 34802, 32843, 30845, 28809, 26739, 24635,
+	22502, 20341, 18156, 15948, 13721, 11477, 9220, 6951,
+	4673, 2390, 104, -2182, -4465, -6743, -9013, -11272,
+	-13517, -15745, -17955, -20143, -22306, -24442, -26548, -28622,
+	-30661, -32662, -34624, -36544, -38420, -40248, -42028, -43756,
+	-45432, -47052, -48614, -50118, -51560, -52940, -54255, -55504,
+	-56686, -57799, -58841, -59812, -60710, -61534, -62283, -62956,
+	-63553, -64073, -64514, -64877, -65161, -65365, -65490, -65536,
+	-65501, -65387, -65194, -64920, -64568, -64138, -63629, -63043,
+	-62380, -61641, -60827, -59939, -58978, -57946, -56843, -55670,
+	-54430, -53124, -51753, -50319, -48824, -47269, -45657, -43989,
+	-42268, -40495, -38673, -36804, -34890, -32934, -30937, -28903,
+	-26834, -24732, -22600, -20440, -18256, -16049, -13823, -11580,
+	-9323, -7054, -4777, -2495 } };
+static const int degree_tangents[90] = {
+	1143, 2287, 3433, 4580, 5731, 6885,
+	8043, 9206, 10375, 11550, 12732, 13923,
+	15122, 16331, 17551, 18782, 20026, 21282,
+	22554, 23840, 25143, 26463, 27803, 29162,
+	30542, 31945, 33373, 34825, 36305, 37814,
+	39354, 40926, 42532, 44176, 45859, 47583,
+	49351, 51167, 53033, 54952, 56928, 58965,
+	61067, 63238, 65484, 67809, 70220, 72723,
+	75325, 78033, 80856, 83803, 86884, 90112,
+	93498, 97057, 100805, 104760, 108941, 113373,
+	118080, 123092, 128445, 134176, 140332, 146965,
+	154139, 161927, 170416, 179712, 189943, 201263,
+	213864, 227988, 243936, 262100, 282988, 307280,
+	335900, 370141, 411867, 463871, 530527, 619107,
+	742647, 927070, 1232350, 1835723, 3592432, 82297854 };
+
+void angle2fvec( int angle, int *x, int *y )
+{
+	*x = 0;
+	*y = 0;
+
+	if ( angle < 0 ) return;
+	if ( angle > 179 ) return;
+
+	*x = impact_fvectors[0][angle];
+	*y = impact_fvectors[1][angle];
+}
+
+int fvec2angle( int x, int y )
+{
+	long long ax = abs( x ), ay = abs( y );
+	int degrees = 0;
+
+	/* same quartals as vec2angle() */
+	if ( x == 0 )
+		degrees = 90;
+	else
+		while ( degrees < 90 && ay * 65536 >= degree_tangents[degrees] * ax )
+			degrees++;
+	if ( x > 0 ) {
+		if ( y < 0 )
+			degrees = 360 - degrees;
+	}
+	else {
+		if ( y >= 0 )
+			degrees = 180 - degrees;
+		else
+			degrees = 180 + degrees;
+	}
+
+	return degrees/2;
+}
+
+unsigned int isqrt( unsigned long long v )
+{
+	unsigned long long r = 0, bit = 1ULL << 62;
+
+	while ( bit > v )
+		bit >>= 2;
+	while ( bit ) {
+		if ( v >= r + bit ) {
+			v -= r + bit;
+			r = ( r >> 1 ) + bit;
+		}
+		else
+			r >>= 1;
+		bit >>= 2;
+	}
+	return (unsigned int)r;
+}
+
+void fvec_set_length( int *x, int *y, int length )
+{
+	long long len = isqrt( (long long)*x * *x + (long long)*y * *y );
+
+	if ( len == 0 )
+		return;
+	*x = (int)( (long long)*x * length / len );
+	*y = (int)( (long long)*y * length / len );
+}
+
     
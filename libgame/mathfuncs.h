@@ -109,4 +109,28 @@ void init_angles( void );
 int  vec2angle( Vector *vec );
 void angle2vec( int angle, Vector *vec );
 
+/*
+====================================================================
+Integer versions for fixed point physics: angle2fvec() returns a
+vector of length 65536, fvec2angle() accepts vectors of any length
+and fvec_set_length() keeps the unit of the vector. isqrt() returns
+the square root rounded down.
+====================================================================
+*/
+void angle2fvec( int angle, int *x, int *y );
+int  fvec2angle( int x, int y );
+unsigned int isqrt( unsigned long long v );
+void fvec_set_length( int *x, int *y, int length );
+
+/*
+====================================================================
+Pseudo random numbers (0 to 2^31-1) from state. GAME_RAND() uses
+the state of the current game context so that games are
+reproducible by seed and do not interfere with each other.
+====================================================================
+*/
+int rand_next( unsigned long long *state );
+#define GAME_RAND() rand_next( &cur_game->rand_state )
+#define GAME_RANDOM( lower, upper ) ( ( GAME_RAND() % ( ( upper ) - ( lower ) + 1 ) ) + ( lower ) )
+
 #endif
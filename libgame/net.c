@@ -0,0 +1,268 @@
+/***************************************************************************
+                          net.c  -  description
+                             -------------------
+    begin                : 2026/10/19
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/***** INCLUDES ************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "gamedefs.h"
+#include "net.h"
+
+/***** LOCAL TYPE DEFINITIONS **********************************************/
+
+/* packet held back by the simulation of a bad connection */
+typedef struct {
+	int		sock;
+	NetAddr		addr;
+	NetBuffer	buf;
+	unsigned int	due; 	/* ms of net_ticks() */
+} NetDelayed;
+
+/***** LOCAL VARIABLES *****************************************************/
+
+static int sim_delay = 0, sim_jitter = 0, sim_loss = 0;
+static List *sim_queue = 0;
+
+/***** LOCAL FUNCTIONS *****************************************************/
+
+static unsigned int net_ticks( void )
+{
+	struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int net_send_now( int sock, NetAddr *addr, NetBuffer *buf )
+{
+	struct sockaddr_in sa;
+
+	memset( &sa, 0, sizeof( sa ) );
+	sa.sin_family = AF_INET;
+	sa.sin_addr.s_addr = addr->host;
+	sa.sin_port = addr->port;
+	return sendto( sock, buf->data, buf->size, 0,
+			(struct sockaddr*)&sa, sizeof( sa ) ) == buf->size;
+}
+
+/* send delayed packets that are due. if 'sock' is not -1 the packets
+ * of this socket are dropped instead as it is closed. */
+static void net_send_delayed( int sock )
+{
+	NetDelayed *packet;
+	unsigned int now = net_ticks();
+
+	if ( sim_queue == 0 )
+		return;
+	list_reset( sim_queue );
+	while ( ( packet = list_next( sim_queue ) ) ) {
+		if ( packet->sock != sock ) {
+			if ( (int)( packet->due - now ) > 0 )
+				continue;
+			net_send_now( packet->sock, &packet->addr, &packet->buf );
+		}
+		list_delete_current( sim_queue );
+	}
+}
+
+/***** PUBLIC FUNCTIONS ****************************************************/
+
+/* open non-blocking UDP socket on 'port' (0 for any free port) and
+ * return it or -1 on error */
+int net_open( int port )
+{
+	struct sockaddr_in sa;
+	int sock;
+
+	if ( ( sock = socket( AF_INET, SOCK_DGRAM, 0 ) ) < 0 ) {
+		perror( "socket" );
+		return -1;
+	}
+	memset( &sa, 0, sizeof( sa ) );
+	sa.sin_family = AF_INET;
+	sa.sin_addr.s_addr = htonl( INADDR_ANY );
+	sa.sin_port = htons( port );
+	if ( bind( sock, (struct sockaddr*)&sa, sizeof( sa ) ) < 0 ) {
+		fprintf( stderr, "couldn't bind to port %d\n", port );
+		close( sock );
+		return -1;
+	}
+	fcntl( sock, F_SETFL, fcntl( sock, F_GETFL, 0 ) | O_NONBLOCK );
+	return sock;
+}
+void net_close( int sock )
+{
+	if ( sock < 0 )
+		return;
+	net_send_delayed( sock );
+	close( sock );
+}
+
+/* simulate a bad connection for testing: net_send() drops packets with
+ * 'loss' percent and delays the others by 'delay' plus up to 'jitter'
+ * ms (which reorders them). held back packets are sent by later calls
+ * of net_send() and net_recv(). all zero sends right away again. not
+ * thread safe. */
+void net_simulate( int delay, int jitter, int loss )
+{
+	sim_delay = MAXIMUM( delay, 0 );
+	sim_jitter = MAXIMUM( jitter, 0 );
+	sim_loss = MAXIMUM( loss, 0 );
+	if ( sim_queue == 0 )
+		sim_queue = list_create( LIST_AUTO_DELETE, LIST_NO_CALLBACK );
+}
+
+/* resolve 'host' (name or dotted address). return 0 on failure. */
+int net_addr_set( NetAddr *addr, const char *host, int port )
+{
+	struct addrinfo hints, *res;
+
+	memset( &hints, 0, sizeof( hints ) );
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+	if ( getaddrinfo( host, 0, &hints, &res ) != 0 ) {
+		fprintf( stderr, "couldn't resolve %s\n", host );
+		return 0;
+	}
+	addr->host = ((struct sockaddr_in*)res->ai_addr)->sin_addr.s_addr;
+	addr->port = htons( port );
+	freeaddrinfo( res );
+	return 1;
+}
+int net_addr_equal( NetAddr *a, NetAddr *b )
+{
+	return a->host == b->host && a->port == b->port;
+}
+/* "a.b.c.d:port" in a static buffer of the calling thread */
+const char *net_addr_str( NetAddr *addr )
+{
+	static GAME_TLS char str[32];
+	unsigned int h = ntohl( addr->host );
+
+	snprintf( str, sizeof( str ), "%u.%u.%u.%u:%d", h >> 24, ( h >> 16 ) & 255,
+			( h >> 8 ) & 255, h & 255, ntohs( addr->port ) );
+	return str;
+}
+
+/* send buffer to 'addr'. return 0 on failure. */
+int net_send( int sock, NetAddr *addr, NetBuffer *buf )
+{
+	NetDelayed *packet;
+
+	if ( buf->error )
+		return 0;
+	net_send_delayed( -1 );
+	if ( sim_loss > 0 && rand() % 100 < sim_loss )
+		return 1; /* lost on the way */
+	if ( sim_delay + sim_jitter == 0 )
+		return net_send_now( sock, addr, buf );
+	packet = salloc( 1, sizeof( NetDelayed ) );
+	packet->sock = sock;
+	packet->addr = *addr;
+	packet->buf = *buf;
+	packet->due = net_ticks() + sim_delay + ( sim_jitter ? rand() % ( sim_jitter + 1 ) : 0 );
+	list_add( sim_queue, packet );
+	return 1;
+}
+/* receive next packet into buffer and set sender 'addr'. return 0 if
+ * there is no packet. */
+int net_recv( int sock, NetAddr *addr, NetBuffer *buf )
+{
+	struct sockaddr_in sa;
+	socklen_t len = sizeof( sa );
+	int size;
+
+	net_send_delayed( -1 );
+	net_buffer_clear( buf );
+	size = recvfrom( sock, buf->data, NET_PACKET_SIZE, 0, (struct sockaddr*)&sa, &len );
+	if ( size <= 0 )
+		return 0;
+	buf->size = size;
+	addr->host = sa.sin_addr.s_addr;
+	addr->port = sa.sin_port;
+	return 1;
+}
+
+void net_buffer_clear( NetBuffer *buf )
+{
+	buf->size = buf->pos = buf->error = 0;
+}
+void net_write_int8( NetBuffer *buf, int value )
+{
+	if ( buf->size + 1 > NET_PACKET_SIZE ) {
+		buf->error = 1;
+		return;
+	}
+	buf->data[buf->size++] = value & 255;
+}
+void net_write_int16( NetBuffer *buf, int value )
+{
+	net_write_int8( buf, value );
+	net_write_int8( buf, value >> 8 );
+}
+void net_write_int32( NetBuffer *buf, int value )
+{
+	net_write_int16( buf, value );
+	net_write_int16( buf, value >> 16 );
+}
+void net_write_data( NetBuffer *buf, const void *data, int size )
+{
+	if ( buf->size + size > NET_PACKET_SIZE ) {
+		buf->error = 1;
+		return;
+	}
+	memcpy( buf->data + buf->size, data, size );
+	buf->size += size;
+}
+int net_read_uint8( NetBuffer *buf )
+{
+	if ( buf->pos + 1 > buf->size ) {
+		buf->error = 1;
+		return 0;
+	}
+	return buf->data[buf->pos++];
+}
+int net_read_int8( NetBuffer *buf )
+{
+	return (signed char)net_read_uint8( buf );
+}
+int net_read_int16( NetBuffer *buf )
+{
+	int value = net_read_uint8( buf );
+
+	return (short)( value | ( net_read_uint8( buf ) << 8 ) );
+}
+int net_read_int32( NetBuffer *buf )
+{
+	unsigned int value = (unsigned short)net_read_int16( buf );
+
+	return (int)( value | ( (unsigned int)(unsigned short)net_read_int16( buf ) << 16 ) );
+}
+void net_read_data( NetBuffer *buf, void *data, int size )
+{
+	if ( buf->pos + size > buf->size ) {
+		buf->error = 1;
+		memset( data, 0, size );
+		return;
+	}
+	memcpy( data, buf->data + buf->pos, size );
+	buf->pos += size;
+}
@@ -0,0 +1,80 @@
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef __NET_H
+#define __NET_H
+
+/***** TYPE DEFINITIONS ****************************************************/
+
+enum {
+	NET_DEFAULT_PORT = 8000,
+	NET_PACKET_SIZE = 1400, 	/* fits into one ethernet frame */
+	NET_UDP_OVERHEAD = 28 		/* IPv4 and UDP header */
+};
+
+/* IPv4 address and port in network byte order */
+typedef struct {
+	unsigned int	host;
+	unsigned short	port;
+} NetAddr;
+
+/* packet data that is written or read in little endian. reading beyond
+ * size or writing beyond NET_PACKET_SIZE sets error and returns 0. */
+typedef struct {
+	unsigned char	data[NET_PACKET_SIZE];
+	int		size; 	/* bytes written or received */
+	int		pos; 	/* read position */
+	int		error;
+} NetBuffer;
+
+/***** PUBLIC FUNCTIONS ****************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* open non-blocking UDP socket on 'port' (0 for any free port) and
+ * return it or -1 on error */
+int net_open( int port );
+void net_close( int sock );
+
+/* simulate a bad connection for testing: net_send() drops packets with
+ * 'loss' percent and delays the others by 'delay' plus up to 'jitter'
+ * ms (which reorders them). all zero sends right away again. not
+ * thread safe. */
+void net_simulate( int delay, int jitter, int loss );
+
+/* resolve 'host' (name or dotted address). return 0 on failure. */
+int net_addr_set( NetAddr *addr, const char *host, int port );
+int net_addr_equal( NetAddr *a, NetAddr *b );
+/* "a.b.c.d:port" in a static buffer of the calling thread */
+const char *net_addr_str( NetAddr *addr );
+
+/* send buffer to 'addr'. return 0 on failure. */
+int net_send( int sock, NetAddr *addr, NetBuffer *buf );
+/* receive next packet into buffer and set sender 'addr'. return 0 if
+ * there is no packet. */
+int net_recv( int sock, NetAddr *addr, NetBuffer *buf );
+
+void net_buffer_clear( NetBuffer *buf );
+void net_write_int8( NetBuffer *buf, int value );
+void net_write_int16( NetBuffer *buf, int value );
+void net_write_int32( NetBuffer *buf, int value );
+void net_write_data( NetBuffer *buf, const void *data, int size );
+int net_read_int8( NetBuffer *buf );
+int net_read_uint8( NetBuffer *buf );
+int net_read_int16( NetBuffer *buf );
+int net_read_int32( NetBuffer *buf );
+void net_read_data( NetBuffer *buf, void *data, int size );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,1335 @@
+/***************************************************************************
+                          netgame.c  -  description
+                             -------------------
+    begin                : 2026/10/19
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/***** INCLUDES ************************************************************/
+
+#include "netgame.h"
+
+/***** EXTERNAL VARIABLES **************************************************/
+
+extern GAME_TLS Game *cur_game;
+
+/***** DEFINITIONS *********************************************************/
+
+enum {
+	NET_PROTOCOL = 1,
+
+	/* messages, first byte of a packet */
+	MSG_JOIN = 1, 	/* client: protocol */
+	MSG_LEVEL, 	/* server: paddle id, settings, level */
+	MSG_INPUT, 	/* client: seq, acked events, x, buttons */
+	MSG_STATE, 	/* server: see net_server_write_state() */
+	MSG_LEAVE, 	/* both: connection closed */
+	MSG_PEER_JOIN, 	/* joining peer: protocol */
+	MSG_PEER_LEVEL, /* host: paddle id, settings, level, seed */
+	MSG_PEER_INPUT, /* both: see net_peer_send_input() */
+
+	NET_EVENT_HIT = 0,
+	NET_EVENT_EXTRA,
+	NET_EVENT_SIZE = 13, 	/* max bytes of an event */
+
+	/* limits per state to stay within one packet */
+	NET_MAX_BALLS = 64,
+	NET_MAX_SHOTS = 32,
+	NET_MAX_EXTRAS = 32,
+
+	NET_POS_SCALE = 16, 	/* ball position is sent in 1/16 pixel */
+	NET_VEL_SCALE = 16384, 	/* ball velocity in 1/16384 pixel/ms */
+
+	NET_FRICTION_TIME = 200, /* ms until paddle velocity is dropped */
+
+	NET_PEER_MAX_TIME = 4 * NET_PEER_FRAME, /* ms caught up after waiting */
+	NET_PEER_SYNC = 10, 	/* min frames between waits for frame advantage */
+	NET_PEER_CHECK = 10 	/* frames between hashes compared by peers */
+};
+
+/* Ball::flags in state */
+enum {
+	NET_BALL_ATTACHED = 1,
+	NET_BALL_MOVING_BACK = 2,
+	NET_BALL_PADDLE = 4, 	/* has a paddle ... */
+	NET_BALL_TOP = 8 	/* ... which is the top one */
+};
+
+/* Paddle::flags in state */
+enum {
+	NET_PADDLE_FROZEN = 1,
+	NET_PADDLE_SLIME = 2,
+	NET_PADDLE_INVIS = 4,
+	NET_PADDLE_WEAPON = 8,
+	NET_PADDLE_ATTRACT_BONUS = 16,
+	NET_PADDLE_ATTRACT_MALUS = 32
+};
+
+/***** LOCAL FUNCTIONS *****************************************************/
+
+/* send and count traffic */
+static int net_send_counted( int sock, NetAddr *addr, NetBuffer *buf, NetStats *stats )
+{
+	if ( !net_send( sock, addr, buf ) )
+		return 0;
+	stats->bytes_sent += buf->size;
+	stats->packets_sent++;
+	return 1;
+}
+static void net_send_msg( int sock, NetAddr *addr, int msg, NetStats *stats )
+{
+	NetBuffer buf;
+
+	net_buffer_clear( &buf );
+	net_write_int8( &buf, msg );
+	net_send_counted( sock, addr, &buf, stats );
+}
+
+static void net_write_settings( NetBuffer *buf, NetSettings *s )
+{
+	net_write_int8( buf, s->diff );
+	net_write_int8( buf, s->rel_warp_limit );
+	net_write_int16( buf, s->frag_limit );
+	net_write_int8( buf, s->ball_ammo );
+	net_write_int8( buf, s->convex );
+	net_write_int8( buf, s->random_angle );
+	net_write_int8( buf, s->bcc_type );
+	net_write_int8( buf, s->fixed_physics );
+}
+static void net_read_settings( NetBuffer *buf, NetSettings *s )
+{
+	s->diff = net_read_int8( buf );
+	s->rel_warp_limit = net_read_int8( buf );
+	s->frag_limit = net_read_int16( buf );
+	s->ball_ammo = net_read_int8( buf );
+	s->convex = net_read_int8( buf );
+	s->random_angle = net_read_int8( buf );
+	s->bcc_type = net_read_int8( buf );
+	s->fixed_physics = net_read_int8( buf );
+}
+
+static void net_write_level( NetBuffer *buf, Level *level )
+{
+	net_write_data( buf, level->author, sizeof( level->author ) );
+	net_write_data( buf, level->name, sizeof( level->name ) );
+	net_write_data( buf, level->bricks, sizeof( level->bricks ) );
+	net_write_data( buf, level->extras, sizeof( level->extras ) );
+	net_write_int8( buf, level->type );
+}
+static void net_read_level( NetBuffer *buf, Level *level )
+{
+	memset( level, 0, sizeof( Level ) );
+	net_read_data( buf, level->author, sizeof( level->author ) );
+	net_read_data( buf, level->name, sizeof( level->name ) );
+	net_read_data( buf, level->bricks, sizeof( level->bricks ) );
+	net_read_data( buf, level->extras, sizeof( level->extras ) );
+	level->type = net_read_int8( buf );
+	level->author[sizeof( level->author ) - 1] = 0;
+	level->name[sizeof( level->name ) - 1] = 0;
+	level_update_hash( level );
+	level_count_bricks( level );
+}
+
+/* create game for 'level' and apply settings. as game_init() works on
+ * the current game this becomes current. 'seed' 0 keeps the random
+ * one. */
+static Game *net_game_create( Level *level, NetSettings *s, int server, unsigned int seed )
+{
+	Game *game;
+	Level copy = *level;
+
+	if ( ( game = game_create( GT_NETWORK, s->diff, s->rel_warp_limit ) ) == 0 )
+		return 0;
+	game->localServerGame = server;
+	if ( seed )
+		game_set_seed( game, seed );
+	game_set_current( game );
+	game_init( game, &copy );
+	game_set_ball_ammo( s->ball_ammo );
+	game_set_frag_limit( s->frag_limit );
+	game_set_convex_paddle( s->convex );
+	game_set_ball_auto_return( 1 );
+	game_set_ball_random_angle( s->random_angle );
+	game_set_bcc_type( s->bcc_type );
+	game_set_fixed_physics( s->fixed_physics );
+	return game;
+}
+static void net_game_delete( Game **game )
+{
+	Game *old = cur_game;
+
+	if ( *game == 0 )
+		return;
+	game_set_current( *game );
+	game_finalize( *game );
+	game_delete( game );
+	game_set_current( old == *game ? 0 : old );
+}
+
+/* the extras that are active are sent as bitmask and time */
+static void net_write_extras( NetBuffer *buf, int *active, int *time )
+{
+	int i, mask = 0;
+
+	for ( i = 0; i < EX_NUMBER; i++ )
+		if ( active[i] )
+			mask |= 1 << i;
+	net_write_int32( buf, mask );
+	for ( i = 0; i < EX_NUMBER; i++ )
+		if ( active[i] )
+			net_write_int32( buf, time[i] );
+}
+static void net_read_extras( NetBuffer *buf, int *active, int *time )
+{
+	int i, mask = net_read_int32( buf );
+
+	for ( i = 0; i < EX_NUMBER; i++ ) {
+		active[i] = ( mask >> i ) & 1;
+		time[i] = active[i] ? net_read_int32( buf ) : 0;
+	}
+}
+
+static void net_write_paddle( NetBuffer *buf, Paddle *paddle )
+{
+	int flags = 0;
+
+	if ( paddle->frozen ) flags |= NET_PADDLE_FROZEN;
+	if ( paddle->slime ) flags |= NET_PADDLE_SLIME;
+	if ( paddle->invis ) flags |= NET_PADDLE_INVIS;
+	if ( paddle->weapon_inst ) flags |= NET_PADDLE_WEAPON;
+	if ( paddle->attract == ATTRACT_BONUS ) flags |= NET_PADDLE_ATTRACT_BONUS;
+	if ( paddle->attract == ATTRACT_MALUS ) flags |= NET_PADDLE_ATTRACT_MALUS;
+	net_write_int16( buf, paddle->x );
+	net_write_int16( buf, paddle->w );
+	net_write_int16( buf, paddle->score );
+	net_write_int8( buf, flags );
+	net_write_int16( buf, paddle->invis_delay );
+	net_write_int8( buf, paddle->ball_ammo );
+	net_write_int8( buf, paddle->attached_ball_count );
+	net_write_int16( buf, paddle->weapon_ammo );
+	net_write_int16( buf, paddle->wall_y );
+	net_write_int8( buf, (int)paddle->wall_alpha );
+	net_write_extras( buf, paddle->extra_active, paddle->extra_time );
+}
+/* position is only taken if 'move' is set as the own paddle is moved
+ * by local input */
+static void net_read_paddle( NetBuffer *buf, Paddle *paddle, int move )
+{
+	int x, flags;
+
+	x = net_read_int16( buf );
+	paddle->w = paddle->wanted_w = net_read_int16( buf );
+	paddle->score = net_read_int16( buf );
+	flags = net_read_uint8( buf );
+	paddle->frozen = ( flags & NET_PADDLE_FROZEN ) != 0;
+	paddle->slime = ( flags & NET_PADDLE_SLIME ) != 0;
+	paddle->invis = ( flags & NET_PADDLE_INVIS ) != 0;
+	paddle->weapon_inst = ( flags & NET_PADDLE_WEAPON ) != 0;
+	paddle->attract = ATTRACT_NONE;
+	if ( flags & NET_PADDLE_ATTRACT_BONUS ) paddle->attract = ATTRACT_BONUS;
+	if ( flags & NET_PADDLE_ATTRACT_MALUS ) paddle->attract = ATTRACT_MALUS;
+	paddle->invis_delay = net_read_int16( buf );
+	paddle->ball_ammo = net_read_int8( buf );
+	paddle->attached_ball_count = net_read_int8( buf );
+	paddle->weapon_ammo = net_read_int16( buf );
+	paddle->wall_y = net_read_int16( buf );
+	paddle->wall_alpha = net_read_uint8( buf );
+	net_read_extras( buf, paddle->extra_active, paddle->extra_time );
+	if ( move || paddle->frozen ) {
+		paddle->x = x;
+		paddle->cur_x = x;
+	}
+}
+
+static void net_write_event( NetBuffer *buf, Game *game, NetEvent *event )
+{
+	BrickHit *hit = &event->hit;
+	Brick *brick;
+
+	net_write_int8( buf, event->type );
+	if ( event->type == NET_EVENT_EXTRA ) {
+		net_write_int8( buf, event->paddle );
+		net_write_int8( buf, event->extra );
+		return;
+	}
+	/* the brick as it is now so that applying old hits again
+	 * or missing hits in between does no harm */
+	brick = &game->bricks[hit->x][hit->y];
+	net_write_int8( buf, hit->x );
+	net_write_int8( buf, hit->y );
+	net_write_int8( buf, hit->type );
+	net_write_int8( buf, hit->dest_type );
+	net_write_int8( buf, hit->brick_id );
+	net_write_int8( buf, hit->paddle );
+	net_write_int8( buf, hit->gold_shower | ( hit->draw_explosion << 1 ) |
+			( hit->no_sound << 2 ) );
+	net_write_int16( buf, hit->degrees );
+	net_write_int8( buf, brick->type );
+	net_write_int8( buf, brick->id );
+	net_write_int8( buf, brick->dur );
+}
+/* apply event to brick map and if 'add_mod' is set add it to the
+ * modifications */
+static void net_read_event( NetBuffer *buf, Game *game, int add_mod )
+{
+	GameMod *mod = &game->mod;
+	BrickHit hit;
+	Brick *brick;
+	int type, paddle, extra, flags;
+
+	type = net_read_int8( buf );
+	if ( type == NET_EVENT_EXTRA ) {
+		paddle = net_read_int8( buf ) & 1;
+		extra = net_read_int8( buf );
+		if ( add_mod && mod->collected_extra_count[paddle] < MAX_MODS )
+			mod->collected_extras[paddle][mod->collected_extra_count[paddle]++] = extra;
+		return;
+	}
+	memset( &hit, 0, sizeof( hit ) );
+	hit.x = net_read_int8( buf );
+	hit.y = net_read_int8( buf );
+	hit.type = net_read_int8( buf );
+	hit.dest_type = net_read_int8( buf );
+	hit.brick_id = net_read_int8( buf );
+	hit.paddle = net_read_int8( buf );
+	flags = net_read_int8( buf );
+	hit.gold_shower = flags & 1;
+	hit.draw_explosion = ( flags >> 1 ) & 1;
+	hit.no_sound = ( flags >> 2 ) & 1;
+	hit.degrees = net_read_int16( buf );
+	if ( buf->error || hit.x < 0 || hit.x >= MAP_WIDTH || hit.y < 0 || hit.y >= MAP_HEIGHT ) {
+		buf->error = 1;
+		return;
+	}
+	brick = &game->bricks[hit.x][hit.y];
+	brick->type = net_read_int8( buf );
+	brick->id = net_read_int8( buf );
+	brick->dur = net_read_int8( buf );
+	if ( add_mod && mod->brick_hit_count < MAX_MODS )
+		mod->brick_hits[mod->brick_hit_count++] = hit;
+}
+
+static void net_settings_check( NetSettings *s )
+{
+	if ( s->diff < 0 || s->diff >= NET_DIFF_COUNT )
+		s->diff = 0;
+}
+
+/* set paddle 'id' of current game by input like the local client does:
+ * the velocity for friction is taken from the movement. 'still' counts
+ * the ms the paddle did not move. */
+static void net_apply_input( Game *game, int id, int x, int buttons, int *still, int ms )
+{
+	Paddle *paddle = game->paddles[id];
+
+	if ( paddle->frozen )
+		x = 0;
+	if ( !game->paddle_is_convex ) {
+		if ( x != 0 && x != paddle->x && ms > 0 ) {
+			paddle->v_x = ( x - paddle->cur_x ) / ms;
+			if ( paddle->v_x > 5.0 ) paddle->v_x = 5.0;
+			if ( paddle->v_x < -5.0 ) paddle->v_x = -5.0;
+			*still = 0;
+		} else if ( ( *still += ms ) >= NET_FRICTION_TIME )
+			paddle->v_x = 0;
+	}
+	game_set_paddle_state( id, x, 0, ( buttons & NET_FIRE_LEFT ) != 0,
+			( buttons & NET_FIRE_RIGHT ) != 0, ( buttons & NET_RETURN ) != 0 );
+}
+
+/***** PUBLIC FUNCTIONS ****************************************************/
+
+void net_settings_default( NetSettings *settings )
+{
+	memset( settings, 0, sizeof( NetSettings ) );
+	settings->diff = 1;
+	settings->rel_warp_limit = 100;
+	settings->frag_limit = 10;
+	settings->ball_ammo = 3;
+	settings->convex = 1;
+}
+
+/* average latency from sending input to receiving the state it was
+ * applied to, -1 if none yet */
+int net_stats_latency( NetStats *stats )
+{
+	if ( stats->latency_count == 0 )
+		return -1;
+	return stats->latency_sum / stats->latency_count;
+}
+
+/*
+====================================================================
+Server
+====================================================================
+*/
+
+/* open server on 'port' for 'level' which is started when both
+ * players joined. */
+NetServer *net_server_create( int port, Level *level, NetSettings *settings )
+{
+	NetServer *server;
+	Game *old = cur_game;
+
+	if ( level->type != LT_NORMAL ) {
+		fprintf( stderr, "bonus levels can't be played in network games\n" );
+		return 0;
+	}
+	server = salloc( 1, sizeof( NetServer ) );
+	server->level = *level;
+	server->settings = *settings;
+	server->verbose = 1;
+	net_settings_check( &server->settings );
+	if ( ( server->sock = net_open( port ) ) < 0 ) {
+		free( server );
+		return 0;
+	}
+	server->game = net_game_create( &server->level, &server->settings, 1, 0 );
+	game_set_current( old );
+	if ( server->game == 0 ) {
+		net_server_delete( &server );
+		return 0;
+	}
+	return server;
+}
+void net_server_delete( NetServer **_server )
+{
+	NetServer *server = *_server;
+	int i;
+
+	if ( server == 0 )
+		return;
+	for ( i = 0; i < 2; i++ )
+		if ( server->clients[i].joined )
+			net_send_msg( server->sock, &server->clients[i].addr,
+					MSG_LEAVE, &server->clients[i].stats );
+	net_close( server->sock );
+	net_game_delete( &server->game );
+	free( server->events );
+	free( server );
+	*_server = 0;
+}
+
+/* start level again for new players. joined players are sent away. */
+void net_server_restart( NetServer *server )
+{
+	Game *old = cur_game;
+	int i;
+
+	for ( i = 0; i < 2; i++ )
+		if ( server->clients[i].joined )
+			net_send_msg( server->sock, &server->clients[i].addr,
+					MSG_LEAVE, &server->clients[i].stats );
+	memset( server->clients, 0, sizeof( server->clients ) );
+	server->client_count = 0;
+	server->tick = 0;
+	server->event_count = 0;
+	net_game_delete( &server->game );
+	server->game = net_game_create( &server->level, &server->settings, 1, 0 );
+	game_set_current( old );
+}
+
+/* client slot of 'addr' or -1 */
+static int net_server_find_client( NetServer *server, NetAddr *addr )
+{
+	int i;
+
+	for ( i = 0; i < 2; i++ )
+		if ( server->clients[i].joined && net_addr_equal( &server->clients[i].addr, addr ) )
+			return i;
+	return -1;
+}
+
+/* add client to a free slot and send level. a client that is already
+ * joined gets the level again as the first one was lost. */
+static void net_server_handle_join( NetServer *server, NetAddr *addr, NetBuffer *in )
+{
+	NetServerClient *client;
+	NetBuffer buf;
+	int id;
+
+	if ( net_read_int8( in ) != NET_PROTOCOL ) {
+		fprintf( stderr, "%s: wrong protocol\n", net_addr_str( addr ) );
+		return;
+	}
+	if ( ( id = net_server_find_client( server, addr ) ) == -1 ) {
+		for ( id = 0; id < 2; id++ )
+			if ( !server->clients[id].joined )
+				break;
+		if ( id == 2 )
+			return; /* full */
+		client = &server->clients[id];
+		memset( client, 0, sizeof( NetServerClient ) );
+		client->addr = *addr;
+		client->joined = 1;
+		server->client_count++;
+		if ( server->verbose )
+			printf( "%s joined as player %d\n", net_addr_str( addr ), id + 1 );
+	}
+	client = &server->clients[id];
+	client->stats.bytes_recv += in->size;
+	client->stats.packets_recv++;
+	client->idle = 0;
+
+	net_buffer_clear( &buf );
+	net_write_int8( &buf, MSG_LEVEL );
+	net_write_int8( &buf, id );
+	net_write_settings( &buf, &server->settings );
+	net_write_level( &buf, &server->level );
+	net_send_counted( server->sock, addr, &buf, &client->stats );
+}
+
+static void net_server_drop_client( NetServer *server, int id, const char *reason )
+{
+	if ( server->verbose )
+		printf( "%s %s\n", net_addr_str( &server->clients[id].addr ), reason );
+	server->clients[id].joined = 0;
+	server->client_count--;
+}
+
+static void net_server_receive( NetServer *server )
+{
+	NetServerClient *client;
+	NetBuffer buf;
+	NetAddr addr;
+	int id, msg, seq;
+
+	while ( net_recv( server->sock, &addr, &buf ) ) {
+		msg = net_read_int8( &buf );
+		if ( msg == MSG_JOIN ) {
+			net_server_handle_join( server, &addr, &buf );
+			continue;
+		}
+		if ( ( id = net_server_find_client( server, &addr ) ) == -1 )
+			continue;
+		client = &server->clients[id];
+		client->stats.bytes_recv += buf.size;
+		client->stats.packets_recv++;
+		client->idle = 0;
+		if ( msg == MSG_LEAVE ) {
+			net_server_drop_client( server, id, "left" );
+			continue;
+		}
+		if ( msg != MSG_INPUT )
+			continue;
+		seq = net_read_int32( &buf );
+		if ( seq <= client->input_seq )
+			continue; /* old input arrived late */
+		client->input_seq = seq;
+		id = net_read_int32( &buf );
+		if ( id > client->acked_events && id <= server->event_count )
+			client->acked_events = id;
+		client->x = net_read_int16( &buf );
+		client->buttons = net_read_uint8( &buf );
+	}
+}
+
+/* set paddles of current game by last inputs */
+static void net_server_apply_input( NetServer *server, int ms )
+{
+	NetServerClient *client;
+	int i;
+
+	for ( i = 0; i < 2; i++ ) {
+		client = &server->clients[i];
+		net_apply_input( server->game, i, client->x, client->buttons,
+				&client->still, ms );
+	}
+}
+
+static void net_server_add_event( NetServer *server, NetEvent *event )
+{
+	if ( server->event_count == server->event_size ) {
+		server->event_size = server->event_size ? 2 * server->event_size : 256;
+		server->events = realloc( server->events, server->event_size * sizeof( NetEvent ) );
+	}
+	server->events[server->event_count++] = *event;
+}
+
+/* keep the brick hits and collected extras of the last update */
+static void net_server_store_events( NetServer *server )
+{
+	GameMod *mod = &server->game->mod;
+	NetEvent event;
+	int i, j;
+
+	memset( &event, 0, sizeof( event ) );
+	event.type = NET_EVENT_HIT;
+	for ( i = 0; i < mod->brick_hit_count; i++ ) {
+		event.hit = mod->brick_hits[i];
+		net_server_add_event( server, &event );
+	}
+	event.type = NET_EVENT_EXTRA;
+	for ( i = 0; i < 2; i++ )
+		for ( j = 0; j < mod->collected_extra_count[i]; j++ ) {
+			event.paddle = i;
+			event.extra = mod->collected_extras[i][j];
+			net_server_add_event( server, &event );
+		}
+}
+
+/* balls, shots, extras and paddles completely, events as many as fit
+ * starting with the first one the client did not acknowledge. */
+static void net_server_write_state( NetServer *server, NetServerClient *client, NetBuffer *buf )
+{
+	Game *game = server->game;
+	Ball *ball;
+	Shot *shot;
+	Extra *extra;
+	int i, count, flags;
+
+	net_buffer_clear( buf );
+	net_write_int8( buf, MSG_STATE );
+	net_write_int32( buf, server->tick );
+	net_write_int32( buf, client->input_seq );
+
+	net_write_int16( buf, game->bricks_left );
+	net_write_int8( buf, game->level_over );
+	net_write_int8( buf, game->winner );
+	net_write_extras( buf, game->extra_active, game->extra_time );
+	for ( i = 0; i < 2; i++ )
+		net_write_paddle( buf, game->paddles[i] );
+
+	net_write_int8( buf, game->mod.fired_shot_count );
+	net_write_int8( buf, game->mod.attached_ball_count );
+	net_write_int8( buf, game->mod.paddle_reflected_ball_count );
+	net_write_int8( buf, game->mod.brick_reflected_ball_count );
+
+	count = MINIMUM( game->balls->count, NET_MAX_BALLS );
+	net_write_int8( buf, count );
+	list_reset( game->balls );
+	for ( i = 0; i < count && ( ball = list_next( game->balls ) ); i++ ) {
+		flags = 0;
+		if ( ball->attached ) flags |= NET_BALL_ATTACHED;
+		if ( ball->moving_back ) flags |= NET_BALL_MOVING_BACK;
+		if ( ball->paddle ) {
+			flags |= NET_BALL_PADDLE;
+			if ( ball->paddle->type == PADDLE_TOP )
+				flags |= NET_BALL_TOP;
+		}
+		net_write_int16( buf, (int)( ball->cur.x * NET_POS_SCALE ) );
+		net_write_int16( buf, (int)( ball->cur.y * NET_POS_SCALE ) );
+		net_write_int16( buf, (int)( ball->vel.x * NET_VEL_SCALE ) );
+		net_write_int16( buf, (int)( ball->vel.y * NET_VEL_SCALE ) );
+		net_write_int8( buf, flags );
+	}
+	count = MINIMUM( game->shots->count, NET_MAX_SHOTS );
+	net_write_int8( buf, count );
+	list_reset( game->shots );
+	for ( i = 0; i < count && ( shot = list_next( game->shots ) ); i++ ) {
+		net_write_int16( buf, (int)shot->x );
+		net_write_int16( buf, (int)shot->y );
+		net_write_int8( buf, ( shot->paddle && shot->paddle->type == PADDLE_TOP ) |
+				( shot->next_too << 1 ) );
+	}
+	count = MINIMUM( game->extras->count, NET_MAX_EXTRAS );
+	net_write_int8( buf, count );
+	list_reset( game->extras );
+	for ( i = 0; i < count && ( extra = list_next( game->extras ) ); i++ ) {
+		net_write_int16( buf, (int)extra->x );
+		net_write_int16( buf, (int)extra->y );
+		net_write_int8( buf, extra->type );
+		net_write_int8( buf, extra->dir );
+		net_write_int8( buf, (int)extra->alpha );
+	}
+
+	/* events: first index, count, events */
+	count = ( NET_PACKET_SIZE - buf->size - 5 ) / NET_EVENT_SIZE;
+	count = MINIMUM( count, 255 );
+	count = MINIMUM( count, server->event_count - client->acked_events );
+	net_write_int32( buf, client->acked_events );
+	net_write_int8( buf, count );
+	for ( i = 0; i < count; i++ )
+		net_write_event( buf, game, &server->events[client->acked_events + i] );
+}
+
+/* handle incoming packets and if both players are there, apply their
+ * input, update game by 'ms' and send the new state to them. return
+ * number of joined players. */
+int net_server_update( NetServer *server, int ms )
+{
+	Game *old = cur_game;
+	NetBuffer buf;
+	int i;
+
+	net_server_receive( server );
+	for ( i = 0; i < 2; i++ )
+		if ( server->clients[i].joined ) {
+			server->clients[i].stats.time += ms;
+			if ( ( server->clients[i].idle += ms ) > NET_TIMEOUT )
+				net_server_drop_client( server, i, "timed out" );
+		}
+	if ( server->client_count < 2 )
+		return server->client_count;
+
+	game_set_current( server->game );
+	if ( !server->game->level_over ) {
+		net_server_apply_input( server, ms );
+		game_reset_mods();
+		game_update( ms );
+		net_server_store_events( server );
+		server->tick++;
+	}
+	for ( i = 0; i < 2; i++ ) {
+		net_server_write_state( server, &server->clients[i], &buf );
+		net_send_counted( server->sock, &server->clients[i].addr,
+				&buf, &server->clients[i].stats );
+	}
+	game_set_current( old );
+	return server->client_count;
+}
+
+/*
+====================================================================
+Client
+====================================================================
+*/
+
+/* connect to server at 'host':'port'. */
+NetClient *net_client_create( const char *host, int port )
+{
+	NetClient *client = salloc( 1, sizeof( NetClient ) );
+
+	client->paddle = -1;
+	client->tick = -1;
+	client->verbose = 1;
+	if ( !net_addr_set( &client->server, host, port ) ||
+			( client->sock = net_open( 0 ) ) < 0 ) {
+		free( client );
+		return 0;
+	}
+	return client;
+}
+void net_client_delete( NetClient **_client )
+{
+	NetClient *client = *_client;
+
+	if ( client == 0 )
+		return;
+	net_send_msg( client->sock, &client->server, MSG_LEAVE, &client->stats );
+	net_close( client->sock );
+	net_game_delete( &client->game );
+	free( client );
+	*_client = 0;
+}
+
+/* create game from level message unless already done */
+static void net_client_handle_level( NetClient *client, NetBuffer *buf )
+{
+	int paddle;
+
+	if ( client->game )
+		return;
+	paddle = net_read_int8( buf );
+	net_read_settings( buf, &client->settings );
+	net_read_level( buf, &client->level );
+	net_settings_check( &client->settings );
+	if ( buf->error || paddle < 0 || paddle > 1 )
+		return;
+	if ( ( client->game = net_game_create( &client->level, &client->settings, 0, 0 ) ) == 0 )
+		return;
+	client->paddle = paddle;
+	if ( client->verbose )
+		printf( "joined %s as player %d\n", net_addr_str( &client->server ), paddle + 1 );
+}
+
+/* replace objects of mirror game by the ones in state */
+static void net_client_handle_state( NetClient *client, NetBuffer *buf )
+{
+	Game *game = client->game;
+	GameMod *mod = &game->mod;
+	Paddle *paddle;
+	Ball *ball;
+	Shot *shot;
+	Extra *extra;
+	int i, j, row, count, flags, first, tick, seq;
+
+	tick = net_read_int32( buf );
+	if ( tick <= client->tick )
+		return; /* late */
+	client->tick = tick;
+	seq = net_read_int32( buf );
+	if ( seq > client->input_echo && seq > client->input_seq - NET_INPUT_HISTORY ) {
+		i = client->stats.time - client->input_time[seq % NET_INPUT_HISTORY];
+		client->stats.latency_sum += i;
+		if ( client->stats.latency_count++ == 0 || i < client->stats.latency_min )
+			client->stats.latency_min = i;
+		if ( i > client->stats.latency_max )
+			client->stats.latency_max = i;
+		client->input_echo = seq;
+	}
+
+	game->bricks_left = net_read_int16( buf );
+	game->level_over = net_read_int8( buf );
+	game->winner = net_read_int8( buf );
+	net_read_extras( buf, game->extra_active, game->extra_time );
+	for ( i = 0; i < 2; i++ ) {
+		paddle = game->paddles[i];
+		net_read_paddle( buf, paddle, i != client->paddle );
+		/* walls are bricks as set by extras.c */
+		row = ( paddle->wall_y == 0 ) ? 0 : MAP_HEIGHT - 1;
+		for ( j = 1; j < MAP_WIDTH - 1; j++ )
+			if ( paddle->extra_active[EX_WALL] ) {
+				game->bricks[j][row].type = MAP_WALL;
+				game->bricks[j][row].id = 0;
+			} else
+				game->bricks[j][row].type = MAP_EMPTY;
+	}
+
+	mod->fired_shot_count += net_read_uint8( buf );
+	mod->attached_ball_count += net_read_uint8( buf );
+	mod->paddle_reflected_ball_count += net_read_uint8( buf );
+	mod->brick_reflected_ball_count += net_read_uint8( buf );
+
+	list_clear( game->balls );
+	count = net_read_uint8( buf );
+	for ( i = 0; i < count && !buf->error; i++ ) {
+		ball = salloc( 1, sizeof( Ball ) );
+		ball->cur.x = (float)net_read_int16( buf ) / NET_POS_SCALE;
+		ball->cur.y = (float)net_read_int16( buf ) / NET_POS_SCALE;
+		ball->vel.x = (float)net_read_int16( buf ) / NET_VEL_SCALE;
+		ball->vel.y = (float)net_read_int16( buf ) / NET_VEL_SCALE;
+		flags = net_read_uint8( buf );
+		ball->x = (int)ball->cur.x;
+		ball->y = (int)ball->cur.y;
+		ball->attached = ( flags & NET_BALL_ATTACHED ) != 0;
+		ball->moving_back = ( flags & NET_BALL_MOVING_BACK ) != 0;
+		if ( flags & NET_BALL_PADDLE )
+			ball->paddle = game->paddles[( flags & NET_BALL_TOP ) ? 1 : 0];
+		list_add( game->balls, ball );
+	}
+	list_clear( game->shots );
+	count = net_read_uint8( buf );
+	for ( i = 0; i < count && !buf->error; i++ ) {
+		shot = salloc( 1, sizeof( Shot ) );
+		shot->x = net_read_int16( buf );
+		shot->y = net_read_int16( buf );
+		flags = net_read_uint8( buf );
+		shot->paddle = game->paddles[flags & 1];
+		shot->dir = ( shot->paddle->type == PADDLE_TOP ) ? 1 : -1;
+		shot->next_too = ( flags >> 1 ) & 1;
+		list_add( game->shots, shot );
+	}
+	list_clear( game->extras );
+	count = net_read_uint8( buf );
+	for ( i = 0; i < count && !buf->error; i++ ) {
+		extra = salloc( 1, sizeof( Extra ) );
+		extra->x = net_read_int16( buf );
+		extra->y = net_read_int16( buf );
+		extra->type = net_read_int8( buf );
+		extra->dir = net_read_int8( buf );
+		extra->alpha = net_read_uint8( buf );
+		extra->offset = extra->type * BRICK_WIDTH;
+		list_add( game->extras, extra );
+	}
+
+	/* skip events that were already applied */
+	first = net_read_int32( buf );
+	count = net_read_uint8( buf );
+	if ( first > client->events )
+		return; /* can't happen as client acknowledged less */
+	for ( i = first; i < first + count && !buf->error; i++ ) {
+		/* the brick state of old events is the current one so
+		 * applying them again only must not repeat the mods */
+		net_read_event( buf, game, i >= client->events );
+		if ( i < client->events )
+			continue;
+		client->events++;
+	}
+}
+
+/* move balls along velocity until next state arrives */
+static void net_client_extrapolate( NetClient *client, int ms )
+{
+	Ball *ball;
+
+	list_reset( client->game->balls );
+	while ( ( ball = list_next( client->game->balls ) ) ) {
+		if ( ball->attached )
+			continue;
+		ball->cur.x += ball->vel.x * ms;
+		ball->cur.y += ball->vel.y * ms;
+		ball->x = (int)ball->cur.x;
+		ball->y = (int)ball->cur.y;
+	}
+}
+
+/* send input (paddle x, 0 to keep it, and NET_... buttons), receive
+ * states and apply them to client->game. the own paddle is moved to
+ * 'x' right away, balls are moved along their velocity between states.
+ * modifications of received states are in client->game->mod. return
+ * status NET_CLIENT_... */
+int net_client_update( NetClient *client, int ms, int x, int buttons )
+{
+	Paddle *paddle;
+	NetBuffer buf;
+	NetAddr addr;
+	int msg, states = 0;
+
+	client->stats.time += ms;
+	client->idle += ms;
+	if ( client->game )
+		memset( &client->game->mod, 0, sizeof( GameMod ) );
+
+	while ( net_recv( client->sock, &addr, &buf ) ) {
+		if ( !net_addr_equal( &addr, &client->server ) )
+			continue;
+		client->stats.bytes_recv += buf.size;
+		client->stats.packets_recv++;
+		client->idle = 0;
+		msg = net_read_int8( &buf );
+		if ( msg == MSG_LEVEL )
+			net_client_handle_level( client, &buf );
+		else if ( msg == MSG_STATE && client->game ) {
+			net_client_handle_state( client, &buf );
+			states++;
+		} else if ( msg == MSG_LEAVE ) {
+			if ( client->verbose )
+				fprintf( stderr, "server closed connection\n" );
+			return client->status = NET_CLIENT_ERROR;
+		}
+	}
+	if ( client->idle > NET_TIMEOUT ) {
+		if ( client->verbose )
+			fprintf( stderr, "server not responding\n" );
+		return client->status = NET_CLIENT_ERROR;
+	}
+
+	if ( client->game == 0 ) {
+		if ( ( client->join_delay -= ms ) <= 0 ) {
+			net_buffer_clear( &buf );
+			net_write_int8( &buf, MSG_JOIN );
+			net_write_int8( &buf, NET_PROTOCOL );
+			net_send_counted( client->sock, &client->server, &buf, &client->stats );
+			client->join_delay = NET_JOIN_DELAY;
+		}
+		return client->status = NET_CLIENT_WAITING;
+	}
+
+	/* predict own paddle, clamped as by game_set_paddle_state() */
+	paddle = client->game->paddles[client->paddle];
+	if ( x != 0 && !paddle->frozen ) {
+		if ( paddle->x != x && paddle->invis )
+			paddle->invis_delay = PADDLE_INVIS_DELAY;
+		if ( x + paddle->w > 640 - BRICK_WIDTH )
+			x = 640 - BRICK_WIDTH - paddle->w;
+		if ( x < BRICK_WIDTH )
+			x = BRICK_WIDTH;
+		paddle->x = x;
+		paddle->cur_x = x;
+	}
+	if ( states == 0 )
+		net_client_extrapolate( client, ms );
+
+	client->input_seq++;
+	client->input_time[client->input_seq % NET_INPUT_HISTORY] = client->stats.time;
+	net_buffer_clear( &buf );
+	net_write_int8( &buf, MSG_INPUT );
+	net_write_int32( &buf, client->input_seq );
+	net_write_int32( &buf, client->events );
+	net_write_int16( &buf, paddle->x );
+	net_write_int8( &buf, buttons );
+	net_send_counted( client->sock, &client->server, &buf, &client->stats );
+
+	if ( client->tick == -1 )
+		client->status = NET_CLIENT_WAITING;
+	else if ( client->game->level_over )
+		client->status = NET_CLIENT_OVER;
+	else
+		client->status = NET_CLIENT_PLAYING;
+	return client->status;
+}
+
+/*
+====================================================================
+Peer
+====================================================================
+*/
+
+static NetPeer *net_peer_create( int port, int delay )
+{
+	NetPeer *peer = salloc( 1, sizeof( NetPeer ) );
+	int i;
+
+	peer->paddle = -1;
+	peer->delay = MAXIMUM( 0, MINIMUM( delay, NET_PEER_MAX_DELAY ) );
+	peer->confirmed = peer->final = peer->rollback = peer->over_frame = -1;
+	peer->remote_frame = peer->acked = -1;
+	peer->remote_hash_frame = peer->checked = -1;
+	peer->verbose = 1;
+	peer->frames = salloc( NET_PEER_HISTORY, sizeof( NetPeerFrame ) );
+	for ( i = 0; i < NET_PEER_HISTORY; i++ )
+		peer->frames[i].confirmed = -1;
+	if ( ( peer->sock = net_open( port ) ) < 0 ) {
+		free( peer->frames );
+		free( peer );
+		return 0;
+	}
+	return peer;
+}
+
+/* create game and start with frame 0. the host sets the seed. */
+static int net_peer_start( NetPeer *peer )
+{
+	Game *old = cur_game;
+
+	peer->game = net_game_create( &peer->level, &peer->settings, 1, peer->seed );
+	game_set_current( old );
+	if ( peer->game == 0 )
+		return 0;
+	peer->joined = 1;
+	if ( peer->verbose )
+		printf( "playing with %s as player %d, input delay %d ms\n",
+				net_addr_str( &peer->remote ), peer->paddle + 1,
+				peer->delay * NET_PEER_FRAME );
+	return 1;
+}
+
+static void net_peer_send_level( NetPeer *peer )
+{
+	NetBuffer buf;
+
+	net_buffer_clear( &buf );
+	net_write_int8( &buf, MSG_PEER_LEVEL );
+	net_write_int8( &buf, 1 - peer->paddle );
+	net_write_settings( &buf, &peer->settings );
+	net_write_level( &buf, &peer->level );
+	net_write_int32( &buf, peer->seed );
+	net_send_counted( peer->sock, &peer->remote, &buf, &peer->stats );
+}
+
+/* host a peer to peer game of PINGPONG 'level' on 'port' and wait for
+ * the other peer. 'delay' is the own input delay in frames. */
+NetPeer *net_peer_host( int port, Level *level, NetSettings *settings, int delay )
+{
+	NetPeer *peer;
+
+	if ( level->type != LT_NORMAL || level->normal_brick_count > 0 ) {
+		fprintf( stderr, "peer to peer games are for PINGPONG levels only\n" );
+		return 0;
+	}
+	if ( ( peer = net_peer_create( port, delay ) ) == 0 )
+		return 0;
+	peer->host = 1;
+	peer->paddle = PADDLE_BOTTOM;
+	peer->level = *level;
+	peer->settings = *settings;
+	/* peers may be different builds on different machines */
+	peer->settings.fixed_physics = 1;
+	net_settings_check( &peer->settings );
+	peer->seed = rand() + 1;
+	return peer;
+}
+/* join peer at 'host':'port' */
+NetPeer *net_peer_join( const char *host, int port, int delay )
+{
+	NetPeer *peer;
+
+	if ( ( peer = net_peer_create( 0, delay ) ) == 0 )
+		return 0;
+	if ( !net_addr_set( &peer->remote, host, port ) ) {
+		net_peer_delete( &peer );
+		return 0;
+	}
+	return peer;
+}
+void net_peer_delete( NetPeer **_peer )
+{
+	NetPeer *peer = *_peer;
+	int i;
+
+	if ( peer == 0 )
+		return;
+	if ( peer->joined || !peer->host )
+		net_send_msg( peer->sock, &peer->remote, MSG_LEAVE, &peer->stats );
+	net_close( peer->sock );
+	net_game_delete( &peer->game );
+	for ( i = 0; i < NET_PEER_HISTORY; i++ )
+		game_snapshot_free( &peer->frames[i].snapshot );
+	free( peer->frames );
+	free( peer );
+	*_peer = 0;
+}
+
+/* store remote inputs and mark the first frame that was simulated with
+ * a wrong prediction for rollback. inputs of frames too far ahead are
+ * dropped as their ring entries are still in use, they are sent again. */
+static void net_peer_handle_input( NetPeer *peer, NetBuffer *buf )
+{
+	NetPeerFrame *frame;
+	unsigned int lo, hi;
+	int i, f, x, buttons, first, count, ack, remote = 1 - peer->paddle;
+
+	f = net_read_int32( buf );
+	if ( f > peer->remote_frame ) {
+		peer->remote_frame = f;
+		peer->remote_advantage = net_read_int8( buf );
+	} else
+		net_read_int8( buf );
+	ack = net_read_int32( buf );
+	if ( ack > peer->acked && ack < peer->frame + peer->delay )
+		peer->acked = ack;
+	first = net_read_int32( buf );
+	count = net_read_uint8( buf );
+	for ( i = 0; i < count; i++ ) {
+		f = first + i;
+		x = net_read_int16( buf );
+		buttons = net_read_uint8( buf );
+		if ( buf->error )
+			return;
+		if ( f <= peer->confirmed || f >= peer->frame + NET_PEER_HISTORY / 2 )
+			continue;
+		frame = &peer->frames[f % NET_PEER_HISTORY];
+		if ( frame->confirmed == f )
+			continue;
+		if ( f < peer->frame && ( frame->x[remote] != x || frame->buttons[remote] != buttons ) )
+			if ( peer->rollback == -1 || f < peer->rollback )
+				peer->rollback = f;
+		frame->x[remote] = x;
+		frame->buttons[remote] = buttons;
+		frame->confirmed = f;
+	}
+	while ( peer->frames[( peer->confirmed + 1 ) % NET_PEER_HISTORY].confirmed == peer->confirmed + 1 )
+		peer->confirmed++;
+
+	f = net_read_int32( buf );
+	lo = net_read_int32( buf );
+	hi = net_read_int32( buf );
+	if ( !buf->error && f > peer->remote_hash_frame ) {
+		peer->remote_hash_frame = f;
+		peer->remote_hash = ( (unsigned long long)hi << 32 ) | lo;
+	}
+}
+
+static void net_peer_receive( NetPeer *peer )
+{
+	NetBuffer buf;
+	NetAddr addr;
+	int msg, paddle;
+
+	while ( net_recv( peer->sock, &addr, &buf ) ) {
+		msg = net_read_int8( &buf );
+		if ( peer->host && !peer->joined && msg == MSG_PEER_JOIN ) {
+			if ( net_read_int8( &buf ) != NET_PROTOCOL ) {
+				fprintf( stderr, "%s: wrong protocol\n", net_addr_str( &addr ) );
+				continue;
+			}
+			peer->remote = addr;
+			if ( !net_peer_start( peer ) ) {
+				peer->status = NET_CLIENT_ERROR;
+				return;
+			}
+		}
+		if ( !net_addr_equal( &addr, &peer->remote ) )
+			continue;
+		peer->stats.bytes_recv += buf.size;
+		peer->stats.packets_recv++;
+		peer->idle = 0;
+		if ( msg == MSG_PEER_JOIN && peer->host )
+			net_peer_send_level( peer ); /* again if lost */
+		else if ( msg == MSG_PEER_LEVEL && !peer->host && !peer->joined ) {
+			paddle = net_read_int8( &buf );
+			net_read_settings( &buf, &peer->settings );
+			net_read_level( &buf, &peer->level );
+			peer->seed = net_read_int32( &buf );
+			net_settings_check( &peer->settings );
+			if ( buf.error || paddle < 0 || paddle > 1 )
+				continue;
+			peer->paddle = paddle;
+			if ( !net_peer_start( peer ) ) {
+				peer->status = NET_CLIENT_ERROR;
+				return;
+			}
+		} else if ( msg == MSG_PEER_INPUT && peer->joined )
+			net_peer_handle_input( peer, &buf );
+		else if ( msg == MSG_LEAVE ) {
+			if ( peer->verbose )
+				fprintf( stderr, "peer left\n" );
+			peer->status = NET_CLIENT_ERROR;
+			return;
+		}
+	}
+}
+
+/* frame, frame advantage, acknowledged remote inputs, own inputs not
+ * acknowledged yet (oldest first if there are too many) and the last
+ * final hash */
+static void net_peer_send_input( NetPeer *peer )
+{
+	NetPeerFrame *frame;
+	NetBuffer buf;
+	int i, first, count;
+
+	first = peer->acked + 1;
+	count = MINIMUM( peer->frame + peer->delay - first, NET_PEER_HISTORY / 2 );
+	count = MAXIMUM( count, 0 );
+	net_buffer_clear( &buf );
+	net_write_int8( &buf, MSG_PEER_INPUT );
+	net_write_int32( &buf, peer->frame );
+	i = peer->remote_frame == -1 ? 0 : peer->frame - peer->remote_frame;
+	net_write_int8( &buf, MAXIMUM( -128, MINIMUM( i, 127 ) ) );
+	net_write_int32( &buf, peer->confirmed );
+	net_write_int32( &buf, first );
+	net_write_int8( &buf, count );
+	for ( i = first; i < first + count; i++ ) {
+		frame = &peer->frames[i % NET_PEER_HISTORY];
+		net_write_int16( &buf, frame->x[peer->paddle] );
+		net_write_int8( &buf, frame->buttons[peer->paddle] );
+	}
+	i = peer->final < 0 ? -1 : peer->final - peer->final % NET_PEER_CHECK;
+	net_write_int32( &buf, i );
+	frame = &peer->frames[MAXIMUM( i, 0 ) % NET_PEER_HISTORY];
+	net_write_int32( &buf, (int)( frame->hash & 0xffffffff ) );
+	net_write_int32( &buf, (int)( frame->hash >> 32 ) );
+	net_send_counted( peer->sock, &peer->remote, &buf, &peer->stats );
+}
+
+/* simulate frame 'f' on the current game after saving the state
+ * before it. a missing remote input is predicted to be the previous
+ * one. once all remote inputs up to 'f' arrived and matched, the last
+ * simulation of it was the final one and so is its hash. */
+static void net_peer_simulate( NetPeer *peer, int f )
+{
+	NetPeerFrame *frame = &peer->frames[f % NET_PEER_HISTORY], *prev;
+	int i, remote = 1 - peer->paddle;
+
+	if ( frame->confirmed != f ) {
+		prev = &peer->frames[( f + NET_PEER_HISTORY - 1 ) % NET_PEER_HISTORY];
+		frame->x[remote] = f > 0 ? prev->x[remote] : 0;
+		frame->buttons[remote] = f > 0 ? prev->buttons[remote] : 0;
+	}
+	game_save( peer->game, &frame->snapshot );
+	frame->still[0] = peer->still[0];
+	frame->still[1] = peer->still[1];
+	if ( !peer->game->level_over ) {
+		for ( i = 0; i < 2; i++ )
+			net_apply_input( peer->game, i, frame->x[i], frame->buttons[i],
+					&peer->still[i], NET_PEER_FRAME );
+		game_update( NET_PEER_FRAME );
+		if ( peer->game->level_over )
+			peer->over_frame = f;
+	}
+	if ( f % NET_PEER_CHECK == 0 )
+		frame->hash = game_get_hash( peer->game );
+}
+
+/* go back to the first frame with a wrong prediction and simulate up
+ * to the current frame again */
+static void net_peer_rollback( NetPeer *peer )
+{
+	NetPeerFrame *frame = &peer->frames[peer->rollback % NET_PEER_HISTORY];
+	int f, count = peer->frame - peer->rollback;
+
+	game_restore( peer->game, &frame->snapshot );
+	peer->still[0] = frame->still[0];
+	peer->still[1] = frame->still[1];
+	if ( !peer->game->level_over )
+		peer->over_frame = -1;
+	for ( f = peer->rollback; f < peer->frame; f++ )
+		net_peer_simulate( peer, f );
+	peer->rollbacks++;
+	peer->rollback_frames += count;
+	if ( count > peer->rollback_max )
+		peer->rollback_max = count;
+	peer->rollback = -1;
+}
+
+/* compare hash of remote peer with own one of the same frame */
+static void net_peer_check( NetPeer *peer )
+{
+	NetPeerFrame *frame;
+	int f = peer->remote_hash_frame;
+
+	if ( f <= peer->checked || f > peer->final || f <= peer->frame - NET_PEER_HISTORY ||
+			f % NET_PEER_CHECK != 0 )
+		return;
+	frame = &peer->frames[f % NET_PEER_HISTORY];
+	peer->checks++;
+	if ( frame->hash != peer->remote_hash ) {
+		if ( peer->desyncs == 0 && peer->verbose )
+			fprintf( stderr, "out of sync with peer in frame %d\n", f );
+		peer->desyncs++;
+	}
+	peer->checked = f;
+}
+
+/* receive inputs of the other peer and roll back if needed, then
+ * simulate the frames 'ms' are worth with own input 'x' (paddle x, 0
+ * to keep it) and NET_... 'buttons' and send it. modifications of the
+ * new frames are in peer->game->mod. return status NET_CLIENT_... where
+ * NET_CLIENT_OVER is only returned once the level is over for sure. */
+int net_peer_update( NetPeer *peer, int ms, int x, int buttons )
+{
+	Game *old = cur_game;
+	NetPeerFrame *frame;
+	NetBuffer buf;
+
+	if ( peer->status == NET_CLIENT_ERROR )
+		return peer->status;
+	peer->stats.time += ms;
+	peer->idle += ms;
+	net_peer_receive( peer );
+	if ( peer->status == NET_CLIENT_ERROR )
+		return peer->status;
+	if ( peer->idle > NET_TIMEOUT ) {
+		if ( peer->verbose )
+			fprintf( stderr, "peer not responding\n" );
+		return peer->status = NET_CLIENT_ERROR;
+	}
+
+	if ( !peer->joined ) {
+		if ( !peer->host && ( peer->join_delay -= ms ) <= 0 ) {
+			net_buffer_clear( &buf );
+			net_write_int8( &buf, MSG_PEER_JOIN );
+			net_write_int8( &buf, NET_PROTOCOL );
+			net_send_counted( peer->sock, &peer->remote, &buf, &peer->stats );
+			peer->join_delay = NET_JOIN_DELAY;
+		}
+		if ( peer->host )
+			peer->idle = 0; /* wait as long as it takes */
+		return peer->status = NET_CLIENT_WAITING;
+	}
+
+	game_set_current( peer->game );
+	if ( peer->rollback != -1 )
+		net_peer_rollback( peer );
+	game_reset_mods();
+
+	peer->time = MINIMUM( peer->time + ms, NET_PEER_MAX_TIME );
+	for ( ; peer->time >= NET_PEER_FRAME; peer->time -= NET_PEER_FRAME ) {
+		/* can't go further back than the snapshots */
+		if ( peer->frame - peer->confirmed > NET_PEER_ROLLBACK ) {
+			peer->stalls++;
+			continue;
+		}
+		/* being ahead means the other peer rolls back more */
+		if ( peer->remote_frame != -1 && --peer->sync_time <= 0 &&
+				( peer->frame - peer->remote_frame ) - peer->remote_advantage >= 2 ) {
+			peer->waits++;
+			peer->sync_time = NET_PEER_SYNC;
+			continue;
+		}
+		frame = &peer->frames[( peer->frame + peer->delay ) % NET_PEER_HISTORY];
+		frame->x[peer->paddle] = x;
+		frame->buttons[peer->paddle] = buttons;
+		net_peer_simulate( peer, peer->frame++ );
+	}
+	peer->final = MINIMUM( peer->confirmed, peer->frame - 1 );
+	net_peer_check( peer );
+	net_peer_send_input( peer );
+	game_set_current( old );
+
+	if ( peer->game->level_over && peer->over_frame <= peer->final )
+		peer->status = NET_CLIENT_OVER;
+	else
+		peer->status = NET_CLIENT_PLAYING;
+	return peer->status;
+}
@@ -0,0 +1,241 @@
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef __NETGAME_H
+#define __NETGAME_H
+
+/***** INCLUDES ************************************************************/
+
+#include "game.h"
+#include "net.h"
+
+/***** TYPE DEFINITIONS ****************************************************/
+
+/* Two player game (GT_NETWORK) over UDP. The server runs the only real
+ * game and broadcasts its state after every update. Clients keep a
+ * mirror of the game for rendering which is only changed by states
+ * except for the own paddle which is predicted from local input.
+ *
+ * Balls, shots, extras and paddles are sent completely in every state
+ * (quantized) as they change all the time. Bricks are delta compressed:
+ * the brick hits and collected extras of GameMod are numbered events
+ * of which each state carries the ones the client did not acknowledge
+ * yet, together with the current state of the hit brick. Lost states
+ * need no resend that way.
+ *
+ * This is used by the netplay and lbreakouthd-server tools only, the
+ * game client (src/) has no network transport yet. */
+
+enum {
+	NET_TIMEOUT = 5000, 	/* ms without packets until peer is dropped */
+	NET_JOIN_DELAY = 500, 	/* ms between join requests */
+	NET_INPUT_HISTORY = 256, /* inputs remembered for latency */
+	NET_DIFF_COUNT = 3, 	/* difficulties of network games, see game.c */
+
+	NET_PEER_FRAME = 10, 	/* ms of a peer frame, the same for both */
+	NET_PEER_HISTORY = 64, 	/* frames of inputs and snapshots kept */
+	NET_PEER_ROLLBACK = 15, /* max frames re-simulated, see NetPeer */
+	NET_PEER_MAX_DELAY = 8 	/* max input delay in frames */
+};
+
+/* NetClient::buttons */
+enum {
+	NET_FIRE_LEFT = 1,
+	NET_FIRE_RIGHT = 2,
+	NET_RETURN = 4
+};
+
+/* net_client_update() */
+enum {
+	NET_CLIENT_WAITING = 0, /* for level or other player */
+	NET_CLIENT_PLAYING,
+	NET_CLIENT_OVER, 	/* level over, see game->winner */
+	NET_CLIENT_ERROR 	/* server not responding */
+};
+
+/* match settings that are sent to clients with the level */
+typedef struct {
+	int	diff, rel_warp_limit;
+	int	frag_limit; 	/* points to win a PINGPONG level */
+	int	ball_ammo; 	/* balls per paddle in PINGPONG level */
+	int	convex, random_angle, bcc_type, fixed_physics;
+} NetSettings;
+
+/* traffic and latency of a connection. sizes are UDP payload, add
+ * NET_UDP_OVERHEAD per packet for the actual bandwidth. */
+typedef struct {
+	int	bytes_sent, bytes_recv;
+	int	packets_sent, packets_recv;
+	int	time; 		/* ms since connection started */
+	int	latency_sum, latency_count, latency_min, latency_max;
+} NetStats;
+
+/* brick hit or collected extra */
+typedef struct {
+	int	type; 		/* NET_EVENT_... in netgame.c */
+	BrickHit hit;
+	int	paddle, extra; 	/* collected extra */
+} NetEvent;
+
+typedef struct {
+	NetAddr	addr;
+	int	joined;
+	int	input_seq; 	/* of last input applied */
+	int	x, buttons; 	/* last input */
+	int	acked_events; 	/* events the client has applied */
+	int	still; 		/* ms paddle did not move, for friction */
+	int	idle; 		/* ms since last packet */
+	NetStats stats;
+} NetServerClient;
+
+typedef struct {
+	int	sock;
+	Game	*game;
+	Level	level;
+	NetSettings settings;
+	int	tick;
+	NetEvent *events; 	/* all events of the level */
+	int	event_count, event_size;
+	NetServerClient clients[2]; /* index is paddle id */
+	int	client_count;
+	int	verbose; 	/* print joining and leaving players */
+} NetServer;
+
+typedef struct {
+	int	sock;
+	NetAddr	server;
+	int	paddle; 	/* own paddle id, -1 until joined */
+	Game	*game; 		/* mirror of server game, 0 until joined */
+	Level	level;
+	NetSettings settings;
+	int	tick; 		/* of last applied state */
+	int	events; 	/* events applied */
+	int	join_delay;
+	int	idle; 		/* ms since last packet */
+	int	status;
+	int	input_seq; 	/* of last input sent */
+	int	input_echo; 	/* last input seq echoed by server */
+	int	input_time[NET_INPUT_HISTORY]; /* stats.time when sent */
+	NetStats stats;
+	int	verbose; 	/* print joining and errors */
+} NetClient;
+
+/* Peer to peer PINGPONG game with rollback. Both peers simulate the
+ * same game from the same seed and only exchange their inputs: the
+ * own input is applied 'delay' frames later and the remote one is
+ * predicted to stay the same until it arrives. If it turns out to be
+ * different, the game is set back to the snapshot of that frame and
+ * simulated again with the actual input. A peer waits if the other one
+ * lags more than NET_PEER_ROLLBACK frames behind.
+ *
+ * Every packet carries all inputs the other peer did not acknowledge,
+ * so a lost packet only delays its inputs until the next one. It also
+ * has the hash of a recent frame that was simulated with actual inputs
+ * only to detect peers running out of sync. */
+
+typedef struct {
+	GameSnapshot snapshot; 	/* state before the frame */
+	int	still[2]; 	/* as NetServerClient::still */
+	int	x[2], buttons[2]; /* input of paddles in the frame */
+	int	confirmed; 	/* frame of received remote input, else predicted */
+	unsigned long long hash; /* after the frame, only every few frames */
+} NetPeerFrame;
+
+typedef struct {
+	int	sock;
+	NetAddr	remote;
+	int	host; 		/* waits for the other peer to join */
+	int	joined;
+	int	paddle; 	/* own paddle id, -1 until joined */
+	Game	*game; 		/* predicted game, 0 until joined */
+	Level	level;
+	NetSettings settings;
+	unsigned int seed;
+	int	delay; 		/* input delay in frames */
+	NetPeerFrame *frames; 	/* ring of NET_PEER_HISTORY */
+	int	still[2];
+	int	frame; 		/* next frame to simulate */
+	int	time; 		/* ms not simulated yet */
+	int	confirmed; 	/* last frame of remote inputs without gap */
+	int	final; 		/* last frame simulated with actual inputs only */
+	int	over_frame; 	/* frame the level ended in or -1 */
+	int	rollback; 	/* first frame to simulate again or -1 */
+	int	remote_frame; 	/* last frame remote peer reported */
+	int	remote_advantage; /* frames remote peer is ahead of us */
+	int	acked; 		/* last own input remote peer received */
+	int	remote_hash_frame, checked; /* frames hashes are compared */
+	unsigned long long remote_hash;
+	int	sync_time; 	/* frames until next wait for remote peer */
+	int	join_delay;
+	int	idle; 		/* ms since last packet */
+	int	status;
+	/* statistics */
+	int	rollbacks, rollback_frames, rollback_max;
+	int	stalls; 	/* frames waited as remote lags too far behind */
+	int	waits; 		/* frames waited to even out frame advantage */
+	int	checks, desyncs; /* hashes compared and different */
+	NetStats stats;
+	int	verbose;
+} NetPeer;
+
+/***** PUBLIC FUNCTIONS ****************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void net_settings_default( NetSettings *settings );
+
+/* open server on 'port' for 'level' which is started when both
+ * players joined. */
+NetServer *net_server_create( int port, Level *level, NetSettings *settings );
+void net_server_delete( NetServer **server );
+
+/* start level again for new players. joined players are sent away. */
+void net_server_restart( NetServer *server );
+
+/* handle incoming packets and if both players are there, apply their
+ * input, update game by 'ms' and send the new state to them. return
+ * number of joined players. */
+int net_server_update( NetServer *server, int ms );
+
+/* connect to server at 'host':'port'. */
+NetClient *net_client_create( const char *host, int port );
+void net_client_delete( NetClient **client );
+
+/* send input (paddle x, 0 to keep it, and NET_... buttons), receive
+ * states and apply them to client->game. the own paddle is moved to
+ * 'x' right away, balls are moved along their velocity between states.
+ * modifications of received states are in client->game->mod. return
+ * status NET_CLIENT_... */
+int net_client_update( NetClient *client, int ms, int x, int buttons );
+
+/* host a peer to peer game of PINGPONG 'level' on 'port' and wait for
+ * the other peer. 'delay' is the own input delay in frames. */
+NetPeer *net_peer_host( int port, Level *level, NetSettings *settings, int delay );
+/* join peer at 'host':'port' */
+NetPeer *net_peer_join( const char *host, int port, int delay );
+void net_peer_delete( NetPeer **peer );
+
+/* receive inputs of the other peer and roll back if needed, then
+ * simulate the frames 'ms' are worth with own input 'x' (paddle x, 0
+ * to keep it) and NET_... 'buttons' and send it. modifications of the
+ * new frames are in peer->game->mod. return status NET_CLIENT_... where
+ * NET_CLIENT_OVER is only returned once the level is over for sure. */
+int net_peer_update( NetPeer *peer, int ms, int x, int buttons );
+
+/* average latency from sending input to receiving the state it was
+ * applied to, -1 if none yet */
+int net_stats_latency( NetStats *stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,304 @@
+/***************************************************************************
+                          netplay.c  -  description
+                             -------------------
+    begin                : 2026/10/19
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/* Play a two player network game with autopilots as clients and
+ * report bandwidth and input latency. Either run server (-s) and
+ * clients (-c host) separately or all of them in one process over
+ * loopback (default). Without a level an empty one is used which
+ * makes it a PINGPONG level. With -r the PINGPONG level is played peer
+ * to peer with rollback instead (-s hosts, -c joins). -D, -J and -L
+ * simulate a bad connection, e.g.:
+ *   netplay -t 60
+ *   netplay -s LBreakoutHD 3 & netplay -c localhost & netplay -c localhost
+ *   netplay -D 50 -J 20 -L 5 vs. netplay -r -D 50 -J 20 -L 5 */
+
+#include <unistd.h>
+#include <SDL2/SDL.h>
+#include "netgame.h"
+#include "bot.h"
+
+enum {
+	MODE_LOCAL = 0,
+	MODE_SERVER,
+	MODE_CLIENT,
+	STEP = 10 /* ms per update */
+};
+
+static void report( const char *name, NetStats *stats )
+{
+	double secs = MAXIMUM( stats->time, 1 ) / 1000.0;
+
+	printf( "%s: %.1fs, sent %d bytes in %d packets (%.1f kbit/s, %.1f with UDP/IP), "
+			"received %d bytes in %d packets (%.1f kbit/s, %.1f with UDP/IP)\n",
+			name, stats->time / 1000.0,
+			stats->bytes_sent, stats->packets_sent, stats->bytes_sent * 8.0 / 1000 / secs,
+			( stats->bytes_sent + stats->packets_sent * NET_UDP_OVERHEAD ) * 8.0 / 1000 / secs,
+			stats->bytes_recv, stats->packets_recv, stats->bytes_recv * 8.0 / 1000 / secs,
+			( stats->bytes_recv + stats->packets_recv * NET_UDP_OVERHEAD ) * 8.0 / 1000 / secs );
+	if ( stats->latency_count > 0 )
+		printf( "%s: input latency %d ms avg, %d min, %d max\n", name,
+				net_stats_latency( stats ), stats->latency_min, stats->latency_max );
+}
+
+/* let bot control own paddle of mirror game and send its input */
+static int client_update( NetClient *client, Bot *bot, int ms )
+{
+	Paddle *paddle;
+	int x = 0, buttons = 0;
+
+	if ( client->game && client->status == NET_CLIENT_PLAYING ) {
+		game_set_current( client->game );
+		bot_update( bot, client->paddle, ms );
+		paddle = client->game->paddles[client->paddle];
+		x = paddle->x;
+		if ( paddle->fire_left ) buttons |= NET_FIRE_LEFT;
+		if ( paddle->fire_right ) buttons |= NET_FIRE_RIGHT;
+	}
+	return net_client_update( client, ms, x, buttons );
+}
+
+/* the bot changes paddle and random state of the game it plays, so it
+ * plays the predicted game of the peer which is restored afterwards */
+static int peer_update( NetPeer *peer, Bot *bot, GameSnapshot *scratch, int ms, Uint64 *busy )
+{
+	Paddle *paddle;
+	Uint64 start;
+	int x = 0, buttons = 0, status;
+
+	if ( peer->game && peer->status == NET_CLIENT_PLAYING ) {
+		game_save( peer->game, scratch );
+		game_set_current( peer->game );
+		bot_update( bot, peer->paddle, ms );
+		paddle = peer->game->paddles[peer->paddle];
+		x = paddle->x;
+		if ( paddle->fire_left ) buttons |= NET_FIRE_LEFT;
+		if ( paddle->fire_right ) buttons |= NET_FIRE_RIGHT;
+		game_restore( peer->game, scratch );
+	}
+	start = SDL_GetPerformanceCounter();
+	status = net_peer_update( peer, ms, x, buttons );
+	*busy += SDL_GetPerformanceCounter() - start;
+	return status;
+}
+
+static double us( Uint64 time )
+{
+	return time * 1000000.0 / SDL_GetPerformanceFrequency();
+}
+
+static void report_peer( const char *name, NetPeer *peer, Uint64 busy, int updates )
+{
+	printf( "%s: %d frames, input delay %d ms, %d rollbacks (%.1f frames avg, %d max), "
+			"%d frames stalled, %d waited, %d of %d hashes differ, update %.1f us avg\n",
+			name, peer->frame, peer->delay * NET_PEER_FRAME, peer->rollbacks,
+			peer->rollbacks ? (double)peer->rollback_frames / peer->rollbacks : 0,
+			peer->rollback_max, peer->stalls, peer->waits, peer->desyncs, peer->checks,
+			updates ? us( busy ) / updates : 0 );
+	report( name, &peer->stats );
+}
+
+/* time of saving and restoring the game of a peer */
+static void report_snapshot( Game *game )
+{
+	GameSnapshot snapshot;
+	Uint64 start, save, restore;
+	int i, count = 1000;
+
+	memset( &snapshot, 0, sizeof( snapshot ) );
+	start = SDL_GetPerformanceCounter();
+	for ( i = 0; i < count; i++ )
+		game_save( game, &snapshot );
+	save = SDL_GetPerformanceCounter() - start;
+	start = SDL_GetPerformanceCounter();
+	for ( i = 0; i < count; i++ )
+		game_restore( game, &snapshot );
+	restore = SDL_GetPerformanceCounter() - start;
+	printf( "game snapshot: save %.2f us, restore %.2f us (%d balls, %d bytes)\n",
+			us( save ) / count, us( restore ) / count, game->balls->count,
+			(int)sizeof( GameSnapshot ) );
+	game_snapshot_free( &snapshot );
+}
+
+int main( int argc, char **argv )
+{
+	NetSettings settings;
+	NetServer *server = 0;
+	NetClient *clients[2] = { 0, 0 };
+	NetPeer *peers[2] = { 0, 0 };
+	GameSnapshot scratch[2];
+	Uint64 busy[2] = { 0, 0 };
+	Bot *bots[2] = { 0, 0 };
+	LevelSet *set = 0;
+	Level *level;
+	char *host = 0, name[32];
+	int c, i, mode = MODE_LOCAL, port = NET_DEFAULT_PORT, skill = BOT_HARD;
+	int max_time = 300000, id = 1, status, done = 0, time = 0, over_time = 0;
+	int rollback = 0, delay = 1, lag = 0, jitter = 0, loss = 0, updates = 0;
+	unsigned int now, last;
+
+	memset( scratch, 0, sizeof( scratch ) );
+	net_settings_default( &settings );
+	while ( ( c = getopt( argc, argv, "sc:p:b:d:t:m:fri:D:J:L:" ) ) != -1 ) {
+		switch ( c ) {
+			case 's': mode = MODE_SERVER; break;
+			case 'c': mode = MODE_CLIENT; host = optarg; break;
+			case 'p': port = atoi( optarg ); break;
+			case 'b': skill = atoi( optarg ); break;
+			case 'd': settings.diff = atoi( optarg ); break;
+			case 't': max_time = atoi( optarg ) * 1000; break;
+			case 'm': settings.frag_limit = atoi( optarg ); break;
+			case 'f': settings.fixed_physics = 1; break;
+			case 'r': rollback = 1; break;
+			case 'i': delay = atoi( optarg ); break;
+			case 'D': lag = atoi( optarg ); break;
+			case 'J': jitter = atoi( optarg ); break;
+			case 'L': loss = atoi( optarg ); break;
+			default: optind = argc + 1; break;
+		}
+	}
+	if ( optind > argc || skill < 0 || skill >= BOT_SKILL_COUNT ||
+			settings.diff < 0 || settings.diff >= NET_DIFF_COUNT ||
+			delay < 0 || delay > NET_PEER_MAX_DELAY ) {
+		fprintf( stderr, "Usage: %s [-s|-c host] [-p port] [-b bot skill 0-2] "
+				"[-d diff 0-2] [-t max secs] [-m frag limit] [-f] [-r] "
+				"[-i input delay frames] [-D packet delay ms] [-J jitter ms] "
+				"[-L loss %%] [SET [LEVEL]]\n", argv[0] );
+		return 1;
+	}
+	if ( lag || jitter || loss ) {
+		net_simulate( lag, jitter, loss );
+		printf( "packets delayed %d-%d ms, %d%% lost\n", lag, lag + jitter, loss );
+	}
+
+	/* level is only needed by server */
+	if ( mode != MODE_CLIENT ) {
+		if ( optind < argc ) {
+			if ( optind + 1 < argc )
+				id = atoi( argv[optind + 1] );
+			if ( ( set = levelset_load( argv[optind], 0 ) ) == 0 )
+				return 1;
+			if ( id < 1 || id > set->count ) {
+				fprintf( stderr, "%s has no level %d\n", set->name, id );
+				return 1;
+			}
+		} else
+			set = levelset_create_empty( 1, "netplay", "PingPong" );
+		level = set->levels[id - 1];
+		if ( rollback ) {
+			if ( ( peers[0] = net_peer_host( port, level, &settings, delay ) ) == 0 )
+				return 1;
+			bots[0] = bot_create( skill );
+		} else {
+			if ( ( server = net_server_create( port, level, &settings ) ) == 0 )
+				return 1;
+			printf( "serving '%s' on port %d\n", level->name, port );
+		}
+	}
+	if ( rollback ) {
+		if ( mode != MODE_SERVER ) {
+			i = ( mode == MODE_LOCAL );
+			if ( ( peers[i] = net_peer_join( host ? host : "localhost", port, delay ) ) == 0 )
+				return 1;
+			bots[i] = bot_create( skill );
+		}
+	} else if ( mode != MODE_SERVER )
+		for ( i = 0; i < ( mode == MODE_LOCAL ? 2 : 1 ); i++ ) {
+			if ( ( clients[i] = net_client_create( host ? host : "localhost", port ) ) == 0 )
+				return 1;
+			bots[i] = bot_create( skill );
+		}
+
+	last = SDL_GetTicks();
+	while ( !done ) {
+		SDL_Delay( STEP );
+		now = SDL_GetTicks();
+		if ( server ) {
+			net_server_update( server, now - last );
+			if ( server->game->level_over )
+				over_time += now - last;
+		}
+		done = 1;
+		if ( rollback ) {
+			/* wait a bit when over so the other peer gets the last inputs */
+			for ( i = 0; i < 2; i++ )
+				if ( peers[i] ) {
+					status = peer_update( peers[i], bots[i], &scratch[i],
+							now - last, &busy[i] );
+					if ( status == NET_CLIENT_WAITING || status == NET_CLIENT_PLAYING )
+						done = 0;
+					else if ( status == NET_CLIENT_OVER && over_time < 1000 )
+						done = 0;
+				}
+			updates++;
+			if ( done == 0 && ( peers[0] == 0 || peers[0]->status == NET_CLIENT_OVER ) &&
+					( peers[1] == 0 || peers[1]->status == NET_CLIENT_OVER ) )
+				over_time += now - last;
+		}
+		for ( i = 0; i < 2; i++ )
+			if ( clients[i] ) {
+				status = client_update( clients[i], bots[i], now - last );
+				if ( status == NET_CLIENT_WAITING || status == NET_CLIENT_PLAYING )
+					done = 0;
+			}
+		/* server alone waits a bit so the final state arrives */
+		if ( mode == MODE_SERVER && over_time < 1000 )
+			done = 0;
+		if ( ( time += now - last ) >= max_time )
+			done = 1;
+		last = now;
+	}
+
+	for ( i = 0; i < 2; i++ )
+		if ( peers[i] ) {
+			if ( peers[i]->game ) {
+				printf( "player %d: %s after %.1fs: %d : %d\n", peers[i]->paddle + 1,
+						peers[i]->status == NET_CLIENT_OVER ? "level over" : "stopped",
+						peers[i]->game->time / 1000.0,
+						peers[i]->game->paddles[0]->score,
+						peers[i]->game->paddles[1]->score );
+				snprintf( name, sizeof( name ), "player %d", peers[i]->paddle + 1 );
+			} else
+				snprintf( name, sizeof( name ), "peer" );
+			report_peer( name, peers[i], busy[i], updates );
+		}
+	if ( peers[0] && peers[0]->game )
+		report_snapshot( peers[0]->game );
+	for ( i = 0; i < 2; i++ ) {
+		net_peer_delete( &peers[i] );
+		bot_delete( &bots[i] );
+		game_snapshot_free( &scratch[i] );
+	}
+	if ( server ) {
+		printf( "%s after %.1fs: %d : %d\n",
+				server->game->level_over ? "level over" : "stopped",
+				server->game->time / 1000.0,
+				server->game->paddles[0]->score, server->game->paddles[1]->score );
+		for ( i = 0; i < 2; i++ ) {
+			snprintf( name, sizeof( name ), "server to player %d", i + 1 );
+			report( name, &server->clients[i].stats );
+		}
+	}
+	for ( i = 0; i < 2; i++ )
+		if ( clients[i] ) {
+			snprintf( name, sizeof( name ), "player %d", clients[i]->paddle + 1 );
+			report( name, &clients[i]->stats );
+			bot_delete( &bots[i] );
+			net_client_delete( &clients[i] );
+		}
+	net_server_delete( &server );
+	if ( set )
+		levelset_delete( &set );
+	return 0;
+}
@@ -19,7 +19,7 @@
 #include "shots.h"
 #include "paddle.h"
 
-extern Game *cur_game;
+extern GAME_TLS Game *cur_game;
 int paddle_cw = 18, paddle_ch = 18; /* size of a paddle component */
 
 /*
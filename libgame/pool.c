@@ -0,0 +1,172 @@
+/***************************************************************************
+                          pool.c  -  description
+                             -------------------
+    begin                : 2026/10/19
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/***** INCLUDES ************************************************************/
+
+#include "pool.h"
+#include "gamedefs.h"
+
+/***** LOCAL TYPE DEFINITIONS **********************************************/
+
+typedef struct {
+	Pool	*pool;
+	int	id;
+} PoolWorker;
+
+/***** LOCAL FUNCTIONS *****************************************************/
+
+/* take next index of queue, from tail if 'steal' is set. return -1
+ * if queue is empty. */
+static int pool_take( PoolQueue *queue, int steal )
+{
+	int i = -1;
+
+	SDL_LockMutex( queue->lock );
+	if ( queue->head < queue->tail )
+		i = steal ? --queue->tail : queue->head++;
+	SDL_UnlockMutex( queue->lock );
+	return i;
+}
+
+/* do own share, then help the others */
+static void pool_work( Pool *pool, int id )
+{
+	int i, k;
+
+	while ( ( i = pool_take( &pool->queues[id], 0 ) ) != -1 )
+		pool->func( pool->data, i );
+	for ( k = 1; k < pool->threads; k++ )
+		while ( ( i = pool_take( &pool->queues[( id + k ) % pool->threads], 1 ) ) != -1 ) {
+			SDL_AtomicAdd( &pool->steals, 1 );
+			pool->func( pool->data, i );
+		}
+}
+
+/* wait for next run, work and report when done */
+static int pool_worker( void *data )
+{
+	PoolWorker *worker = data;
+	Pool *pool = worker->pool;
+	int run = 0;
+
+	for ( ;; ) {
+		SDL_LockMutex( pool->lock );
+		while ( pool->run == run && !pool->quit )
+			SDL_CondWait( pool->start, pool->lock );
+		run = pool->run;
+		if ( pool->quit ) {
+			SDL_UnlockMutex( pool->lock );
+			break;
+		}
+		SDL_UnlockMutex( pool->lock );
+
+		pool_work( pool, worker->id );
+
+		SDL_LockMutex( pool->lock );
+		if ( --pool->busy == 0 )
+			SDL_CondSignal( pool->done );
+		SDL_UnlockMutex( pool->lock );
+	}
+	free( worker );
+	return 0;
+}
+
+/***** PUBLIC FUNCTIONS ****************************************************/
+
+/* create pool of 'threads' workers (0 for one per CPU core). the
+ * calling thread of pool_run() is one of them. */
+Pool *pool_create( int threads )
+{
+	Pool *pool = salloc( 1, sizeof( Pool ) );
+	PoolWorker *worker;
+	int i;
+
+	if ( threads <= 0 )
+		threads = SDL_GetCPUCount();
+	pool->queues = salloc( threads, sizeof( PoolQueue ) );
+	for ( i = 0; i < threads; i++ )
+		pool->queues[i].lock = SDL_CreateMutex();
+	pool->lock = SDL_CreateMutex();
+	pool->start = SDL_CreateCond();
+	pool->done = SDL_CreateCond();
+	SDL_AtomicSet( &pool->steals, 0 );
+
+	/* if a thread can't be created the others do its share */
+	pool->threads = 1;
+	pool->workers = salloc( threads, sizeof( SDL_Thread* ) );
+	for ( i = 0; i < threads - 1; i++ ) {
+		worker = salloc( 1, sizeof( PoolWorker ) );
+		worker->pool = pool;
+		worker->id = pool->threads - 1;
+		if ( ( pool->workers[worker->id] = SDL_CreateThread( pool_worker, "pool", worker ) ) == 0 ) {
+			fprintf( stderr, "couldn't create thread: %s\n", SDL_GetError() );
+			free( worker );
+			break;
+		}
+		pool->threads++;
+	}
+	return pool;
+}
+void pool_delete( Pool **_pool )
+{
+	Pool *pool = *_pool;
+	int i;
+
+	if ( pool == 0 )
+		return;
+	SDL_LockMutex( pool->lock );
+	pool->quit = 1;
+	SDL_CondBroadcast( pool->start );
+	SDL_UnlockMutex( pool->lock );
+	for ( i = 0; i < pool->threads - 1; i++ )
+		SDL_WaitThread( pool->workers[i], 0 );
+	for ( i = 0; i < pool->threads; i++ )
+		SDL_DestroyMutex( pool->queues[i].lock );
+	SDL_DestroyMutex( pool->lock );
+	SDL_DestroyCond( pool->start );
+	SDL_DestroyCond( pool->done );
+	free( pool->workers );
+	free( pool->queues );
+	free( pool );
+	*_pool = 0;
+}
+
+/* call 'func' for each index 0 to 'count'-1 on the workers and return
+ * when all are done. */
+void pool_run( Pool *pool, int count, PoolFunc func, void *data )
+{
+	int i;
+
+	/* workers are waiting so the queues can be set without locking */
+	for ( i = 0; i < pool->threads; i++ ) {
+		pool->queues[i].head = count * i / pool->threads;
+		pool->queues[i].tail = count * ( i + 1 ) / pool->threads;
+	}
+	pool->func = func;
+	pool->data = data;
+
+	SDL_LockMutex( pool->lock );
+	pool->busy = pool->threads - 1;
+	pool->run++;
+	SDL_CondBroadcast( pool->start );
+	SDL_UnlockMutex( pool->lock );
+
+	pool_work( pool, pool->threads - 1 );
+
+	SDL_LockMutex( pool->lock );
+	while ( pool->busy > 0 )
+		SDL_CondWait( pool->done, pool->lock );
+	SDL_UnlockMutex( pool->lock );
+}
@@ -0,0 +1,66 @@
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef __POOL_H
+#define __POOL_H
+
+/***** INCLUDES ************************************************************/
+
+#include <SDL2/SDL.h>
+
+/***** TYPE DEFINITIONS ****************************************************/
+
+/* called for each index of pool_run() */
+typedef void (*PoolFunc)( void *data, int index );
+
+/* indices not yet taken from a worker's share. the owner takes from
+ * head, other workers steal from tail. */
+typedef struct {
+	SDL_mutex	*lock;
+	int		head, tail;
+} PoolQueue;
+
+/* Persistent worker threads for running many small jobs over and over
+ * again (like one update of each game per tick). Each worker gets a
+ * contiguous share of the indices so it keeps working on the same
+ * games, and steals from the others when done with its own. */
+typedef struct {
+	int		threads; 	/* including caller of pool_run() */
+	SDL_Thread	**workers;
+	PoolQueue	*queues; 	/* per worker, caller is the last */
+	SDL_mutex	*lock;
+	SDL_cond	*start, *done;
+	int		run; 		/* number of pool_run() calls */
+	int		busy; 		/* workers not done with this run */
+	int		quit;
+	PoolFunc	func;
+	void		*data;
+	SDL_atomic_t	steals; 	/* jobs taken from other workers */
+} Pool;
+
+/***** PUBLIC FUNCTIONS ****************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* create pool of 'threads' workers (0 for one per CPU core). the
+ * calling thread of pool_run() is one of them. */
+Pool *pool_create( int threads );
+void pool_delete( Pool **pool );
+
+/* call 'func' for each index 0 to 'count'-1 on the workers and return
+ * when all are done. */
+void pool_run( Pool *pool, int count, PoolFunc func, void *data );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,298 @@
+/***************************************************************************
+                          replay.c  -  description
+                             -------------------
+    begin                : 2026/10/19
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/***** INCLUDES ************************************************************/
+
+#include "replay.h"
+
+/***** EXTERNAL VARIABLES **************************************************/
+
+extern GAME_TLS Game *cur_game;
+
+/***** DEFINITIONS *********************************************************/
+
+#define REPLAY_MAGIC "LBreakoutHD replay 1"
+
+/***** LOCAL FUNCTIONS *****************************************************/
+
+static void replay_get_input( ReplayInput *input, Paddle *paddle )
+{
+	input->x = paddle->x;
+	input->cur_x = paddle->cur_x;
+#ifdef PADDLE_FRICTION
+	input->v_x = paddle->v_x;
+#endif
+	input->invis_delay = paddle->invis_delay;
+	input->buttons = 0;
+	if ( paddle->fire_left ) input->buttons |= REPLAY_FIRE_LEFT;
+	if ( paddle->fire_right ) input->buttons |= REPLAY_FIRE_RIGHT;
+	if ( paddle->ball_return_key_pressed ) input->buttons |= REPLAY_RETURN;
+	if ( paddle->maxballspeed_request ) input->buttons |= REPLAY_SPEEDUP;
+	if ( paddle->maxballspeed_request_old ) input->buttons |= REPLAY_SPEEDUP_OLD;
+}
+static void replay_set_input( ReplayInput *input, Paddle *paddle )
+{
+	paddle->x = input->x;
+	paddle->cur_x = input->cur_x;
+#ifdef PADDLE_FRICTION
+	paddle->v_x = input->v_x;
+#endif
+	paddle->invis_delay = input->invis_delay;
+	paddle->fire_left = ( input->buttons & REPLAY_FIRE_LEFT ) != 0;
+	paddle->fire_right = ( input->buttons & REPLAY_FIRE_RIGHT ) != 0;
+	paddle->ball_return_key_pressed = ( input->buttons & REPLAY_RETURN ) != 0;
+	paddle->maxballspeed_request = ( input->buttons & REPLAY_SPEEDUP ) != 0;
+	paddle->maxballspeed_request_old = ( input->buttons & REPLAY_SPEEDUP_OLD ) != 0;
+}
+
+/* settings are applied by the client after game_init() */
+static void replay_get_settings( Replay *replay, Game *game )
+{
+	int i;
+
+	replay->local_server = game->localServerGame;
+	replay->convex = game->paddle_is_convex;
+	replay->return_by_click = game->balls_return_by_click;
+	replay->random_angle = game->balls_use_random_angle;
+	replay->bcc_type = game->bcc_type;
+	replay->fixed_physics = game->fixed_physics;
+	replay->auto_speedup = game->ball_auto_speedup;
+	replay->frag_limit = game->frag_limit;
+	replay->accelerated_ball_speed = game->accelerated_ball_speed;
+	for ( i = 0; i < game->paddle_count; i++ )
+		replay->score[i] = game->paddles[i]->score;
+}
+static void replay_set_settings( Replay *replay, Game *game )
+{
+	int i;
+
+	game->paddle_is_convex = replay->convex;
+	game->balls_return_by_click = replay->return_by_click;
+	game->balls_use_random_angle = replay->random_angle;
+	game->bcc_type = replay->bcc_type;
+	game->fixed_physics = replay->fixed_physics;
+	game->ball_auto_speedup = replay->auto_speedup;
+	game->frag_limit = replay->frag_limit;
+	game->accelerated_ball_speed = replay->accelerated_ball_speed;
+	for ( i = 0; i < game->paddle_count; i++ )
+		game->paddles[i]->score = replay->score[i];
+}
+
+/* read line without newline, return 0 on failure */
+static int read_line( FILE *file, char *buf, int size )
+{
+	if ( fgets( buf, size, file ) == 0 )
+		return 0;
+	buf[strcspn( buf, "\r\n" )] = 0;
+	return 1;
+}
+
+/***** PUBLIC FUNCTIONS ****************************************************/
+
+/* start recording 'game'. call right before game_init( game, level ). */
+Replay *replay_create( Game *game, Level *level )
+{
+	Replay *replay = salloc( 1, sizeof( Replay ) );
+
+	replay->level = *level;
+	replay->game_type = game->game_type;
+	replay->diff = game_get_diff( game );
+	replay->rel_warp_limit = game->rel_warp_limit;
+	replay->seed = game->rand_state;
+	return replay;
+}
+void replay_delete( Replay **replay )
+{
+	if ( *replay == 0 )
+		return;
+	free( (*replay)->frames );
+	free( *replay );
+	*replay = 0;
+}
+
+/* record the paddle state of the current game, call game_update( ms )
+ * and record the hash of the new state. replaces game_update() while
+ * recording. */
+void replay_update( Replay *replay, int ms )
+{
+	ReplayFrame *frame;
+	int i;
+
+	if ( replay->count == 0 )
+		replay_get_settings( replay, cur_game );
+	if ( replay->count == replay->size ) {
+		replay->size = replay->size ? 2 * replay->size : 4096;
+		replay->frames = realloc( replay->frames, replay->size * sizeof( ReplayFrame ) );
+	}
+	frame = &replay->frames[replay->count++];
+	memset( frame, 0, sizeof( ReplayFrame ) );
+	frame->ms = ms;
+	for ( i = 0; i < cur_game->paddle_count; i++ )
+		replay_get_input( &frame->input[i], cur_game->paddles[i] );
+	frame->rand_state = cur_game->rand_state;
+	game_update( ms );
+	frame->hash = game_get_hash( cur_game );
+}
+
+/* text file with exact floats so it can be checked by other builds */
+int replay_save( Replay *replay, const char *fname )
+{
+	ReplayFrame *frame;
+	ReplayInput *in;
+	FILE *file;
+	int i, j, paddles = ( replay->game_type == GT_NETWORK ) ? 2 : 1;
+
+	if ( ( file = fopen( fname, "w" ) ) == 0 ) {
+		fprintf( stderr, "couldn't open %s\n", fname );
+		return 0;
+	}
+	fprintf( file, "%s\n%d %d %d %llx %d %d %d %d %d %d %d %d %a %d %d %d\n",
+			REPLAY_MAGIC, replay->game_type, replay->diff,
+			replay->rel_warp_limit, replay->seed, replay->local_server,
+			replay->convex, replay->return_by_click, replay->random_angle,
+			replay->bcc_type, replay->fixed_physics,
+			replay->auto_speedup, replay->frag_limit,
+			replay->accelerated_ball_speed, replay->score[0],
+			replay->score[1], replay->level.type );
+	fprintf( file, "%s\n%s\n", replay->level.author, replay->level.name );
+	for ( j = 0; j < EDIT_HEIGHT; j++ ) {
+		for ( i = 0; i < EDIT_WIDTH; i++ )
+			fputc( replay->level.bricks[i][j], file );
+		fputc( '\n', file );
+	}
+	for ( j = 0; j < EDIT_HEIGHT; j++ ) {
+		for ( i = 0; i < EDIT_WIDTH; i++ )
+			fputc( replay->level.extras[i][j], file );
+		fputc( '\n', file );
+	}
+	fprintf( file, "%d\n", replay->count );
+	for ( i = 0; i < replay->count; i++ ) {
+		frame = &replay->frames[i];
+		fprintf( file, "%d", frame->ms );
+		for ( j = 0; j < paddles; j++ ) {
+			in = &frame->input[j];
+			fprintf( file, " %d %a %a %d %d", in->x, in->cur_x, in->v_x,
+					in->invis_delay, in->buttons );
+		}
+		fprintf( file, " %llx %016llx\n", frame->rand_state, frame->hash );
+	}
+	fclose( file );
+	return 1;
+}
+Replay *replay_load( const char *fname )
+{
+	Replay *replay = salloc( 1, sizeof( Replay ) );
+	ReplayFrame *frame;
+	ReplayInput *in;
+	char buf[256];
+	FILE *file;
+	int i, j, paddles;
+
+	if ( ( file = fopen( fname, "r" ) ) == 0 ) {
+		fprintf( stderr, "couldn't open %s\n", fname );
+		free( replay );
+		return 0;
+	}
+	if ( !read_line( file, buf, sizeof( buf ) ) || strcmp( buf, REPLAY_MAGIC ) ||
+			!read_line( file, buf, sizeof( buf ) ) ||
+			sscanf( buf, "%d %d %d %llx %d %d %d %d %d %d %d %d %a %d %d %d",
+				&replay->game_type, &replay->diff, &replay->rel_warp_limit,
+				&replay->seed, &replay->local_server, &replay->convex,
+				&replay->return_by_click, &replay->random_angle,
+				&replay->bcc_type, &replay->fixed_physics,
+				&replay->auto_speedup,
+				&replay->frag_limit, &replay->accelerated_ball_speed,
+				&replay->score[0], &replay->score[1],
+				&replay->level.type ) != 16 ||
+			replay->diff < 0 || replay->diff >= DIFF_COUNT )
+		goto failure;
+	if ( !read_line( file, replay->level.author, sizeof( replay->level.author ) ) ||
+			!read_line( file, replay->level.name, sizeof( replay->level.name ) ) )
+		goto failure;
+	for ( j = 0; j < 2 * EDIT_HEIGHT; j++ ) {
+		if ( !read_line( file, buf, sizeof( buf ) ) || strlen( buf ) != EDIT_WIDTH )
+			goto failure;
+		for ( i = 0; i < EDIT_WIDTH; i++ )
+			if ( j < EDIT_HEIGHT )
+				replay->level.bricks[i][j] = buf[i];
+			else
+				replay->level.extras[i][j - EDIT_HEIGHT] = buf[i];
+	}
+	level_update_hash( &replay->level );
+	level_count_bricks( &replay->level );
+
+	if ( fscanf( file, "%d", &replay->count ) != 1 || replay->count < 0 )
+		goto failure;
+	replay->size = replay->count;
+	replay->frames = salloc( replay->count + 1, sizeof( ReplayFrame ) );
+	paddles = ( replay->game_type == GT_NETWORK ) ? 2 : 1;
+	for ( i = 0; i < replay->count; i++ ) {
+		frame = &replay->frames[i];
+		if ( fscanf( file, "%d", &frame->ms ) != 1 )
+			goto failure;
+		for ( j = 0; j < paddles; j++ ) {
+			in = &frame->input[j];
+			if ( fscanf( file, "%d %a %a %d %d", &in->x, &in->cur_x,
+					&in->v_x, &in->invis_delay, &in->buttons ) != 5 )
+				goto failure;
+		}
+		if ( fscanf( file, "%llx %llx", &frame->rand_state, &frame->hash ) != 2 )
+			goto failure;
+	}
+	fclose( file );
+	return replay;
+failure:
+	fprintf( stderr, "%s: invalid replay\n", fname );
+	fclose( file );
+	replay_delete( &replay );
+	return 0;
+}
+
+/* play recording in a private game context and return the index of the
+ * first frame with a different state hash or -1 if all are equal. */
+int replay_check( Replay *replay )
+{
+	Game *old = cur_game, *game;
+	Level level = replay->level;
+	ReplayFrame *frame;
+	int i, j, result = -1;
+
+	if ( ( game = game_create( replay->game_type, replay->diff,
+					replay->rel_warp_limit ) ) == 0 )
+		return 0;
+	game->localServerGame = replay->local_server;
+	game_set_current( game );
+	game->rand_state = replay->seed;
+	game_init( game, &level );
+	replay_set_settings( replay, game );
+
+	for ( i = 0; i < replay->count; i++ ) {
+		frame = &replay->frames[i];
+		for ( j = 0; j < game->paddle_count; j++ )
+			replay_set_input( &frame->input[j], game->paddles[j] );
+		game->rand_state = frame->rand_state;
+		game_reset_mods();
+		game_update( frame->ms );
+		if ( game_get_hash( game ) != frame->hash ) {
+			result = i;
+			break;
+		}
+	}
+
+	game_finalize( game );
+	game_delete( &game );
+	game_set_current( old );
+	return result;
+}
@@ -0,0 +1,84 @@
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef __REPLAY_H
+#define __REPLAY_H
+
+/***** INCLUDES ************************************************************/
+
+#include "game.h"
+
+/***** TYPE DEFINITIONS ****************************************************/
+
+enum {
+	/* ReplayInput::buttons */
+	REPLAY_FIRE_LEFT = 1,
+	REPLAY_FIRE_RIGHT = 2,
+	REPLAY_RETURN = 4, /* ball_return_key_pressed */
+	REPLAY_SPEEDUP = 8, /* maxballspeed_request */
+	REPLAY_SPEEDUP_OLD = 16 /* maxballspeed_request_old */
+};
+
+/* state of a paddle as set by client or bot before game_update() */
+typedef struct {
+	int	x;
+	float	cur_x, v_x;
+	int	invis_delay; 	/* reset on movement */
+	int	buttons;
+} ReplayInput;
+
+/* one game_update() */
+typedef struct {
+	int	ms;
+	ReplayInput input[2]; 	/* per paddle */
+	unsigned long long rand_state; /* before update as bot uses it, too */
+	unsigned long long hash; /* game_get_hash() after update */
+} ReplayFrame;
+
+/* recording of one level from game_init() on. settings and scores
+ * are taken at the first frame as they are set after game_init(). */
+typedef struct {
+	Level	level;
+	int	game_type, diff, rel_warp_limit;
+	unsigned long long seed; /* random state before game_init() */
+	int	local_server, convex, return_by_click, random_angle;
+	int	bcc_type, fixed_physics, auto_speedup, frag_limit;
+	float	accelerated_ball_speed;
+	int	score[2];
+	ReplayFrame *frames;
+	int	count, size;
+} Replay;
+
+/***** PUBLIC FUNCTIONS ****************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* start recording 'game'. call right before game_init( game, level ). */
+Replay *replay_create( Game *game, Level *level );
+void replay_delete( Replay **replay );
+
+/* record the paddle state of the current game, call game_update( ms )
+ * and record the hash of the new state. replaces game_update() while
+ * recording. */
+void replay_update( Replay *replay, int ms );
+
+int replay_save( Replay *replay, const char *fname );
+Replay *replay_load( const char *fname );
+
+/* play recording in a private game context and return the index of the
+ * first frame with a different state hash or -1 if all are equal. */
+int replay_check( Replay *replay );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
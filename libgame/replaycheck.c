@@ -0,0 +1,120 @@
+/***************************************************************************
+                          replaycheck.c  -  determinism check
+                             -------------------
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/* Replay recordings and report the first frame where the game state
+ * differs from the recorded one. Recordings are saved by the game (see
+ * option record_replay) or created here by letting the autopilot play
+ * a level (-r, with fixed point physics if -f is given), e.g. record
+ * with one build and check with another:
+ *   replaycheck -r test.rpl -s 7 LBreakoutHD 12
+ *   replaycheck test.rpl */
+
+#include <unistd.h>
+#include "replay.h"
+#include "sim.h"
+
+/* let bot play 'level' until it is over or time is up */
+static Replay *record( Level *level, SimConfig *cfg, unsigned int seed, int fixed )
+{
+	Game *game;
+	Bot *bot;
+	Replay *replay;
+
+	if ( ( game = game_create( GT_LOCAL, cfg->diff, cfg->rel_warp_limit ) ) == 0 )
+		return 0;
+	game->localServerGame = 1;
+	game_set_current( game );
+	game_set_seed( game, seed );
+	replay = replay_create( game, level );
+	game_init( game, level );
+	game_set_fixed_physics( fixed );
+	bot = bot_create( cfg->skill );
+	while ( !game->level_over && game->time < cfg->max_time ) {
+		bot_update( bot, 0, cfg->step );
+		game_reset_mods();
+		replay_update( replay, cfg->step );
+	}
+	bot_delete( &bot );
+	game_finalize( game );
+	game_delete( &game );
+	game_set_current( 0 );
+	return replay;
+}
+
+int main( int argc, char **argv )
+{
+	SimConfig cfg;
+	LevelSet *set;
+	Replay *replay;
+	char *rname = 0;
+	int c, i, frame, time, seed = 0, level = 1, fixed = 0, failed = 0;
+
+	sim_config_default( &cfg );
+	cfg.max_time = 300000;
+	while ( ( c = getopt( argc, argv, "r:s:b:d:t:f" ) ) != -1 ) {
+		switch ( c ) {
+			case 'r': rname = optarg; break;
+			case 's': seed = atoi( optarg ); break;
+			case 'b': cfg.skill = atoi( optarg ); break;
+			case 'd': cfg.diff = atoi( optarg ); break;
+			case 't': cfg.max_time = atoi( optarg ) * 1000; break;
+			case 'f': fixed = 1; break;
+			default: optind = argc; break;
+		}
+	}
+	if ( optind >= argc || cfg.skill < 0 || cfg.skill >= BOT_SKILL_COUNT ||
+			cfg.diff < 0 || cfg.diff >= DIFF_COUNT ) {
+		fprintf( stderr, "Usage: %s FILE...\n"
+				"       %s -r FILE [-s seed] [-b bot skill 0-2] "
+				"[-d diff 0-4] [-t max secs] [-f] SET [LEVEL]\n",
+				argv[0], argv[0] );
+		return 1;
+	}
+
+	if ( rname ) {
+		if ( optind + 1 < argc )
+			level = atoi( argv[optind + 1] );
+		if ( ( set = levelset_load( argv[optind], 0 ) ) == 0 )
+			return 1;
+		if ( level < 1 || level > set->count ) {
+			fprintf( stderr, "%s has no level %d\n", set->name, level );
+			return 1;
+		}
+		replay = record( set->levels[level - 1], &cfg, seed, fixed );
+		if ( replay == 0 || !replay_save( replay, rname ) )
+			return 1;
+		printf( "%s: %d frames\n", rname, replay->count );
+		replay_delete( &replay );
+		levelset_delete( &set );
+		return 0;
+	}
+
+	for ( i = optind; i < argc; i++ ) {
+		if ( ( replay = replay_load( argv[i] ) ) == 0 ) {
+			failed++;
+			continue;
+		}
+		if ( ( frame = replay_check( replay ) ) == -1 )
+			printf( "%s: %d frames ok\n", argv[i], replay->count );
+		else {
+			for ( c = 0, time = 0; c <= frame; c++ )
+				time += replay->frames[c].ms;
+			printf( "%s: differs at frame %d (%.3fs)\n",
+					argv[i], frame, time / 1000.0 );
+			failed++;
+		}
+		replay_delete( &replay );
+	}
+	return failed > 0;
+}
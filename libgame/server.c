@@ -0,0 +1,319 @@
+/***************************************************************************
+                          server.c  -  description
+                             -------------------
+    begin                : 2026/10/19
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/* Dedicated server hosting many two player matches on consecutive
+ * ports. All matches are updated at a fixed tick rate on a work
+ * stealing thread pool. Every few seconds the time of a match update
+ * and the CPU use is reported to see how many matches a core can
+ * host. A match is restarted a second after its level is over. With
+ * -l each match gets two autopilot players over loopback, e.g.:
+ *   lbreakouthd-server -m 200 -l -t 60
+ *   lbreakouthd-server -m 4 LBreakoutHD 3 & netplay -c localhost -p 8002 */
+
+#include <unistd.h>
+#include <signal.h>
+#include "netgame.h"
+#include "pool.h"
+#include "bot.h"
+
+/***** LOCAL TYPE DEFINITIONS **********************************************/
+
+typedef struct {
+	Uint64	time, max; 	/* of updates with both players */
+	int	count;
+} TickStats;
+
+typedef struct {
+	NetServer *server;
+	int	port;
+	int	over_time; 	/* ms since level is over */
+	int	games; 		/* finished levels */
+	TickStats stats, total; /* since last report and since start */
+	NetClient *clients[2]; 	/* loopback players or 0 */
+	Bot	*bots[2];
+} Match;
+
+typedef struct {
+	Match	*matches;
+	int	count;
+	int	tick; 		/* ms */
+	int	skill; 		/* of loopback players */
+	int	loopback;
+	int	verbose;
+} Server;
+
+/***** LOCAL VARIABLES *****************************************************/
+
+static volatile sig_atomic_t quit = 0;
+
+/***** LOCAL FUNCTIONS *****************************************************/
+
+static void handle_signal( int sig )
+{
+	quit = 1;
+}
+
+static void tick_stats_add( TickStats *stats, Uint64 time )
+{
+	stats->time += time;
+	if ( time > stats->max )
+		stats->max = time;
+	stats->count++;
+}
+
+static double us( Uint64 time )
+{
+	return time * 1000000.0 / SDL_GetPerformanceFrequency();
+}
+
+static void match_connect( Server *srv, Match *match )
+{
+	int i;
+
+	for ( i = 0; i < 2; i++ ) {
+		if ( ( match->clients[i] = net_client_create( "localhost", match->port ) ) )
+			match->clients[i]->verbose = srv->verbose;
+		match->bots[i] = bot_create( srv->skill );
+	}
+}
+static void match_disconnect( Match *match )
+{
+	int i;
+
+	for ( i = 0; i < 2; i++ ) {
+		net_client_delete( &match->clients[i] );
+		bot_delete( &match->bots[i] );
+	}
+}
+
+/* let bot control own paddle of mirror game and send its input */
+static void client_update( NetClient *client, Bot *bot, int ms )
+{
+	Paddle *paddle;
+	int x = 0, buttons = 0;
+
+	if ( client == 0 )
+		return;
+	if ( client->game && client->status == NET_CLIENT_PLAYING ) {
+		game_set_current( client->game );
+		bot_update( bot, client->paddle, ms );
+		paddle = client->game->paddles[client->paddle];
+		x = paddle->x;
+		if ( paddle->fire_left ) buttons |= NET_FIRE_LEFT;
+		if ( paddle->fire_right ) buttons |= NET_FIRE_RIGHT;
+	}
+	net_client_update( client, ms, x, buttons );
+}
+
+/* pool job: the first count indices are the matches, the next count
+ * are their loopback players which are not timed */
+static void server_job( void *data, int index )
+{
+	Server *srv = data;
+	Match *match = &srv->matches[index % srv->count];
+	Uint64 start;
+
+	if ( index >= srv->count ) {
+		client_update( match->clients[0], match->bots[0], srv->tick );
+		client_update( match->clients[1], match->bots[1], srv->tick );
+		return;
+	}
+	start = SDL_GetPerformanceCounter();
+	if ( net_server_update( match->server, srv->tick ) == 2 ) {
+		start = SDL_GetPerformanceCounter() - start;
+		tick_stats_add( &match->stats, start );
+		tick_stats_add( &match->total, start );
+	}
+}
+
+/* restart matches that are over, done by main thread between ticks as
+ * creating games is not thread safe */
+static void server_restart_matches( Server *srv )
+{
+	Match *match;
+	int i;
+
+	for ( i = 0; i < srv->count; i++ ) {
+		match = &srv->matches[i];
+		if ( !match->server->game->level_over )
+			continue;
+		if ( ( match->over_time += srv->tick ) < 1000 )
+			continue;
+		match->over_time = 0;
+		match->games++;
+		if ( srv->loopback )
+			match_disconnect( match );
+		net_server_restart( match->server );
+		if ( srv->loopback )
+			match_connect( srv, match );
+	}
+}
+
+static void server_report( Server *srv, Pool *pool, int secs, int ticks, int late,
+		Uint64 busy, double cpu )
+{
+	TickStats all;
+	Match *match;
+	int i, playing = 0, games = 0;
+	double avg = 0, capacity = 0;
+
+	memset( &all, 0, sizeof( all ) );
+	for ( i = 0; i < srv->count; i++ ) {
+		match = &srv->matches[i];
+		if ( match->server->client_count == 2 )
+			playing++;
+		games += match->games;
+		all.time += match->stats.time;
+		all.count += match->stats.count;
+		if ( match->stats.max > all.max )
+			all.max = match->stats.max;
+		memset( &match->stats, 0, sizeof( TickStats ) );
+	}
+	if ( all.count > 0 ) {
+		avg = us( all.time ) / all.count;
+		capacity = srv->tick * 1000.0 / avg;
+	}
+	printf( "%ds: %d matches, %d playing, %d finished, %d ticks (%d late), "
+			"steals %d\n", secs, srv->count, playing, games, ticks, late,
+			SDL_AtomicGet( &pool->steals ) );
+	printf( "  match update avg %.1f us, max %.1f us; all matches %.2f ms per %d ms tick; "
+			"cpu %.0f%% of one core; ~%.0f matches per core\n",
+			avg, us( all.max ), ticks ? us( busy ) / ticks / 1000 : 0,
+			srv->tick, cpu, capacity );
+	fflush( stdout );
+}
+
+int main( int argc, char **argv )
+{
+	NetSettings settings;
+	Server srv;
+	Match *match;
+	Pool *pool;
+	LevelSet *set;
+	Level *level;
+	Uint64 start, busy = 0;
+	clock_t cpu = clock();
+	unsigned int now, next, last_report;
+	int c, i, count = 1, port = NET_DEFAULT_PORT, threads = 0, rate = 100;
+	int interval = 5, duration = 0, id = 1;
+	int time = 0, ticks = 0, late = 0;
+
+	memset( &srv, 0, sizeof( srv ) );
+	srv.skill = BOT_HARD;
+	net_settings_default( &settings );
+	while ( ( c = getopt( argc, argv, "m:p:j:r:i:t:lb:d:fv" ) ) != -1 ) {
+		switch ( c ) {
+			case 'm': count = atoi( optarg ); break;
+			case 'p': port = atoi( optarg ); break;
+			case 'j': threads = atoi( optarg ); break;
+			case 'r': rate = atoi( optarg ); break;
+			case 'i': interval = atoi( optarg ); break;
+			case 't': duration = atoi( optarg ); break;
+			case 'l': srv.loopback = 1; break;
+			case 'b': srv.skill = atoi( optarg ); break;
+			case 'd': settings.diff = atoi( optarg ); break;
+			case 'f': settings.fixed_physics = 1; break;
+			case 'v': srv.verbose = 1; break;
+			default: optind = argc + 1; break;
+		}
+	}
+	if ( optind > argc || count < 1 || rate < 1 || rate > 1000 || interval < 1 ||
+			srv.skill < 0 || srv.skill >= BOT_SKILL_COUNT ||
+			settings.diff < 0 || settings.diff >= NET_DIFF_COUNT ) {
+		fprintf( stderr, "Usage: %s [-m matches] [-p first port] [-j threads] "
+				"[-r ticks per sec] [-i report secs] [-t run secs] [-l] "
+				"[-b bot skill 0-2] [-d diff 0-2] [-f] [-v] [SET [LEVEL]]\n",
+				argv[0] );
+		return 1;
+	}
+	srv.tick = 1000 / rate;
+	srv.count = count;
+
+	/* same level for all matches, empty one is PINGPONG */
+	if ( optind < argc ) {
+		if ( optind + 1 < argc )
+			id = atoi( argv[optind + 1] );
+		if ( ( set = levelset_load( argv[optind], 0 ) ) == 0 )
+			return 1;
+		if ( id < 1 || id > set->count ) {
+			fprintf( stderr, "%s has no level %d\n", set->name, id );
+			return 1;
+		}
+	} else
+		set = levelset_create_empty( 1, "server", "PingPong" );
+	level = set->levels[id - 1];
+
+	srv.matches = salloc( count, sizeof( Match ) );
+	for ( i = 0; i < count; i++ ) {
+		match = &srv.matches[i];
+		match->port = port + i;
+		if ( ( match->server = net_server_create( match->port, level, &settings ) ) == 0 )
+			return 1;
+		match->server->verbose = srv.verbose;
+		if ( srv.loopback )
+			match_connect( &srv, match );
+	}
+	pool = pool_create( threads );
+	printf( "%d matches of '%s' on ports %d-%d, %d threads, %d ms ticks\n",
+			count, level->name, port, port + count - 1, pool->threads, srv.tick );
+	fflush( stdout );
+
+	signal( SIGINT, handle_signal );
+	signal( SIGTERM, handle_signal );
+	next = last_report = SDL_GetTicks();
+	while ( !quit && ( duration == 0 || time < duration * 1000 ) ) {
+		start = SDL_GetPerformanceCounter();
+		pool_run( pool, srv.loopback ? 2 * count : count, server_job, &srv );
+		busy += SDL_GetPerformanceCounter() - start;
+		server_restart_matches( &srv );
+		ticks++;
+		time += srv.tick;
+
+		now = SDL_GetTicks();
+		if ( now - last_report >= interval * 1000 ) {
+			server_report( &srv, pool, time / 1000, ticks, late, busy,
+					100.0 * ( clock() - cpu ) / CLOCKS_PER_SEC * 1000 / ( now - last_report ) );
+			busy = 0;
+			ticks = late = 0;
+			cpu = clock();
+			last_report = now;
+		}
+
+		/* fixed tick rate, don't try to catch up when overloaded */
+		next += srv.tick;
+		if ( (int)( next - now ) > 0 )
+			SDL_Delay( next - now );
+		else {
+			late++;
+			next = now;
+		}
+	}
+
+	printf( "match   port  games  score  updates   avg us   max us\n" );
+	for ( i = 0; i < count; i++ ) {
+		match = &srv.matches[i];
+		printf( "%5d  %5d  %5d  %2d:%-2d  %7d  %7.1f  %7.1f\n", i + 1, match->port,
+				match->games, match->server->game->paddles[0]->score,
+				match->server->game->paddles[1]->score, match->total.count,
+				match->total.count ? us( match->total.time ) / match->total.count : 0,
+				us( match->total.max ) );
+		match_disconnect( match );
+		net_server_delete( &match->server );
+	}
+	pool_delete( &pool );
+	free( srv.matches );
+	levelset_delete( &set );
+	return 0;
+}
@@ -23,9 +23,9 @@
 int shot_w = 10;
 int shot_h = 10;
 float shot_v_y = 0.2;
-extern Game *cur_game;
+extern GAME_TLS Game *cur_game;
 
-int last_shot_fire_x = -1; /* HACK: used to play local sound */
+GAME_TLS int last_shot_fire_x = -1; /* HACK: used to play local sound */
 
 /*
 ====================================================================
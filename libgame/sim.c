@@ -0,0 +1,160 @@
+/***************************************************************************
+                          sim.c  -  description
+                             -------------------
+    begin                : 2026/10/19
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/***** INCLUDES ************************************************************/
+
+#include <SDL2/SDL.h>
+#include "sim.h"
+
+/***** EXTERNAL VARIABLES **************************************************/
+
+extern GAME_TLS Game *cur_game;
+
+/***** LOCAL TYPE DEFINITIONS **********************************************/
+
+/* shared by all workers of sim_run() */
+typedef struct {
+	SimJob		*jobs;
+	int		count;
+	SimConfig	*cfg;
+	SDL_atomic_t	next; 	/* index of next job to be taken */
+	SDL_atomic_t	*cancel; /* no more jobs are taken if set, may be NULL */
+} SimBatch;
+
+/***** LOCAL FUNCTIONS *****************************************************/
+
+/* take jobs until none are left. jobs are small compared to the
+ * batch so there is no need to balance them any further. */
+static int sim_worker( void *data )
+{
+	SimBatch *batch = data;
+	SimJob *job;
+	int i;
+
+	while ( ( i = SDL_AtomicAdd( &batch->next, 1 ) ) < batch->count ) {
+		if ( batch->cancel && SDL_AtomicGet( batch->cancel ) )
+			break;
+		job = &batch->jobs[i];
+		sim_play( job->level, batch->cfg, job->seed, &job->result );
+	}
+	return 0;
+}
+
+/***** PUBLIC FUNCTIONS ****************************************************/
+
+/* defaults: hard bot, medium difficulty, 10 minutes at 10 ms steps */
+void sim_config_default( SimConfig *cfg )
+{
+	cfg->skill = BOT_HARD;
+	cfg->diff = 2; /* medium as in default config */
+	cfg->rel_warp_limit = 80; /* as in default config */
+	cfg->max_time = 600000;
+	cfg->step = 10;
+}
+
+/* play a single attempt on 'level' in a private game context. the
+ * result only depends on level, config and seed. can be called in
+ * parallel from different threads. the current game of the calling
+ * thread is restored when done. */
+void sim_play( Level *level, SimConfig *cfg, unsigned int seed, SimResult *result )
+{
+	Game *old = cur_game, *game;
+	Bot *bot;
+	Level snapshot = *level;
+
+	memset( result, 0, sizeof( SimResult ) );
+	result->warp_time = -1;
+
+	if ( ( game = game_create( GT_LOCAL, cfg->diff, cfg->rel_warp_limit ) ) == 0 )
+		return;
+	game->localServerGame = 1; /* for special levels */
+	game_set_current( game );
+	game_set_seed( game, seed );
+	game_init( game, &snapshot );
+	result->brick_count = game->brick_count;
+	bot = bot_create( cfg->skill );
+
+	while ( game->time < cfg->max_time ) {
+		bot_update( bot, 0, cfg->step );
+		game_update( cfg->step );
+		game_reset_mods();
+		if ( result->warp_time == -1 && game->bricks_left < game->warp_limit )
+			result->warp_time = game->time;
+		if ( !game->level_over )
+			continue;
+		if ( game->winner == PADDLE_BOTTOM || game->level_type != LT_NORMAL ) {
+			result->cleared = 1;
+			break;
+		}
+		/* restart with remaining bricks like a player losing a life */
+		result->balls_lost++;
+		result->score += game->paddles[0]->score;
+		game_get_level_snapshot( &snapshot );
+		game_finalize( game );
+		game_init( game, &snapshot );
+	}
+
+	result->time = game->time;
+	result->bricks_left = game->bricks_left;
+	result->score += game->paddles[0]->score;
+
+	bot_delete( &bot );
+	game_finalize( game );
+	game_delete( &game );
+	game_set_current( old );
+}
+
+/* play all jobs on 'threads' worker threads (0 for one per CPU core)
+ * and return when all are done. if 'cancel' (may be NULL) is set by
+ * another thread, remaining jobs are skipped and 0 is returned. */
+int sim_run( SimJob *jobs, int count, SimConfig *cfg, int threads,
+		SDL_atomic_t *cancel )
+{
+	SimBatch batch;
+	SDL_Thread **workers;
+	int i;
+
+	if ( threads <= 0 )
+		threads = SDL_GetCPUCount();
+	if ( threads > count )
+		threads = count;
+
+	batch.jobs = jobs;
+	batch.count = count;
+	batch.cfg = cfg;
+	batch.cancel = cancel;
+	SDL_AtomicSet( &batch.next, 0 );
+	if ( threads <= 1 ) {
+		sim_worker( &batch );
+		return ( cancel && SDL_AtomicGet( cancel ) ) ? 0 : count;
+	}
+
+	/* shared tables must be ready before games are created in parallel */
+	init_angles();
+
+	/* calling thread is the last worker so if no thread could be
+	 * created it simply does all jobs */
+	threads--;
+	workers = salloc( threads, sizeof( SDL_Thread* ) );
+	for ( i = 0; i < threads; i++ )
+		if ( ( workers[i] = SDL_CreateThread( sim_worker, "sim", &batch ) ) == 0 )
+			fprintf( stderr, "couldn't create thread: %s\n", SDL_GetError() );
+	sim_worker( &batch );
+	for ( i = 0; i < threads; i++ )
+		if ( workers[i] )
+			SDL_WaitThread( workers[i], 0 );
+	free( workers );
+	return ( cancel && SDL_AtomicGet( cancel ) ) ? 0 : count;
+}
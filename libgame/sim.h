@@ -0,0 +1,73 @@
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef __SIM_H
+#define __SIM_H
+
+/***** INCLUDES ************************************************************/
+
+#include <SDL2/SDL.h>
+#include "bot.h"
+
+/***** TYPE DEFINITIONS ****************************************************/
+
+/* how levels are played by the simulation */
+typedef struct {
+	int	skill; 		/* BOT_EASY to BOT_HARD */
+	int	diff; 		/* difficulty of game_create() */
+	int	rel_warp_limit; /* percent of bricks to clear before warp */
+	int	max_time; 	/* give up after ms of game time */
+	int	step; 		/* ms per game_update() */
+} SimConfig;
+
+/* outcome of one attempt on a level. the bot continues with the
+ * current bricks after losing all balls just like a player with
+ * infinite lives, until the level is cleared or time is up. */
+typedef struct {
+	int	cleared;
+	int	time; 		/* game time in ms until cleared or given up */
+	int	balls_lost;
+	int	bricks_left;
+	int	brick_count;
+	int	warp_time; 	/* ms until warp was possible or -1 */
+	int	score;
+} SimResult;
+
+/* one attempt of a batch for sim_run() */
+typedef struct {
+	Level	*level; 	/* read only, may be shared by jobs */
+	unsigned int seed;
+	SimResult result;
+} SimJob;
+
+/***** PUBLIC FUNCTIONS ****************************************************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* defaults: hard bot, medium difficulty, 10 minutes at 10 ms steps */
+void sim_config_default( SimConfig *cfg );
+
+/* play a single attempt on 'level' in a private game context. the
+ * result only depends on level, config and seed. can be called in
+ * parallel from different threads. */
+void sim_play( Level *level, SimConfig *cfg, unsigned int seed, SimResult *result );
+
+/* play all jobs on 'threads' worker threads (0 for one per CPU core)
+ * and return when all are done. if 'cancel' (may be NULL) is set by
+ * another thread, remaining jobs are skipped and 0 is returned. */
+int sim_run( SimJob *jobs, int count, SimConfig *cfg, int threads,
+		SDL_atomic_t *cancel );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,129 @@
+/***************************************************************************
+                          simrun.c  -  batch level simulation
+                             -------------------
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/* Let the autopilot play all levels of the given sets a number of times
+ * on all CPU cores and print clear rate, median clear time and lost balls
+ * per level. Results are reproducible by seed regardless of the number of
+ * threads (e.g. simrun -n 20 -j 8 LBreakoutHD). */
+
+#include <unistd.h>
+#include <SDL2/SDL.h>
+#include "sim.h"
+
+static int compare_int( const void *a, const void *b )
+{
+	return *(const int*)a - *(const int*)b;
+}
+
+int main( int argc, char **argv )
+{
+	SimConfig cfg;
+	SimJob *jobs;
+	LevelSet **sets;
+	Level *level;
+	int *times;
+	int threads = 0, attempts = 10, seed = 0;
+	int c, i, j, k, count = 0, set_count, cleared, lost;
+	int total_cleared = 0;
+	Uint32 start, ms;
+
+	sim_config_default( &cfg );
+	while ( ( c = getopt( argc, argv, "j:n:s:b:d:t:" ) ) != -1 ) {
+		switch ( c ) {
+			case 'j': threads = atoi( optarg ); break;
+			case 'n': attempts = atoi( optarg ); break;
+			case 's': seed = atoi( optarg ); break;
+			case 'b': cfg.skill = atoi( optarg ); break;
+			case 'd': cfg.diff = atoi( optarg ); break;
+			case 't': cfg.max_time = atoi( optarg ) * 1000; break;
+			default: optind = argc; break;
+		}
+	}
+	if ( optind >= argc || attempts < 1 ||
+			cfg.skill < 0 || cfg.skill >= BOT_SKILL_COUNT ||
+			cfg.diff < 0 || cfg.diff >= DIFF_COUNT ) {
+		fprintf( stderr, "Usage: %s [-j threads] [-n attempts] [-s seed] "
+				"[-b bot skill 0-2] [-d diff 0-4] [-t max secs] SET...\n",
+				argv[0] );
+		return 1;
+	}
+
+	/* bonus levels have no regular end so only normal levels are played */
+	set_count = argc - optind;
+	sets = salloc( set_count, sizeof( LevelSet* ) );
+	for ( i = 0; i < set_count; i++ ) {
+		if ( ( sets[i] = levelset_load( argv[optind + i], 0 ) ) == 0 )
+			continue;
+		for ( j = 0; j < sets[i]->count; j++ )
+			if ( sets[i]->levels[j]->type == LT_NORMAL )
+				count += attempts;
+	}
+	if ( count == 0 ) {
+		fprintf( stderr, "no levels to play\n" );
+		return 1;
+	}
+
+	jobs = salloc( count, sizeof( SimJob ) );
+	count = 0;
+	for ( i = 0; i < set_count; i++ ) {
+		if ( sets[i] == 0 )
+			continue;
+		for ( j = 0; j < sets[i]->count; j++ ) {
+			if ( sets[i]->levels[j]->type != LT_NORMAL )
+				continue;
+			for ( k = 0; k < attempts; k++ ) {
+				jobs[count].level = sets[i]->levels[j];
+				jobs[count].seed = seed + k;
+				count++;
+			}
+		}
+	}
+
+	start = SDL_GetTicks();
+	sim_run( jobs, count, &cfg, threads, 0 );
+	ms = SDL_GetTicks() - start;
+
+	/* jobs of a level are consecutive */
+	times = salloc( attempts, sizeof( int ) );
+	for ( i = 0; i < count; i += attempts ) {
+		level = jobs[i].level;
+		cleared = lost = 0;
+		for ( k = 0; k < attempts; k++ ) {
+			SimResult *r = &jobs[i + k].result;
+			/* failed attempts count as slowest */
+			times[k] = r->cleared ? r->time : cfg.max_time + 1;
+			cleared += r->cleared;
+			lost += r->balls_lost;
+		}
+		qsort( times, attempts, sizeof( int ), compare_int );
+		total_cleared += cleared;
+		printf( "%-24s %3d%% cleared, median ", level->name, 100 * cleared / attempts );
+		if ( times[attempts / 2] > cfg.max_time )
+			printf( "   -   " );
+		else
+			printf( "%6.1fs", times[attempts / 2] / 1000.0 );
+		printf( ", %5.1f balls lost\n", (float)lost / attempts );
+	}
+	printf( "%d attempts, %d%% cleared, %.1fs (%.0f attempts/min)\n",
+			count, 100 * total_cleared / count, ms / 1000.0,
+			ms ? 60000.0 * count / ms : 0 );
+
+	free( times );
+	free( jobs );
+	for ( i = 0; i < set_count; i++ )
+		if ( sets[i] )
+			levelset_delete( &sets[i] );
+	free( sets );
+	return 0;
+}
@@ -364,6 +364,19 @@ void *salloc( int num, int size )
 	return ptr;
 }
 
+/* FNV-1a hash of data continued from h (14695981039346656037ULL
+ * for a new hash) */
+unsigned long long hash_data( const void *data, size_t size, unsigned long long h )
+{
+	const unsigned char *p = data;
+	size_t i;
+	for ( i = 0; i < size; i++ ) {
+		h ^= p[i];
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
 /* print contents of pointer raw */
 void print_raw( int len, char *buf )
 {
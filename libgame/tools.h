@@ -119,6 +119,10 @@ void parse_version( char *string, int *version, int *update );
 /* allocate memory or exit with error if out of it */
 void *salloc( int num, int size );
 
+/* FNV-1a hash of data continued from h (14695981039346656037ULL
+ * for a new hash) */
+unsigned long long hash_data( const void *data, size_t size, unsigned long long h );
+
 /* print contents of pointer raw */
 void print_raw( int len, char *buf );
 
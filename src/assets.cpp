@@ -0,0 +1,374 @@
+/*
+ * assets.cpp
+ */
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "tools.h"
+#include "sdl.h"
+#include "assets.h"
+
+/** Queue file for decoding. Has no effect once workers are started. */
+void AssetLoader::add(const string &fname, int type)
+{
+	if (!threads.empty()) {
+		_logerr("AssetLoader: cannot queue %s while decoding\n",fname.c_str());
+		return;
+	}
+	AssetJob job = { fname, type, NULL, NULL, false, false };
+	jobs.push_back(job);
+}
+
+/** Start worker threads, one per CPU but no more than jobs queued. */
+void AssetLoader::start()
+{
+	if (!threads.empty() || nextJob >= jobs.size())
+		return;
+
+	/* image loaders are initialized lazily which is not thread safe */
+	IMG_Init(IMG_INIT_PNG | IMG_INIT_JPG);
+
+	mutex = SDL_CreateMutex();
+	cond = SDL_CreateCond();
+	if (mutex == NULL || cond == NULL) {
+		_logsdlerr();
+		return; /* take*() will decode synchronously */
+	}
+
+	int num = SDL_GetCPUCount();
+	if (num > AL_MAXTHREADS)
+		num = AL_MAXTHREADS;
+	if (num > (int)jobs.size())
+		num = jobs.size();
+	for (int i = 0; i < num; i++) {
+		SDL_Thread *t = SDL_CreateThread(worker, "assets", this);
+		if (t == NULL) {
+			_logsdlerr();
+			break;
+		}
+		threads.push_back(t);
+	}
+	_logdebug(1,"AssetLoader: decoding %d files with %d threads\n",
+					(int)jobs.size(),(int)threads.size());
+}
+
+/** Pick next undecoded job until none is left. */
+int AssetLoader::worker(void *data)
+{
+	AssetLoader *al = (AssetLoader*)data;
+
+	while (1) {
+		SDL_LockMutex(al->mutex);
+		if (al->nextJob >= al->jobs.size()) {
+			SDL_UnlockMutex(al->mutex);
+			break;
+		}
+		AssetJob &job = al->jobs[al->nextJob++];
+		SDL_UnlockMutex(al->mutex);
+
+		al->decode(job);
+
+		SDL_LockMutex(al->mutex);
+		job.done = true;
+		SDL_CondBroadcast(al->cond);
+		SDL_UnlockMutex(al->mutex);
+	}
+	return 0;
+}
+
+/** Decode file of job. Errors are logged when result is taken. */
+void AssetLoader::decode(AssetJob &job)
+{
+	if (job.type == AL_IMAGE)
+		job.surf = IMG_Load(job.fname.c_str());
+	else
+		job.chunk = Mix_LoadWAV(job.fname.c_str());
+}
+
+/** Return index of first job for file not yet taken or -1. Wait until
+ * it is decoded. Only called from the thread that owns the loader. */
+int AssetLoader::find(const string &fname, int type)
+{
+	int id = -1;
+	for (uint i = 0; i < jobs.size(); i++)
+		if (!jobs[i].taken && jobs[i].type == type && jobs[i].fname == fname) {
+			id = i;
+			break;
+		}
+	if (id == -1)
+		return -1;
+
+	if (threads.empty()) {
+		/* workers not running, decode here */
+		if (!jobs[id].done) {
+			decode(jobs[id]);
+			jobs[id].done = true;
+		}
+	} else {
+		SDL_LockMutex(mutex);
+		while (!jobs[id].done)
+			SDL_CondWait(cond, mutex);
+		SDL_UnlockMutex(mutex);
+	}
+	jobs[id].taken = true;
+	return id;
+}
+
+/** Get decoded image (owned by caller) or NULL on error. */
+SDL_Surface *AssetLoader::takeSurface(const string &fname)
+{
+	SDL_Surface *surf;
+	int id = find(fname, AL_IMAGE);
+
+	if (id == -1)
+		surf = IMG_Load(fname.c_str());
+	else {
+		surf = jobs[id].surf;
+		jobs[id].surf = NULL;
+	}
+	if (surf == NULL)
+		_logerr("Could not load image %s\n",fname.c_str());
+	return surf;
+}
+
+/** Get decoded sound (owned by caller) or NULL on error. */
+Mix_Chunk *AssetLoader::takeChunk(const string &fname)
+{
+	Mix_Chunk *chunk;
+	int id = find(fname, AL_SOUND);
+
+	if (id == -1)
+		chunk = Mix_LoadWAV(fname.c_str());
+	else {
+		chunk = jobs[id].chunk;
+		jobs[id].chunk = NULL;
+	}
+	if (chunk == NULL)
+		_logerr("Could not load sound %s\n",fname.c_str());
+	return chunk;
+}
+
+/** Wait for all workers and free whatever has not been taken. */
+void AssetLoader::finish()
+{
+	for (uint i = 0; i < threads.size(); i++)
+		SDL_WaitThread(threads[i], NULL);
+	threads.clear();
+	if (cond) {
+		SDL_DestroyCond(cond);
+		cond = NULL;
+	}
+	if (mutex) {
+		SDL_DestroyMutex(mutex);
+		mutex = NULL;
+	}
+	for (auto &job : jobs) {
+		if (job.surf)
+			SDL_FreeSurface(job.surf);
+		if (job.chunk)
+			Mix_FreeChunk(job.chunk);
+	}
+	jobs.clear();
+	nextJob = 0;
+}
+
+/** Set cache directory (created if missing) and file prefix for theme
+ * name and screen resolution. Stamp must contain all other settings that
+ * change the scaled images. */
+void AssetCache::init(const string &dir, const string &name, int sw, int sh,
+						const string &_stamp)
+{
+	prefix = "";
+	if (!dirExists(dir) && !makeDir(dir)) {
+		_logerr("Could not create cache directory %s\n",dir.c_str());
+		return;
+	}
+	string n = name;
+	for (auto &c : n)
+		if (c == '~' || c == '/' || c == '\\')
+			c = '_';
+	prefix = dir + "/" + n + "-" + to_string(sw) + "x" + to_string(sh) + "-";
+	stamp = _stamp;
+}
+
+/** Open cache file and check header. Return file positioned at pixel
+ * data and fill geom with width, height and grid size or NULL if entry
+ * does not exist or is outdated. */
+FILE *AssetCache::open(const string &id, const string &src, Sint32 *geom)
+{
+	FILE *f;
+	char magic[AC_MAGICLEN];
+	Uint32 len;
+	string key = getKey(src);
+
+	if (prefix.empty() || (f = fopen(getFileName(id).c_str(), "rb")) == NULL)
+		return NULL;
+	if (fread(magic, 1, AC_MAGICLEN, f) != AC_MAGICLEN ||
+			memcmp(magic, AC_MAGIC, AC_MAGICLEN) != 0 ||
+			fread(&len, sizeof(len), 1, f) != 1 || len != key.size()) {
+		fclose(f);
+		return NULL;
+	}
+	string fkey(len, ' ');
+	if (fread(&fkey[0], 1, len, f) != len || fkey != key ||
+			fread(geom, sizeof(Sint32), 4, f) != 4 ||
+			geom[0] <= 0 || geom[1] <= 0) {
+		fclose(f);
+		return NULL;
+	}
+	return f;
+}
+
+bool AssetCache::isValid(const string &id, const string &src)
+{
+	Sint32 geom[4];
+	FILE *f = open(id, src, geom);
+	if (f == NULL)
+		return false;
+	fclose(f);
+	return true;
+}
+
+/** Read cached image into new surface or return NULL. */
+SDL_Surface *AssetCache::read(const string &id, const string &src, int &gw, int &gh)
+{
+	Sint32 geom[4];
+	FILE *f = open(id, src, geom);
+	if (f == NULL)
+		return NULL;
+
+	SDL_Surface *surf = SDL_CreateRGBSurface(0, geom[0], geom[1], 32,
+			0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+	if (surf == NULL) {
+		_logsdlerr();
+		fclose(f);
+		return NULL;
+	}
+
+	/* decode runs (high bit set, one pixel follows)
+	 * and literals (count pixels follow) row by row */
+	bool ok = true;
+	Uint32 ctl, pixel;
+	for (int y = 0; ok && y < surf->h; y++) {
+		Uint32 *p = (Uint32*)((Uint8*)surf->pixels + y * surf->pitch);
+		Uint32 n = surf->w;
+		while (ok && n > 0) {
+			if (fread(&ctl, sizeof(ctl), 1, f) != 1) {
+				ok = false;
+				break;
+			}
+			Uint32 cnt = ctl & ~AC_RUNFLAG;
+			if (cnt == 0 || cnt > n) {
+				ok = false;
+				break;
+			}
+			if (ctl & AC_RUNFLAG) {
+				if (fread(&pixel, sizeof(pixel), 1, f) != 1)
+					ok = false;
+				else
+					for (Uint32 i = 0; i < cnt; i++)
+						*p++ = pixel;
+			} else {
+				if (fread(p, sizeof(Uint32), cnt, f) != cnt)
+					ok = false;
+				p += cnt;
+			}
+			n -= cnt;
+		}
+	}
+	fclose(f);
+	if (!ok) {
+		_logerr("Cache file %s is corrupt\n",getFileName(id).c_str());
+		SDL_FreeSurface(surf);
+		return NULL;
+	}
+	gw = geom[2];
+	gh = geom[3];
+	return surf;
+}
+
+/** Load image from cache. Return 1 on success, 0 if not cached. */
+int AssetCache::load(const string &id, const string &src, Image &img)
+{
+	int gw, gh;
+	SDL_Surface *surf = read(id, src, gw, gh);
+	if (surf == NULL)
+		return 0;
+	int ret = img.load(surf);
+	SDL_FreeSurface(surf);
+	return ret == 1;
+}
+int AssetCache::load(const string &id, const string &src, GridImage &img)
+{
+	int gw, gh;
+	SDL_Surface *surf = read(id, src, gw, gh);
+	if (surf == NULL)
+		return 0;
+	int ret = (gw > 0 && gh > 0 && img.load(surf, gw, gh) == 1);
+	SDL_FreeSurface(surf);
+	return ret;
+}
+
+/** Read back image and write it to cache. Does nothing if image was not
+ * rendered as then loading it from source is as fast. */
+void AssetCache::save(const string &id, const string &src, Image &img, int gw, int gh)
+{
+	if (prefix.empty())
+		return;
+	SDL_Surface *surf = img.readSurface();
+	if (surf == NULL)
+		return;
+
+	FILE *f = fopen(getFileName(id).c_str(), "wb");
+	if (f == NULL) {
+		_logerr("Could not write cache file %s\n",getFileName(id).c_str());
+		SDL_FreeSurface(surf);
+		return;
+	}
+	string key = getKey(src);
+	Uint32 len = key.size();
+	Sint32 geom[4] = { surf->w, surf->h, gw, gh };
+	fwrite(AC_MAGIC, 1, AC_MAGICLEN, f);
+	fwrite(&len, sizeof(len), 1, f);
+	fwrite(key.c_str(), 1, len, f);
+	fwrite(geom, sizeof(Sint32), 4, f);
+
+	/* runs of three or more equal pixels are stored as run */
+	for (int y = 0; y < surf->h; y++) {
+		Uint32 *p = (Uint32*)((Uint8*)surf->pixels + y * surf->pitch);
+		int i = 0;
+		while (i < surf->w) {
+			int run = 1;
+			while (i + run < surf->w && p[i + run] == p[i])
+				run++;
+			if (run >= 3) {
+				Uint32 ctl = AC_RUNFLAG | run;
+				fwrite(&ctl, sizeof(ctl), 1, f);
+				fwrite(&p[i], sizeof(Uint32), 1, f);
+				i += run;
+				continue;
+			}
+			int start = i;
+			while (i < surf->w && !(i + 2 < surf->w &&
+					p[i] == p[i + 1] && p[i] == p[i + 2]))
+				i++;
+			Uint32 ctl = i - start;
+			fwrite(&ctl, sizeof(ctl), 1, f);
+			fwrite(&p[start], sizeof(Uint32), ctl, f);
+		}
+	}
+	if (ferror(f)) {
+		_logerr("Could not write cache file %s\n",getFileName(id).c_str());
+		fclose(f);
+		remove(getFileName(id).c_str());
+	} else
+		fclose(f);
+	SDL_FreeSurface(surf);
+}
@@ -0,0 +1,105 @@
+/*
+ * assets.h
+ */
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SRC_ASSETS_H_
+#define SRC_ASSETS_H_
+
+enum {
+	AL_IMAGE = 0,
+	AL_SOUND,
+	AL_MAXTHREADS = 8,
+	AC_MAGICLEN = 8
+};
+#define AC_MAGIC "LBHDC001"
+#define AC_RUNFLAG 0x80000000u
+
+typedef struct {
+	string fname;
+	int type;
+	SDL_Surface *surf;
+	Mix_Chunk *chunk;
+	bool done; /* decoded (successfully or not) */
+	bool taken; /* ownership passed on */
+} AssetJob;
+
+/** Decode image and sound files on a pool of worker threads. Files are
+ * queued with add*(), decoding is started with start() and results are
+ * fetched with take*() which waits until the file has been decoded.
+ * Textures must not be created here as the renderer is not thread safe,
+ * so images are handed out as surfaces. Same file may be queued more than
+ * once if several owners need their own copy. Files that were not queued
+ * are decoded synchronously by take*(). */
+class AssetLoader {
+	vector<AssetJob> jobs; /* must not change once workers are running */
+	uint nextJob;
+	vector<SDL_Thread*> threads;
+	SDL_mutex *mutex;
+	SDL_cond *cond;
+
+	static int worker(void *data);
+	void decode(AssetJob &job);
+	int find(const string &fname, int type);
+	void add(const string &fname, int type);
+public:
+	AssetLoader() : nextJob(0), mutex(NULL), cond(NULL) {}
+	~AssetLoader() { finish(); }
+	void addImage(const string &fname) { add(fname, AL_IMAGE); }
+	void addSound(const string &fname) { add(fname, AL_SOUND); }
+	void start();
+	SDL_Surface *takeSurface(const string &fname);
+	Mix_Chunk *takeChunk(const string &fname);
+	void finish();
+};
+
+/** Cache of scaled theme images. Files are stored in the cache dir per
+ * theme and resolution and are keyed by source file stamp and all
+ * settings that affect scaling. Pixels are run length encoded ARGB8888
+ * which compresses transparent areas well and loads without decoding.
+ * Only images that were actually rendered (scaled) are saved. */
+class AssetCache {
+	string prefix; /* dir and file name prefix, empty if disabled */
+	string stamp; /* settings that affect the scaled results */
+
+	string getFileName(const string &id) { return prefix + id + ".cache"; }
+	string getKey(const string &src) {
+		return stamp + "|" + src + "|" + fileStamp(src);
+	}
+	FILE *open(const string &id, const string &src, Sint32 *geom);
+	SDL_Surface *read(const string &id, const string &src, int &gw, int &gh);
+public:
+	void init(const string &dir, const string &name, int sw, int sh,
+						const string &_stamp);
+	bool isValid(const string &id, const string &src);
+	int load(const string &id, const string &src, Image &img);
+	int load(const string &id, const string &src, GridImage &img);
+	int load(const string &id, const string &src, Image &img, Image &shadow) {
+		return load(id, src, img) && load(id + "shadow", src, shadow);
+	}
+	int load(const string &id, const string &src, GridImage &img, GridImage &shadow) {
+		return load(id, src, img) && load(id + "shadow", src, shadow);
+	}
+	void save(const string &id, const string &src, Image &img, int gw = 0, int gh = 0);
+	void save(const string &id, const string &src, GridImage &img) {
+		save(id, src, img, img.getGridWidth(), img.getGridHeight());
+	}
+	void save(const string &id, const string &src, Image &img, Image &shadow) {
+		save(id, src, img);
+		save(id + "shadow", src, shadow);
+	}
+	void save(const string &id, const string &src, GridImage &img, GridImage &shadow) {
+		save(id, src, img);
+		save(id + "shadow", src, shadow);
+	}
+};
+
+#endif /* SRC_ASSETS_H_ */
@@ -15,11 +15,15 @@
 using namespace std;
 
 #include "tools.h"
+#include "sdl.h"
 #include "clientgame.h"
 
 extern GameDiff diffs[DIFF_COUNT];
 
-ClientGame::ClientGame(Config &cfg) : config(cfg), levelset(0), game(0),
+ClientGame::ClientGame(Config &cfg) : config(cfg), levelset(0),
+		prefetchThread(0), prefetchId(-1), prefetchedLevel(0),
+		compileThread(0), compileKey(0), loadThread(0), loadResult(-1),
+		game(0), bot(0), replay(0),
 		curPlayer(0), lastDeadPlayer(NULL), msg(""), extrasActive(false),
 		lastpx(-1), pvel(0), pveldir(0)
 {
@@ -27,35 +31,86 @@ ClientGame::ClientGame(Config &cfg) : config(cfg), levelset(0), game(0),
 	pvelmax = config.key_speed;
 	pvelmin = pvelmax / 2;
 	pacc = (pvelmax - pvelmin) / 300;
+	SDL_AtomicSet(&loadDone, 0);
 }
 
 ClientGame::~ClientGame()
 {
-	if (levelset)
-		levelset_delete(&levelset);
+	if (loadThread)
+		SDL_WaitThread(loadThread, NULL);
+	deleteLevelset();
+	finishCompile();
+	finishReplay();
 	if (game)
 		game_delete(&game);
+	bot_delete(&bot);
+}
+
+/** Init game context with level. If enabled, the previous recording
+ * is saved and a new one is started. */
+void ClientGame::initLevel(Level *l)
+{
+	finishReplay();
+	if (config.record_replay)
+		replay = replay_create(game, l);
+	game_init(game, l);
 }
 
+/** Save recording of last level to config directory (check with
+ * libgame/replaycheck). */
+void ClientGame::finishReplay()
+{
+	if (!replay)
+		return;
+	string fname = config.dname + "/replay.rpl";
+	if (replay_save(replay, fname.c_str()))
+		_loginfo("Saved replay of %d frames to %s\n", replay->count, fname.c_str());
+	replay_delete(&replay);
+}
+
+/** Initialize new game and wait until levelset is loaded. */
 int ClientGame::init(const string& setname, int levelid)
 {
-	/* kill running game if any */
-	if (levelset)
-		levelset_delete(&levelset);
+	startInit(setname);
+	return finishInit(levelid);
+}
+
+/** Kill running game if any and start loading levelset in background.
+ * Call finishInit() when initReady() is true. */
+void ClientGame::startInit(const string& setname)
+{
+	if (loadThread) {
+		SDL_WaitThread(loadThread, NULL);
+		loadThread = NULL;
+	}
+	deleteLevelset();
 	if (game)
 		game_delete(&game);
 
-	/* init players */
-	curPlayer = 0;
-	players.clear();
-	for (int i = 0; i < config.player_count; i++)
-		players.push_back(
-			unique_ptr<ClientPlayer>(
-				new ClientPlayer(config.player_names[i],
-						diffs[config.diff].lives,
-						diffs[config.diff].max_lives)));
+	loadName = setname;
+	loadResult = -1;
+	SDL_AtomicSet(&loadDone, 0);
+	loadThread = SDL_CreateThread(loadThreadFunc, "loadset", this);
+	if (loadThread == NULL) {
+		_logsdlerr();
+		loadThreadFunc(this);
+	}
+}
 
-	/* load levelset from install directory or home directory */
+/** Only sets up levelset which is not used by main thread until done.
+ * Game context is created later in main thread as libgame works on
+ * global state. */
+int ClientGame::loadThreadFunc(void *data)
+{
+	ClientGame *cg = (ClientGame*)data;
+	cg->loadResult = cg->loadLevelset(cg->loadName);
+	SDL_AtomicSet(&cg->loadDone, 1);
+	return 0;
+}
+
+/** Load levelset from install directory or home directory. */
+int ClientGame::loadLevelset(const string& setname)
+{
 	if (setname == TOURNAMENT) {
 		if (!loadAllLevels())
 			return -1;
@@ -67,6 +122,32 @@ int ClientGame::init(const string& setname, int levelid)
 		_logerr("Levelset %s is empty\n",setname.c_str());
 		return -1;
 	}
+	return 0;
+}
+
+/** Wait for levelset, set up players and game context with level id. */
+int ClientGame::finishInit(int levelid)
+{
+	if (loadThread) {
+		SDL_WaitThread(loadThread, NULL);
+		loadThread = NULL;
+	}
+
+	/* init players */
+	curPlayer = 0;
+	players.clear();
+	for (int i = 0; i < config.player_count; i++)
+		players.push_back(
+			unique_ptr<ClientPlayer>(
+				new ClientPlayer(config.player_names[i],
+						diffs[config.diff].lives,
+						diffs[config.diff].max_lives)));
+
+	if (loadResult < 0)
+		return -1;
+	if (levelid < 0 || levelid >= levelset->count)
+		levelid = 0;
+
 	/* create game context and init first level */
 	if ((game = game_create(GT_LOCAL,config.diff,config.rel_warp_limit)) == 0) {
 		_logerr("Could not create game context\n");
@@ -74,12 +155,13 @@ int ClientGame::init(const string& setname, int levelid)
 	}
 	game->localServerGame = 1; /* for special levels */
 	game_set_current(game);
-	game_init(game,levelset->levels[levelid]);
+	initLevel(getLevel(levelid));
 	game_set_convex_paddle( config.convex );
 	game_set_ball_auto_return( !config.return_on_click );
 	game_set_ball_random_angle( config.random_angle );
 	game_set_ball_accelerated_speed( config.maxballspeed_float );
 	game_set_bcc_type(config.bcc_type);
+	game_set_fixed_physics(config.fixed_physics);
 	game->ball_auto_speedup = config.ball_auto_turbo;
 	extrasActive = false;
 	pvel = pvelmin;
@@ -87,7 +169,7 @@ int ClientGame::init(const string& setname, int levelid)
 
 	/* set first level as snapshot to all players */
 	for (auto& p : players)
-		p->setLevelSnapshot(levelset->levels[levelid]);
+		p->setLevelSnapshot(getLevel(levelid));
 	return 0;
 }
 
@@ -95,8 +177,7 @@ int ClientGame::init(const string& setname, int levelid)
 int ClientGame::initTestlevel(const string &title, const string &author, int bricks[][EDIT_HEIGHT], int extras[][EDIT_HEIGHT])
 {
 	/* kill running game if any */
-	if (levelset)
-		levelset_delete(&levelset);
+	deleteLevelset();
 	if (game)
 		game_delete(&game);
 
@@ -117,6 +198,7 @@ int ClientGame::initTestlevel(const string &title, const string &author, int bri
 			levelset->levels[0]->bricks[i][j] = brick_get_char(bricks[i][j]);
 			levelset->levels[0]->extras[i][j] = extra_get_char(extras[i][j]);
 		}
+	level_update_hash(levelset->levels[0]);
 
 	/* create game context and init first level */
 	if ((game = game_create(GT_LOCAL,config.diff,config.rel_warp_limit)) == 0) {
@@ -125,7 +207,7 @@ int ClientGame::initTestlevel(const string &title, const string &author, int bri
 	}
 	game->localServerGame = 1; /* for special levels */
 	game_set_current(game);
-	game_init(game,levelset->levels[0]);
+	initLevel(levelset->levels[0]);
 	game_set_convex_paddle( config.convex );
 	game_set_ball_auto_return( !config.return_on_click );
 	game_set_ball_random_angle( config.random_angle );
@@ -254,14 +336,20 @@ int ClientGame::update(uint ms, double rx, PaddleInputState &pis)
 	}
 
 	/* update bottom paddle state */
-	game_set_paddle_state(0,px,0,pis.leftFire,pis.rightFire,pis.recall);
+	if (bot)
+		bot_update(bot, 0, ms);
+	else
+		game_set_paddle_state(0,px,0,pis.leftFire,pis.rightFire,pis.recall);
 
 	/* recall idle balls */
 	game->paddles[0]->ball_return_key_pressed = pis.recall;
 
 	/* update all game objects */
 	game->paddles[0]->maxballspeed_request = pis.speedUp;
-	game_update(ms);
+	if (replay)
+		replay_update(replay, ms);
+	else
+		game_update(ms);
 	game->paddles[0]->maxballspeed_request_old = pis.speedUp;
 
 	/* can and wants to warp */
@@ -276,7 +364,7 @@ int ClientGame::update(uint ms, double rx, PaddleInputState &pis)
 		/* bonus levels are just skipped on failure */
 		if (game->winner == PADDLE_BOTTOM || game->level_type != LT_NORMAL) {
 			if (p->nextLevel() < (uint)levelset->count)
-				p->setLevelSnapshot(levelset->levels[p->getLevel()]);
+				p->setLevelSnapshot(getLevel(p->getLevel()));
 			else {
 				/* if only one bonus level, we play a special mini game
 				 * set so just say game over to avoid confusion */
@@ -304,7 +392,7 @@ int ClientGame::update(uint ms, double rx, PaddleInputState &pis)
 		}
 		_logdebug(1,"Next player: %s\n",p->getName().c_str());
 		game_finalize(game);
-		game_init(game,p->getLevelSnapshot());
+		initLevel(p->getLevelSnapshot());
 		/* score is reset to 0 again so adjust */
 		game->paddles[0]->score = p->getScore();
 		ret |= CGF_NEWLEVEL;
@@ -355,7 +443,7 @@ void ClientGame::continueGame()
 	if (wasLastPlayer) { /* no init in cgame.update() */
 		ClientPlayer *p = getNextPlayer();
 		game_finalize(game);
-		game_init(game,p->getLevelSnapshot());
+		initLevel(p->getLevelSnapshot());
 	}
 }
 
@@ -365,6 +453,8 @@ int ClientGame::destroyBrick(int x, int y)
 		return 0;
 	if (game->bricks[x][y].type == MAP_EMPTY)
 		return 0;
+	/* not an input so level can't be replayed anymore */
+	replay_delete(&replay);
 
 	/* copied from libgame/bricks.c::brick_start_expl
 	 * as functions seems to get optimized out as not used in lib */
@@ -415,12 +505,34 @@ const string &ClientGame::getBonusLevelInfo()
 	return info;
 }
 
+/** Load superset of all installed levelsets for freakout mode. The
+ * compiled levels are used if up to date. Otherwise levels are loaded
+ * on demand from the sets while they are compiled in background. */
 int ClientGame::loadAllLevels()
 {
 	vector<string> list;
+	vector<int> counts;
+	vector<unsigned long long*> hashes;
 	List *sets;
 
+	finishCompile();
+
 	readDir(string(DATADIR)+"/levels", RD_FILES, list);
+	/* skip sets that are known to be broken or empty */
+	for (auto it = list.begin(); it != list.end(); ) {
+		const SetIndexEntry *e = setIndex.get(*it);
+		if (e == NULL || e->levels == 0)
+			it = list.erase(it);
+		else {
+			counts.push_back(e->levels);
+			/* pointer is valid as index is not updated here */
+			if (e->levelHashes.size() == e->levels)
+				hashes.push_back((unsigned long long*)&e->levelHashes[0]);
+			else
+				hashes.push_back(NULL);
+			++it;
+		}
+	}
 #ifdef WIN32
 	/* we need to make item non-const which will make compiler
 	 * complain about c_str() being const. */
@@ -433,13 +545,111 @@ int ClientGame::loadAllLevels()
 		list_add(sets, s.c_str());
 #endif
 
-	levelset = levelset_load_all(sets, config.freakout_seed,
+	string bname = config.dname + "/levels.bin";
+	unsigned long long key = levelsets_get_key(sets);
+	LevelBin *bin = levelbin_open(bname.c_str(), key);
+	if (bin)
+		levelset = levelset_load_all_bin(bin, config.freakout_seed,
+						config.add_bonus_levels);
+	else if (!counts.empty()) {
+		levelset = levelset_load_all_lazy(sets, &counts[0], &hashes[0],
+						config.freakout_seed,
 						config.add_bonus_levels);
+		/* compile for next time */
+		compileSets = list;
+		compileName = bname;
+		compileKey = key;
+		compileThread = SDL_CreateThread(compileThreadFunc, "levelc", this);
+		if (compileThread == NULL)
+			_logsdlerr();
+	}
 	list_delete(sets);
 
 	return (levelset!=NULL);
 }
 
+/** Compile levelsets as set up in loadAllLevels(). */
+int ClientGame::compileThreadFunc(void *data)
+{
+	ClientGame *cg = (ClientGame*)data;
+	List *sets = list_create( LIST_AUTO_DELETE, 0 );
+	for (auto& s : cg->compileSets)
+		list_add(sets, strdup(s.c_str()));
+	_loginfo("Compiling levelsets to %s\n", cg->compileName.c_str());
+	levelset_compile(sets, cg->compileName.c_str(), cg->compileKey);
+	list_delete(sets);
+	return 0;
+}
+
+/** Wait for background compilation of levelsets if any. */
+void ClientGame::finishCompile()
+{
+	if (compileThread == NULL)
+		return;
+	SDL_WaitThread(compileThread, NULL);
+	compileThread = NULL;
+}
+
+/** Get level id of current levelset, load it if not done yet and
+ * prefetch the next one. */
+Level *ClientGame::getLevel(uint id)
+{
+	if (prefetchThread && prefetchId == (int)id)
+		finishPrefetch();
+	Level *l = levelset_get_level(levelset, id);
+	if (id + 1 < (uint)levelset->count)
+		prefetchLevel(id + 1);
+	return l;
+}
+
+/** Load level id in background if it is not loaded yet. */
+void ClientGame::prefetchLevel(uint id)
+{
+	if (levelset->refs == NULL || levelset->levels[id])
+		return;
+	if (prefetchThread && prefetchId == (int)id)
+		return;
+	finishPrefetch();
+	prefetchId = id;
+	prefetchThread = SDL_CreateThread(prefetchThreadFunc, "prefetch", this);
+	if (prefetchThread == NULL)
+		_logsdlerr(); /* will be loaded when needed */
+}
+
+/** Only reads the level references which are not changed while the
+ * levelset exists. */
+int ClientGame::prefetchThreadFunc(void *data)
+{
+	ClientGame *cg = (ClientGame*)data;
+	cg->prefetchedLevel = levelset_load_ref(cg->levelset, cg->prefetchId);
+	return 0;
+}
+
+/** Wait for prefetch thread if any and store its level in the set. */
+void ClientGame::finishPrefetch()
+{
+	if (prefetchThread == NULL)
+		return;
+	SDL_WaitThread(prefetchThread, NULL);
+	prefetchThread = NULL;
+	if (prefetchedLevel) {
+		if (levelset->levels[prefetchId] == NULL)
+			levelset->levels[prefetchId] = prefetchedLevel;
+		else
+			level_delete(prefetchedLevel);
+	}
+	prefetchedLevel = NULL;
+	prefetchId = -1;
+}
+
+/** Delete current levelset after prefetching has finished. */
+void ClientGame::deleteLevelset()
+{
+	finishPrefetch();
+	if (levelset)
+		levelset_delete(&levelset);
+}
+
 /** Restart level */
 int ClientGame::restartLevel()
 {
@@ -448,14 +658,14 @@ int ClientGame::restartLevel()
 	_logdebug(1,"Restarting level ...\n");
 
 	p->looseLife(); /* we checked that this is not the last life */
-	p->setLevelSnapshot(levelset->levels[p->getLevel()]);
+	p->setLevelSnapshot(getLevel(p->getLevel()));
 	p = getNextPlayer();
 	if (p == NULL)
 		_logerr("Next player is NULL while restarting?!?\n");
 
 	_logdebug(1,"Next player: %s\n",p->getName().c_str());
 	game_finalize(game);
-	game_init(game,p->getLevelSnapshot());
+	initLevel(p->getLevelSnapshot());
 	/* score is reset to 0 again so adjust */
 	game->paddles[0]->score = p->getScore();
 
@@ -17,7 +17,10 @@
 
 #include "../libgame/gamedefs.h"
 #include "../libgame/game.h"
+#include "../libgame/bot.h"
+#include "../libgame/replay.h"
 #include "hiscores.h"
+#include "setindex.h"
 
 class ClientPlayer {
 	string name;
@@ -98,8 +101,25 @@ enum {
 class ClientGame {
 	Config &config;
 	LevelSet *levelset;
+	/* levels of lazy sets are loaded one ahead in background */
+	SDL_Thread *prefetchThread;
+	int prefetchId;
+	Level *prefetchedLevel;
+	/* compiled levels are rebuilt in background if outdated */
+	SDL_Thread *compileThread;
+	vector<string> compileSets;
+	string compileName;
+	unsigned long long compileKey;
+	/* levelset of new game is loaded in background */
+	SDL_Thread *loadThread;
+	string loadName;
+	int loadResult;
+	SDL_atomic_t loadDone;
 	Game *game; /* current game context */
+	Bot *bot; /* if set, controls paddle instead of input */
+	Replay *replay; /* recording of current level if enabled */
 	Hiscores hiscores;
+	LevelsetIndex setIndex;
 	vector<unique_ptr<ClientPlayer>> players;
 	uint curPlayer;
 	ClientPlayer *lastDeadPlayer;
@@ -114,15 +134,35 @@ class ClientGame {
 
 	ClientPlayer *getNextPlayer();
 	void initLevel(Level *l);
+	void finishReplay();
 	int loadAllLevels();
+	int loadLevelset(const string& setname);
+	static int loadThreadFunc(void *data);
+	Level *getLevel(uint id);
+	void prefetchLevel(uint id);
+	void finishPrefetch();
+	void deleteLevelset();
+	static int prefetchThreadFunc(void *data);
+	static int compileThreadFunc(void *data);
+	void finishCompile();
 public:
 	ClientGame(Config &cfg);
 	~ClientGame();
 	int init(const string& setname, int levelid = 0);
+	void startInit(const string& setname);
+	bool initReady() { return SDL_AtomicGet(&loadDone); }
+	int finishInit(int levelid = 0);
 	int initTestlevel(const string &title, const string &author,
 			int bricks[][EDIT_HEIGHT], int extras[][EDIT_HEIGHT]);
 	int update(uint ms, double rx, PaddleInputState &pis);
 	Game *getGameContext() { return game; }
+	void setAutopilot(int skill) {
+		bot_delete(&bot);
+		if (skill >= 0)
+			bot = bot_create(skill);
+	}
+	bool autopilotActive() { return bot != NULL; }
+	LevelsetIndex &getSetIndex() { return setIndex; }
 	string getLevelsetName() { return levelset->name; }
 	void getCurrentLevelNameAndAuthor(string &name, string &author) {
 		ClientPlayer *p = players[curPlayer].get();
@@ -131,8 +171,8 @@ public:
 			name = "none";
 			author = "none"; /* is done, should not happen */
 		} else {
-			name = levelset->levels[lid]->name;
-			author = levelset->levels[lid]->author;
+			name = getLevel(lid)->name;
+			author = getLevel(lid)->author;
 		}
 	}
 	int getLevelCount() { return levelset->count; }
@@ -154,7 +194,7 @@ public:
 		players[pid]->setLives(lives);
 		players[pid]->setScore(score);
 		players[pid]->setLevel(level);
-		players[pid]->setLevelSnapshot(levelset->levels[level]);
+		players[pid]->setLevelSnapshot(getLevel(level));
 	}
 	int getFloorTime() {
 		if (!game || !game->paddles[0]->extra_active[EX_WALL])
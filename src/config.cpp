@@ -52,6 +52,7 @@ Config::Config()
 	maxballspeed_int1000 = 900;
 	maxballspeed_float = 0.7;
 	ball_auto_turbo = 0;
+	aim_assist = 0;
 	/* gamepad */
 	gp_enabled = 1;
 	gp_lfire = 3;
@@ -72,7 +73,12 @@ Config::Config()
 	fade = 1;
 	bonus_info = 1;
 	fps = 1;
+	vsync = 0;
 	show_fps = 0;
+	show_stats = 0;
+	stats_csv = 0;
+	frametime_log = 0;
+	record_replay = 0;
 	ball_level = BALL_BELOW_BONUS;
 	antialiasing = 0;
 	/* various */
@@ -82,6 +88,7 @@ Config::Config()
 	theme_count = 1;
 	edit_setname ="newset";
 	bcc_type = 0; /* trajectory */
+	fixed_physics = 0;
 
 	/* if config dir not found create necessary dirs */
 	dname = CONFIGDIR;
@@ -128,6 +135,7 @@ Config::Config()
 	fp.get( "gp_maxballspeed", gp_maxballspeed );
 	fp.get( "gp_warp", gp_warp );
 	fp.get( "ball_auto_turbo", ball_auto_turbo );
+	fp.get( "aim_assist", aim_assist );
 	fp.get( "rel_motion", rel_motion );
 	fp.get( "grab", grab );
 	fp.get( "motion_mod", motion_mod );
@@ -147,7 +155,12 @@ Config::Config()
 	fp.get( "fade", fade );
 	fp.get( "bonus_info", bonus_info );
 	fp.get( "fps", fps );
+	fp.get( "vsync", vsync );
 	fp.get( "show_fps", show_fps );
+	fp.get( "show_stats", show_stats );
+	fp.get( "stats_csv", stats_csv );
+	fp.get( "frametime_log", frametime_log );
+	fp.get( "record_replay", record_replay );
 	fp.get( "ball_level", ball_level );
 	fp.get( "i_key_speed", i_key_speed );
 	key_speed = 0.001 * i_key_speed;
@@ -158,6 +171,7 @@ Config::Config()
 	fp.get( "theme_count", theme_count );
 	fp.get( "edit_setname", edit_setname );
 	fp.get( "bcc_type", bcc_type );
+	fp.get( "fixed_physics", fixed_physics );
 }
 
 void Config::save()
@@ -194,6 +208,7 @@ void Config::save()
 	ofs << "gp_warp=" << gp_warp << "\n";
 	ofs << "gp_maxballspeed=" << gp_maxballspeed << "\n";
 	ofs << "ball_auto_turbo=" << ball_auto_turbo << "\n";
+	ofs << "aim_assist=" << aim_assist << "\n";
 	ofs << "rel_motion=" << rel_motion << "\n";
 	ofs << "grab=" << grab << "\n";
 	ofs << "motion_mod=" << motion_mod << "\n";
@@ -212,7 +227,12 @@ void Config::save()
 	ofs << "fade=" << fade << "\n";
 	ofs << "bonus_info=" << bonus_info << "\n";
 	ofs << "fps=" << fps << "\n";
+	ofs << "vsync=" << vsync << "\n";
 	ofs << "show_fps=" << show_fps << "\n";
+	ofs << "show_stats=" << show_stats << "\n";
+	ofs << "stats_csv=" << stats_csv << "\n";
+	ofs << "frametime_log=" << frametime_log << "\n";
+	ofs << "record_replay=" << record_replay << "\n";
 	ofs << "ball_level=" << ball_level << "\n";
 	ofs << "i_key_speed=" << i_key_speed << "\n";
 	ofs << "antialiasing=" << antialiasing << "\n";
@@ -222,6 +242,7 @@ void Config::save()
 	ofs << "theme_count=" << theme_count << "\n";
 	ofs << "edit_setname=" << edit_setname << "\n";
 	ofs << "bcc_type=" << bcc_type << "\n";
+	ofs << "fixed_physics=" << fixed_physics << "\n";
 
 	ofs.close();
 	_loginfo("Configuration saved to %s\n",path.c_str());
@@ -65,6 +65,7 @@ public:
 	int maxballspeed_int1000; /* max ball speed in pixels/second */
 	float maxballspeed_float; /* per millisecond */
 	int ball_auto_turbo;
+	int aim_assist; /* show predicted trajectory of balls */
 
 	/* gamepad */
 	int gp_enabled;
@@ -87,8 +88,13 @@ public:
 	int mode; /* id of mode, see MainWindow for modes */
 	int fade;
 	int bonus_info;
-	int fps; /* frames per second: 0 - no limit, 1 - 100, 2 - 200 */
+	int fps; /* frame limit: 0 - no limit, 1 - display rate, 2 - 60, 3 - 120, 4 - 144, 5 - 240 */
+	int vsync;
 	int show_fps;
+	int show_stats; /* render statistics overlay */
+	int stats_csv; /* append render statistics per frame to stats.csv */
+	int frametime_log; /* append frame time reports to frametimes.log */
+	int record_replay; /* save inputs and state hashes of last level to replay.rpl */
 	int ball_level;
 	int i_key_speed; /* integer value that is divided by 1000 to get real key_speed */
 	int antialiasing;
@@ -99,6 +105,7 @@ public:
 	int theme_count; /* to check and properly reset id if number of themes changed */
 	string edit_setname;
 	int bcc_type; /* how to get targets: by clipping or trajectory */
+	int fixed_physics; /* integer ball physics, same result on any machine */
 
 	Config();
 	~Config() { save(); }
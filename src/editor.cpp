@@ -14,6 +14,7 @@
 
 #include "../libgame/gamedefs.h"
 #include "../libgame/game.h"
+#include "../libgame/analyze.h"
 #include "tools.h"
 #include "sdl.h"
 #include "clientgame.h"
@@ -54,6 +55,7 @@ void Editor::init(const string &setname) {
 	int bh = theme.bricks.getGridHeight();
 
 	/* set path and init one empty level */
+	setName = setname;
 	fpath = getCustomLevelsetDir() + "/" + setname;
 	version = "1.00";
 	numLevels = 0;
@@ -77,29 +79,30 @@ void Editor::init(const string &setname) {
 	buttons.create(EB_NUMBER*bw,bh);
 	string captions[] = {"First", "Prev", "Next", "Last",
 		"<Add", "Add>", "Clear", "Del", "MvUp", "MvDn",
-		"Load", "Save", "Quit", "Test"
+		"Load", "Save", "Quit", "Test", "Stats"
 	};
 	Font &f = theme.fSmall;
 	f.setAlign(ALIGN_X_CENTER | ALIGN_Y_CENTER);
 	old = SDL_GetRenderTarget(mrc);
-	SDL_SetRenderTarget(mrc,buttons.getTex());
+	setRenderTarget(buttons.getTex());
 	for (uint i = 0; i < EB_NUMBER; i++) {
 		buttons.fill(i*bw+2,2,bw-4,bh-4,30,40,80);
 		f.write(i*bw + bw/2,bh/2,captions[i]);
 	}
-	SDL_SetRenderTarget(mrc,old);
+	setRenderTarget(old);
 
 	/* create background */
 	background.create();
 	if (theme.numWallpapers > 1) {
 		old = SDL_GetRenderTarget(mrc);
-		SDL_SetRenderTarget(mrc,background.getTex());
-		theme.wallpapers[0].setBlendMode(1);
-		theme.wallpapers[0].setAlpha(48);
-		theme.wallpapers[0].copy();
-		theme.wallpapers[0].clearAlpha();
-		theme.wallpapers[0].setBlendMode(0);
-		SDL_SetRenderTarget(mrc,old);
+		setRenderTarget(background.getTex());
+		Image &wallpaper = theme.getWallpaper(0);
+		wallpaper.setBlendMode(1);
+		wallpaper.setAlpha(48);
+		wallpaper.copy();
+		wallpaper.clearAlpha();
+		wallpaper.setBlendMode(0);
+		setRenderTarget(old);
 	}
 	background.setBlendMode(0);
 
@@ -119,7 +122,7 @@ void Editor::init(const string &setname) {
 	/* draw bricks and extras on right hand side of background */
 	uint dx = MAP_WIDTH*bw, dy = bh;
 	old = SDL_GetRenderTarget(mrc);
-	SDL_SetRenderTarget(mrc,background.getTex());
+	setRenderTarget(background.getTex());
 
 	numBrickCols = numExtraCols = 5;
 	numBricks = BRICK_COUNT_REGULAR; /* number of different bricks for editing */
@@ -177,7 +180,7 @@ void Editor::init(const string &setname) {
 	rButtons.w = EB_NUMBER * bw;
 	rButtons.h = bh;
 
-	SDL_SetRenderTarget(mrc,old);
+	setRenderTarget(old);
 }
 
 /** Run edit dialog and set quitRequested if quit was received. */
@@ -351,6 +354,7 @@ void Editor::save()
 	ofs.close();
 	_loginfo("Levelset saved to %s\n",fpath.c_str());
 	hasChanges = false;
+	setIndex.invalidate("~" + setName);
 }
 
 void Editor::swapLevels(uint pos1, uint pos2)
@@ -428,11 +432,115 @@ void Editor::handleButton(uint id)
 	case EB_TEST:
 		testLevel = true;
 		break;
+	case EB_STATS:
+		analyzeLevel();
+		break;
 	default:
 		break;
 	}
 }
 
+/** Level analysis run by worker thread of Editor::analyzeLevel(). */
+struct AnalyzeJob {
+	Level *level;
+	StatsCache *cache;
+	LevelStats stats;
+	int result; /* of levels_analyze() */
+	SDL_atomic_t cancel;
+	SDL_atomic_t done;
+};
+
+static int analyzeThreadFunc(void *data)
+{
+	AnalyzeJob *job = (AnalyzeJob*)data;
+	job->result = levels_analyze(&job->level, 1, job->cache, 0,
+						&job->stats, &job->cancel);
+	SDL_AtomicSet(&job->done, 1);
+	return 0;
+}
+
+/** Play current level several times by autopilot on all cores and
+ * show clear rate, times, lost balls and unreachable bricks. This is
+ * done in background with a notice shown, Escape cancels. */
+void Editor::analyzeLevel()
+{
+	Level level;
+	AnalyzeJob job;
+	LevelStats &stats = job.stats;
+	SimConfig cfg;
+	SDL_Thread *thread;
+	SDL_Event ev;
+	Image img;
+	string text, aux;
+
+	memset(&level, 0, sizeof(Level));
+	level.type = LT_NORMAL;
+	for (int i = 0; i < EDIT_WIDTH; i++)
+		for (int j = 0; j < EDIT_HEIGHT; j++) {
+			level.bricks[i][j] = brick_get_char(curLevel->bricks[i][j]);
+			level.extras[i][j] = extra_get_char(curLevel->extras[i][j]);
+		}
+	level_update_hash(&level);
+	level_count_bricks(&level);
+	if (level.normal_brick_count == 0)
+		return;
+
+	sim_config_default(&cfg);
+	cfg.max_time = EA_MAXTIME;
+	job.level = &level;
+	job.cache = stats_cache_load(NULL, &cfg, EA_ATTEMPTS, 0);
+	job.result = -1;
+	SDL_AtomicSet(&job.cancel, 0);
+	SDL_AtomicSet(&job.done, 0);
+
+	/* show notice over dimmed editor */
+	render();
+	img.createFromScreen();
+	img.setAlpha(32);
+	SDL_SetRenderDrawColor(mrc,0,0,0,255);
+	SDL_RenderClear(mrc);
+	img.copy();
+	theme.fNormal.setAlign(ALIGN_X_CENTER | ALIGN_Y_CENTER);
+	theme.fNormal.write(img.getWidth()/2, img.getHeight()/2,
+				_("Analyzing level... (Escape to cancel)"));
+	SDL_RenderPresent(mrc);
+
+	if ((thread = SDL_CreateThread(analyzeThreadFunc, "analyze", &job)) == NULL) {
+		_logsdlerr();
+		analyzeThreadFunc(&job);
+	} else {
+		while (!SDL_AtomicGet(&job.done)) {
+			if (!SDL_WaitEventTimeout(&ev, EA_POLLTIME))
+				continue;
+			if (ev.type == SDL_QUIT)
+				quitReceived = true;
+			if (ev.type == SDL_QUIT || (ev.type == SDL_KEYDOWN &&
+					ev.key.keysym.scancode == SDL_SCANCODE_ESCAPE))
+				SDL_AtomicSet(&job.cancel, 1);
+		}
+		SDL_WaitThread(thread, NULL);
+	}
+	stats_cache_delete(&job.cache);
+	if (job.result < 0)
+		return; /* canceled */
+
+	strprintf(text, _("Cleared %d%%"), 100 * stats.cleared / stats.attempts);
+	if (stats.clear_time >= 0) {
+		strprintf(aux, _(" in %ds"), stats.clear_time / 1000);
+		text += aux;
+	}
+	strprintf(aux, _(", %.1f balls lost"), stats.balls_lost);
+	text += aux;
+	if (stats.walled + stats.energy > 0) {
+		strprintf(aux, _(", %d unreachable bricks (%d energy ball only)"),
+					stats.walled + stats.energy, stats.energy);
+		text += aux;
+	}
+	strprintf(aux, _(", warp %d%%"), 100 * stats.warp_reached / stats.attempts);
+	text += aux;
+	runConfirmDlg(text);
+}
+
 void Editor::handleClick(int mx, int my, int mb)
 {
 	uint rx, ry;
@@ -45,12 +45,21 @@ enum {
 	EB_SAVE,
 	EB_QUIT,
 	EB_TEST,
+	EB_STATS,
 	EB_NUMBER
 };
 
+enum {
+	/* level analysis */
+	EA_ATTEMPTS = 8, /* autopilot runs */
+	EA_MAXTIME = 180000, /* ms of game time per run */
+	EA_POLLTIME = 50 /* max wait for events before checking worker */
+};
+
 class Editor {
 	Theme &theme;
 	Mixer &mixer;
+	LevelsetIndex &setIndex;
 	bool quitReceived; /* close app entirely */
 	bool leaveRequested; /* close editor and return to menu */
 	bool testLevel; /* whether current level should be test played */
@@ -67,6 +76,7 @@ class Editor {
 	string btnTooltips[EB_NUMBER];
 	int btnFocus; /* -1 or id of button of mouse cursor on it */
 
+	string setName; /* name of edited custom set */
 	string fpath; /* edited file */
 	vector<EditorLevel> levels; /* level data */
 	string version; /* version of level set */
@@ -96,9 +106,10 @@ class Editor {
 	int brickChar2Id(char c);
 	int extraChar2Id(char c);
 	void swapLevels(uint pos1, uint pos2);
+	void analyzeLevel();
 public:
-	Editor(Theme &t, Mixer &m)
-			: theme(t), mixer(m),
+	Editor(Theme &t, Mixer &m, LevelsetIndex &si)
+			: theme(t), mixer(m), setIndex(si),
 			  quitReceived(false), leaveRequested(false),
 			  testLevel(false), hasChanges(false),
 			  brickWidth(0), brickHeight(0),
@@ -122,6 +133,7 @@ public:
 		btnShortcuts[EB_SAVE] = SDL_SCANCODE_S;
 		btnShortcuts[EB_QUIT] = SDL_SCANCODE_ESCAPE;
 		btnShortcuts[EB_TEST] = SDL_SCANCODE_T;
+		btnShortcuts[EB_STATS] = SDL_SCANCODE_A;
 		btnTooltips[EB_FIRST] = _("Go to first level [Up Arrow]");
 		btnTooltips[EB_PREV] = _("Go to previous level [Left Arrow]");
 		btnTooltips[EB_NEXT] = _("Go to next level [Right Arrow]");
@@ -136,6 +148,7 @@ public:
 		btnTooltips[EB_SAVE] = _("Save levelset to file [S]");
 		btnTooltips[EB_QUIT] = _("Quit editor [ESC]");
 		btnTooltips[EB_TEST] = _("Test current level [T] (will save all changes)");
+		btnTooltips[EB_STATS] = _("Let autopilot play current level to rate its difficulty [A]");
 	};
 	bool quitRcvd() { return quitReceived; }
 	bool testRequested() { return testLevel; }
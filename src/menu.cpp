@@ -75,8 +75,21 @@ int MenuItemEdit::runEditDialog(const string &caption, string &str)
 	f->setAlign(ALIGN_X_CENTER | ALIGN_Y_CENTER);
 
 	SDL_StartTextInput();
+	bool redraw = true;
 	while (!done) {
-		if (SDL_PollEvent(&event)) {
+		/* redraw */
+		if (redraw) {
+			SDL_SetRenderDrawColor(mrc,0,0,0,255);
+			SDL_RenderClear(mrc);
+			img.copy();
+			string text(caption + ": " + str);
+			f->write(img.getWidth()/2,img.getHeight()/2,text);
+			SDL_RenderPresent(mrc);
+			redraw = false;
+		}
+
+		if (SDL_WaitEventTimeout(&event, IDLE_TIMEOUT)) {
+			redraw = true;
 			switch (event.type) {
 			case SDL_QUIT:
 				done = true; // XXX should cancel everything...
@@ -101,17 +114,11 @@ int MenuItemEdit::runEditDialog(const string &caption, string &str)
 			case SDL_TEXTINPUT:
 				str += event.text.text;
 				break;
+			case SDL_MOUSEMOTION:
+				redraw = false;
+				break;
 			}
 		}
-
-		/* redraw */
-		SDL_SetRenderDrawColor(mrc,0,0,0,255);
-		SDL_RenderClear(mrc);
-		img.copy();
-		string text(caption + ": " + str);
-		f->write(img.getWidth()/2,img.getHeight()/2,text);
-		SDL_RenderPresent(mrc);
-		SDL_Delay(10);
 		SDL_FlushEvent(SDL_MOUSEMOTION);
 	}
 	SDL_StopTextInput();
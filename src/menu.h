@@ -110,6 +110,11 @@ public:
 		if (focus && tooltipTimeout.running())
 			tooltipTimeout.update(ms);
 	}
+	/** Return true if item is fading or waiting to show tooltip. */
+	virtual bool isAnimating() {
+		return (!focus && fadingAlpha > 0) ||
+				(focus && tooltipTimeout.running());
+	}
 	virtual void render() {
 		renderPart(lblNormal, lblFocus, ALIGN_X_LEFT);
 		renderTooltip();
@@ -384,6 +389,12 @@ public:
 		for (auto& i : items)
 			i->render();
 	}
+	bool isAnimating() {
+		for (auto& i : items)
+			if (i->isAnimating())
+				return true;
+		return false;
+	}
 	int handleEvent(const SDL_Event &ev);
 	Menu *getLastMenu() {
 		MenuItemBack *bi = NULL;
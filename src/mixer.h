@@ -30,15 +30,17 @@ public:
 			Mix_FreeChunk(chunk);
 	}
 	int load(const string &fname) {
-		if (chunk) {
-			Mix_FreeChunk(chunk);
-			chunk = NULL;
-		}
-		if ((chunk = Mix_LoadWAV(fname.c_str())) == NULL) {
+		Mix_Chunk *c = Mix_LoadWAV(fname.c_str());
+		if (c == NULL)
 			_logsdlerr();
-			return 0;
-		}
-		return 1;
+		return load(c);
+	}
+	/* take ownership of an already decoded chunk (may be NULL) */
+	int load(Mix_Chunk *c) {
+		if (chunk)
+			Mix_FreeChunk(chunk);
+		chunk = c;
+		return (chunk != NULL);
 	}
 };
 
@@ -22,11 +22,47 @@ int Geom::sh = 480;
 bool Image::useColorKeyBlack = false; /* workaround for old color key in lbr2 themes */
 
 SDL_Renderer *mrc = NULL; /* main window render context, got only one */
+RenderStats renderStats;
+
+/** Texture helpers to keep track of created/destroyed textures */
+static SDL_Texture *createTexture(int w, int h)
+{
+	SDL_Texture *t = SDL_CreateTexture(mrc,SDL_PIXELFORMAT_RGBA8888,
+					SDL_TEXTUREACCESS_TARGET,w,h);
+	if (t) {
+		renderStats.texCreated++;
+		renderStats.texLive++;
+	}
+	return t;
+}
+static SDL_Texture *createTextureFromSurface(SDL_Surface *s)
+{
+	SDL_Texture *t = SDL_CreateTextureFromSurface(mrc,s);
+	if (t) {
+		renderStats.texCreated++;
+		renderStats.texLive++;
+	}
+	return t;
+}
+static void destroyTexture(SDL_Texture *t)
+{
+	SDL_DestroyTexture(t);
+	renderStats.texDestroyed++;
+	renderStats.texLive--;
+}
+
+int setRenderTarget(SDL_Texture *t)
+{
+	renderStats.targetSwitches++;
+	return SDL_SetRenderTarget(mrc,t);
+}
 
 /** Main application window */
 
-MainWindow::MainWindow(const char *title, int _w, int _h, int _full)
+MainWindow::MainWindow(const char *title, int _w, int _h, int _full, int _vsync)
 {
+	Uint32 flags = SDL_RENDERER_ACCELERATED;
+
 	if (_w <= 0 || _h <= 0) { /* no width or height, use desktop setting */
 		SDL_DisplayMode mode;
 		SDL_GetCurrentDisplayMode(0,&mode);
@@ -36,6 +72,7 @@ MainWindow::MainWindow(const char *title, int _w, int _h, int _full)
 	}
 	w = _w;
 	h = _h;
+	vsync = _vsync;
 	/* TEST  w = 1600; h = 1200; flags = 0; */
 	Geom::sw = w;
 	Geom::sh = h;
@@ -48,7 +85,9 @@ MainWindow::MainWindow(const char *title, int _w, int _h, int _full)
 					SDL_WINDOWPOS_CENTERED, w, h, 0);
 	if(mw == NULL)
 		_logsdlerr();
-	if ((mr = SDL_CreateRenderer(mw, -1, SDL_RENDERER_ACCELERATED)) == NULL)
+	if (_vsync)
+		flags |= SDL_RENDERER_PRESENTVSYNC;
+	if ((mr = SDL_CreateRenderer(mw, -1, flags)) == NULL)
 		_logsdlerr();
 	mrc = mr;
 
@@ -80,14 +119,13 @@ int Image::create(int w, int h)
 	_logdebug(1,"Creating new texture of size %dx%d\n",w,h);
 
 	if (tex) {
-		SDL_DestroyTexture(tex);
+		destroyTexture(tex);
 		tex = NULL;
 	}
 
 	this->w = w;
 	this->h = h;
-	if ((tex = SDL_CreateTexture(mrc,SDL_PIXELFORMAT_RGBA8888,
-				SDL_TEXTUREACCESS_TARGET,w, h)) == NULL) {
+	if ((tex = createTexture(w,h)) == NULL) {
 		_logsdlerr();
 		return 0;
 	}
@@ -117,6 +155,35 @@ int Image::createFromScreen()
 	return ret;
 }
 
+/** Read back texture into new ARGB8888 surface. Only works for textures
+ * that can be used as render target and is slow, so only use it to cache
+ * results of expensive rendering. */
+SDL_Surface *Image::readSurface()
+{
+	int access;
+
+	if (tex == NULL || SDL_QueryTexture(tex, NULL, &access, NULL, NULL) < 0 ||
+					access != SDL_TEXTUREACCESS_TARGET)
+		return NULL;
+
+	SDL_Surface *surf = SDL_CreateRGBSurface(0, w, h, 32,
+			0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+	if (surf == NULL) {
+		_logsdlerr();
+		return NULL;
+	}
+	SDL_Texture *oldTarget = SDL_GetRenderTarget(mrc);
+	setRenderTarget(tex);
+	if (SDL_RenderReadPixels(mrc, NULL, SDL_PIXELFORMAT_ARGB8888,
+					surf->pixels, surf->pitch) < 0) {
+		_logsdlerr();
+		SDL_FreeSurface(surf);
+		surf = NULL;
+	}
+	setRenderTarget(oldTarget);
+	return surf;
+}
+
 /** OLD STUFF FOR SOFTWARE SCALE AS FALLBACK */
 
 /** Set pixel in surface. */
@@ -167,6 +234,20 @@ SDL_Surface *create_small_surface(SDL_Surface *src) {
 
 /** OLD STUFF END */
 
+/** Load image from file as software surface. Black is set as color key
+ * if requested for old images. Return NULL on error. */
+SDL_Surface *Image::loadSurface(const string& fname)
+{
+	SDL_Surface *surf = IMG_Load(fname.c_str());
+	if (surf == NULL) {
+		_logsdlerr();
+		return NULL;
+	}
+	if (Image::useColorKeyBlack)
+		SDL_SetColorKey(surf, SDL_TRUE, 0x0);
+	return surf;
+}
+
 /** Load image from file. Return
  *   1 on success without any problems
  *   2 on successfully loading surface but failing to create hardware texture
@@ -177,30 +258,41 @@ int Image::load(const string& fname)
 {
 	_logdebug(1,"Loading texture %s\n",fname.c_str());
 
+	/* load image as software surface */
+	SDL_Surface *surf = loadSurface(fname);
+	if (surf == NULL) {
+		/* delete old texture */
+		if (tex) {
+			destroyTexture(tex);
+			tex = NULL;
+		}
+		w = 0;
+		h = 0;
+		return 0;
+	}
+	int ret = load(surf);
+	SDL_FreeSurface(surf);
+	return ret;
+}
+
+/** Create texture from (already decoded) surface. Return values are the
+ * same as for loading from file. Surface is not freed. */
+int Image::load(SDL_Surface *s)
+{
+	_logdebug(1,"Loading texture from surface %dx%d\n",s->w,s->h);
+
 	/* delete old texture */
 	if (tex) {
-		SDL_DestroyTexture(tex);
+		destroyTexture(tex);
 		tex = NULL;
 	}
 	w = 0;
 	h = 0;
 
-	/* load image as software surface */
-	SDL_Surface *surf = IMG_Load(fname.c_str());
-	if (surf == NULL) {
-		_logsdlerr();
-		return 0;
-	}
-
-	/* set black as color key if requested for old images */
-	if (Image::useColorKeyBlack)
-		SDL_SetColorKey(surf, SDL_TRUE, 0x0);
-
 	/* create hardware texture from software surface */
-	if ((tex = SDL_CreateTextureFromSurface(mrc, surf))) {
-		w = surf->w;
-		h = surf->h;
-		SDL_FreeSurface(surf);
+	if ((tex = createTextureFromSurface(s))) {
+		w = s->w;
+		h = s->h;
 		return 1;
 	}
 	_logsdlerr();
@@ -211,48 +303,28 @@ int Image::load(const string& fname)
 	 * retry once before we give up. */
 
 	/* get new surface half the size */
-	SDL_Surface *newsurf = create_small_surface(surf);
+	SDL_Surface *newsurf = create_small_surface(s);
 	if (newsurf == 0) {
 		_logsdlerr();
-		SDL_FreeSurface(surf);
 		return 0;
 	}
 
 	/* create texture with new surface */
 	int ret = 0;
-	if ((tex = SDL_CreateTextureFromSurface(mrc, newsurf))) {
+	if ((tex = createTextureFromSurface(newsurf))) {
 		w = newsurf->w;
 		h = newsurf->h;
 		ret = 2;
 	}
-	SDL_FreeSurface(surf);
 	SDL_FreeSurface(newsurf);
 	return ret;
 }
-
-int Image::load(SDL_Surface *s)
-{
-	_logdebug(1,"Loading texture from surface %dx%d\n",s->w,s->h);
-
-	if (tex) {
-		SDL_DestroyTexture(tex);
-		tex = NULL;
-	}
-
-	if ((tex = SDL_CreateTextureFromSurface(mrc,s)) == NULL) {
-		_logsdlerr();
-		return 0;
-	}
-	w = s->w;
-	h = s->h;
-	return 1;
-}
 int Image::load(Image *s, int x, int y, int w, int h)
 {
 	_logdebug(1,"Loading texture from surface %dx%d\n",s->w,s->h);
 
 	if (tex) {
-		SDL_DestroyTexture(tex);
+		destroyTexture(tex);
 		tex = NULL;
 	}
 
@@ -261,14 +333,13 @@ int Image::load(Image *s, int x, int y, int w, int h)
 
 	this->w = w;
 	this->h = h;
-	if ((tex = SDL_CreateTexture(mrc,SDL_PIXELFORMAT_RGBA8888,
-				SDL_TEXTUREACCESS_TARGET,w, h)) == NULL) {
+	if ((tex = createTexture(w,h)) == NULL) {
 		_logsdlerr();
 		return 0;
 	}
-	SDL_SetRenderTarget(mrc, tex);
+	setRenderTarget(tex);
 	SDL_RenderCopy(mrc, s->getTex(), &srect, &drect);
-	SDL_SetRenderTarget(mrc, NULL);
+	setRenderTarget(NULL);
 	return 1;
 }
 
@@ -282,6 +353,7 @@ void Image::copy() /* full scale */
 	if (tex == NULL)
 		return;
 
+	renderStats.drawCalls++;
 	SDL_RenderCopy(mrc, tex, NULL, NULL);
 }
 void Image::copy(int dx, int dy)
@@ -290,6 +362,7 @@ void Image::copy(int dx, int dy)
 		return;
 
 	SDL_Rect drect = {dx , dy , w, h};
+	renderStats.drawCalls++;
 	SDL_RenderCopy(mrc, tex, NULL, &drect);
 }
 void Image::copy(int dx, int dy, int dw, int dh)
@@ -298,6 +371,7 @@ void Image::copy(int dx, int dy, int dw, int dh)
 		return;
 
 	SDL_Rect drect = {dx , dy , dw, dh};
+	renderStats.drawCalls++;
 	SDL_RenderCopy(mrc, tex, NULL, &drect);
 }
 void Image::copy(int sx, int sy, int sw, int sh, int dx, int dy) {
@@ -306,24 +380,25 @@ void Image::copy(int sx, int sy, int sw, int sh, int dx, int dy) {
 
 	SDL_Rect srect = {sx, sy, sw, sh};
 	SDL_Rect drect = {dx , dy , sw, sh};
+	renderStats.drawCalls++;
 	SDL_RenderCopy(mrc, tex, &srect, &drect);
 }
 
 void Image::fill(Uint8 r, Uint8 g, Uint8 b, Uint8 a) {
 	SDL_Texture *old = SDL_GetRenderTarget(mrc);
-	SDL_SetRenderTarget(mrc,tex);
+	setRenderTarget(tex);
 	SDL_SetRenderDrawColor(mrc,r,g,b,a);
 	SDL_RenderClear(mrc);
-	SDL_SetRenderTarget(mrc,old);
+	setRenderTarget(old);
 }
 
 void Image::fill(int x, int y, int w, int h, const SDL_Color &c) {
 	SDL_Rect r = {x,y,w,h};
 	SDL_Texture *old = SDL_GetRenderTarget(mrc);
-	SDL_SetRenderTarget(mrc,tex);
+	setRenderTarget(tex);
 	SDL_SetRenderDrawColor(mrc,c.r,c.g,c.b,c.a);
 	SDL_RenderFillRect(mrc, &r);
-	SDL_SetRenderTarget(mrc,old);
+	setRenderTarget(old);
 }
 
 void Image::scale(int nw, int nh)
@@ -336,65 +411,61 @@ void Image::scale(int nw, int nh)
 		return; /* already ok */
 
 	SDL_Texture *newtex = 0;
-	if ((newtex = SDL_CreateTexture(mrc,SDL_PIXELFORMAT_RGBA8888,
-					SDL_TEXTUREACCESS_TARGET,nw,nh)) == NULL) {
+	if ((newtex = createTexture(nw,nh)) == NULL) {
 		_logsdlerr();
 		return;
 	}
 	SDL_Texture *oldTarget = SDL_GetRenderTarget(mrc);
-	SDL_SetRenderTarget(mrc, newtex);
+	setRenderTarget(newtex);
 	SDL_SetTextureBlendMode(newtex, SDL_BLENDMODE_BLEND);
 	SDL_SetRenderDrawColor(mrc,0,0,0,0);
 	SDL_RenderClear(mrc);
 	SDL_RenderCopy(mrc, tex, NULL, NULL);
-	SDL_SetRenderTarget(mrc, oldTarget);
+	setRenderTarget(oldTarget);
 
-	SDL_DestroyTexture(tex);
+	destroyTexture(tex);
 	tex = newtex;
 	w = nw;
 	h = nh;
 }
 
-/** Create shadow image by clearing all r,g,b to 0 and cutting alpha in half. */
-int Image::createShadow(Image &img)
+/** Create shadow surface from s by clearing all r,g,b to 0 and cutting
+ * alpha in half. Color keys are converted to alpha. Done on the CPU
+ * before the first upload as reading back textures stalls the GPU. */
+SDL_Surface *Image::createShadowSurface(SDL_Surface *s)
 {
-	_logdebug(1,"Creating shadow of size %dx%d\n",
-				img.getWidth(),img.getHeight());
+	SDL_Surface *shadow;
 
-	/* duplicate first */
-	create(img.getWidth(),img.getHeight());
-	SDL_Texture *oldTarget = SDL_GetRenderTarget(mrc);
-	SDL_SetRenderTarget(mrc, tex);
-	img.copy(0,0);
-
-	/* change and apply */
-	Uint32 *pixels = (Uint32*)calloc(w*h,sizeof(Uint32));
-	if (!pixels) {
-		_logerr("Cannot allocate pixel buffer of size %dx%d\n",w,h);
-		SDL_SetRenderTarget(mrc, oldTarget);
-		return 0;
-	}
-	int pitch = w*sizeof(Uint32);
-	Uint8 r,g,b,a;
-	Uint32 pft = 0;
-	SDL_QueryTexture(tex, &pft, 0, 0, 0);
-	SDL_PixelFormat* pf = SDL_AllocFormat(pft);
-	if (SDL_RenderReadPixels(mrc, NULL, pft, pixels, pitch) < 0) {
+	if ((shadow = SDL_ConvertSurfaceFormat(s,
+				SDL_PIXELFORMAT_ARGB8888, 0)) == NULL) {
 		_logsdlerr();
-		free(pixels);
-		SDL_SetRenderTarget(mrc, oldTarget);
-		return 0;
+		return NULL;
 	}
-	for (int i = 0; i < w * h; i++) {
-		SDL_GetRGBA(pixels[i],pf,&r,&g,&b,&a);
-		pixels[i] = SDL_MapRGBA(pf,0,0,0,a/2);
+
+	_logdebug(1,"Creating shadow of size %dx%d\n",shadow->w,shadow->h);
+
+	/* alpha is the upper byte, so shift halves it and mask
+	 * clears the rest; simple enough to be vectorized */
+	SDL_LockSurface(shadow);
+	for (int j = 0; j < shadow->h; j++) {
+		Uint32 *pixels = (Uint32*)((Uint8*)shadow->pixels + j*shadow->pitch);
+		for (int i = 0; i < shadow->w; i++)
+			pixels[i] = (pixels[i] >> 1) & 0x7f000000;
 	}
-	SDL_UpdateTexture(tex, NULL, pixels, pitch);
-	SDL_FreeFormat(pf);
-	SDL_SetRenderTarget(mrc, oldTarget);
-	free(pixels);
+	SDL_UnlockSurface(shadow);
+	return shadow;
+}
 
-	return 1;
+/** Create shadow image from surface. */
+int Image::createShadow(SDL_Surface *s)
+{
+	SDL_Surface *shadow = createShadowSurface(s);
+	if (shadow == NULL)
+		return 0;
+	int ret = load(shadow);
+	SDL_FreeSurface(shadow);
+	setBlendMode(1);
+	return ret;
 }
 
 /** Grid image: large bitmap with same sized icons */
@@ -420,7 +491,14 @@ int GridImage::load(SDL_Surface *s, int _gw, int _gh)
 {
 	gw = _gw;
 	gh = _gh;
-	return Image::load(s);
+	int ret = Image::load(s);
+	if (ret == 2) {
+		gw /= 2;
+		gh /= 2;
+		_logerr("Grid image too large for hardware texture: scaled to half size %dx%d\n",
+				gw,gh);
+	}
+	return ret;
 }
 
 void GridImage::copy(int gx, int gy, int dx, int dy)
@@ -430,6 +508,7 @@ void GridImage::copy(int gx, int gy, int dx, int dy)
 
 	SDL_Rect srect = {gx * gw, gy * gh, gw, gh};
 	SDL_Rect drect = {dx , dy , gw, gh};
+	renderStats.drawCalls++;
 	SDL_RenderCopy(mrc, tex, &srect, &drect);
 }
 void GridImage::copy(int gx, int gy, int dx, int dy, int dw, int dh)
@@ -439,6 +518,7 @@ void GridImage::copy(int gx, int gy, int dx, int dy, int dw, int dh)
 
 	SDL_Rect srect = {gx * gw, gy * gh, gw, gh};
 	SDL_Rect drect = {dx , dy , dw, dh};
+	renderStats.drawCalls++;
 	SDL_RenderCopy(mrc, tex, &srect, &drect);
 }
 void GridImage::copy(int gx, int gy, int sx, int sy, int sw, int sh, int dx, int dy)
@@ -448,6 +528,7 @@ void GridImage::copy(int gx, int gy, int sx, int sy, int sw, int sh, int dx, int
 
 	SDL_Rect srect = {gx * gw + sx, gy * gh + sy, sw, sh};
 	SDL_Rect drect = {dx , dy , sw, sh};
+	renderStats.drawCalls++;
 	SDL_RenderCopy(mrc, tex, &srect, &drect);
 }
 
@@ -467,12 +548,11 @@ void GridImage::scale(int ncw, int nch)
 	if (nw == w && nh == h)
 		return; /* already ok */
 
-	if ((newtex = SDL_CreateTexture(mrc,SDL_PIXELFORMAT_RGBA8888,
-					SDL_TEXTUREACCESS_TARGET,nw,nh)) == NULL) {
+	if ((newtex = createTexture(nw,nh)) == NULL) {
 		_logsdlerr();
 		return;
 	}
-	SDL_SetRenderTarget(mrc, newtex);
+	setRenderTarget(newtex);
 	SDL_SetTextureBlendMode(newtex, SDL_BLENDMODE_BLEND);
 	SDL_SetRenderDrawColor(mrc,0,0,0,0);
 	SDL_RenderClear(mrc);
@@ -484,9 +564,9 @@ void GridImage::scale(int ncw, int nch)
 			drect.y = j * nch;
 			SDL_RenderCopy(mrc, tex, &srect, &drect);
 		}
-	SDL_SetRenderTarget(mrc, NULL);
+	setRenderTarget(NULL);
 
-	SDL_DestroyTexture(tex);
+	destroyTexture(tex);
 	tex = newtex;
 	w = nw;
 	h = nh;
@@ -494,11 +574,11 @@ void GridImage::scale(int ncw, int nch)
 	gh = nch;
 }
 
-int GridImage::createShadow(GridImage &img)
+int GridImage::createShadow(SDL_Surface *s, int _gw, int _gh)
 {
-	gw = img.getGridWidth();
-	gh = img.getGridHeight();
-	return Image::createShadow(img);
+	gw = _gw;
+	gh = _gh;
+	return Image::createShadow(s);
 }
 
 
@@ -554,7 +634,8 @@ void Font::write(int x, int y, const string& _str, int alpha) {
 
 	if ((surf = TTF_RenderUTF8_Blended(font, str, clr)) == NULL)
 		_logsdlerr();
-	if ((tex = SDL_CreateTextureFromSurface(mrc, surf)) == NULL)
+	renderStats.textRenders++;
+	if ((tex = createTextureFromSurface(surf)) == NULL)
 		_logsdlerr();
 	if (align & ALIGN_X_LEFT)
 		drect.x = x;
@@ -581,19 +662,22 @@ void Font::write(int x, int y, const string& _str, int alpha) {
 		SDL_Color clr2 = { 0,0,0,255 };
 		if ((surf2 = TTF_RenderUTF8_Blended(font, str, clr2)) == NULL)
 			_logsdlerr();
-		if ((tex2 = SDL_CreateTextureFromSurface(mrc, surf2)) == NULL)
+		renderStats.textRenders++;
+		if ((tex2 = createTextureFromSurface(surf2)) == NULL)
 			_logsdlerr();
 		drect2.x += size/10;
 		drect2.y += size/10;
 		SDL_SetTextureAlphaMod(tex2, alpha/2);
 		SDL_RenderCopy(mrc, tex2, NULL, &drect2);
+		renderStats.drawCalls++;
 		SDL_FreeSurface(surf2);
-		SDL_DestroyTexture(tex2);
+		destroyTexture(tex2);
 	}
 
 	SDL_RenderCopy(mrc, tex, NULL, &drect);
+	renderStats.drawCalls++;
 	SDL_FreeSurface(surf);
-	SDL_DestroyTexture(tex);
+	destroyTexture(tex);
 }
 void Font::writeText(int x, int y, const string& _text, int wrapwidth, int alpha)
 {
@@ -612,7 +696,8 @@ void Font::writeText(int x, int y, const string& _text, int wrapwidth, int alpha
 
 	if ((surf = TTF_RenderUTF8_Blended_Wrapped(font, text, clr, wrapwidth)) == NULL)
 		_logsdlerr();
-	if ((tex = SDL_CreateTextureFromSurface(mrc, surf)) == NULL)
+	renderStats.textRenders++;
+	if ((tex = createTextureFromSurface(surf)) == NULL)
 		_logsdlerr();
 	drect.x = x;
 	drect.y = y;
@@ -621,8 +706,47 @@ void Font::writeText(int x, int y, const string& _text, int wrapwidth, int alpha
 	if (alpha < 255)
 		SDL_SetTextureAlphaMod(tex, alpha);
 	SDL_RenderCopy(mrc, tex, NULL, &drect);
+	renderStats.drawCalls++;
 	SDL_FreeSurface(surf);
-	SDL_DestroyTexture(tex);
+	destroyTexture(tex);
+}
+
+/** Set target rate r in frames per second, 0 means no limit. */
+void FramePacer::setRate(int r, bool vs, int displayRate)
+{
+	if (r == rate && vs == vsync)
+		return;
+
+	rate = r;
+	vsync = vs;
+	next = 0;
+	freq = SDL_GetPerformanceFrequency();
+	if (rate <= 0 || (vsync && rate >= displayRate))
+		period = 0;
+	else
+		period = freq / rate;
+}
+
+/** Wait until current frame is over. */
+void FramePacer::wait()
+{
+	if (period == 0)
+		return;
+
+	Uint64 now = SDL_GetPerformanceCounter();
+	if (next == 0 || now > next + period) {
+		/* first frame or way too late: start over */
+		next = now + period;
+		return;
+	}
+	if (now < next) {
+		Uint32 ms = (next - now) * 1000 / freq;
+		if (ms > FP_SPINMS)
+			SDL_Delay(ms - FP_SPINMS);
+		while (SDL_GetPerformanceCounter() < next)
+			; /* spin */
+	}
+	next += period;
 }
 
 void Label::setText(Font &font, const string &str, uint maxw)
@@ -649,13 +773,13 @@ void Label::setText(Font &font, const string &str, uint maxw)
 	img.create(w + 4*b, h + 2*b);
 	img.fill(bgColor);
 	SDL_Texture *old = SDL_GetRenderTarget(mrc);
-	SDL_SetRenderTarget(mrc,img.getTex());
+	setRenderTarget(img.getTex());
 	if (maxw == 0) {
 		font.setAlign(ALIGN_X_CENTER | ALIGN_Y_CENTER);
 		font.write(img.getWidth()/2,img.getHeight()/2,str);
 	} else
 		font.writeText(2*b, b, str, maxw);
-	SDL_SetRenderTarget(mrc,old);
+	setRenderTarget(old);
 	empty = false;
 }
 
@@ -724,8 +848,21 @@ int runEditDialog(Font &font, const string &caption, string &str)
 	font.setAlign(ALIGN_X_CENTER | ALIGN_Y_CENTER);
 
 	SDL_StartTextInput();
+	bool redraw = true;
 	while (!done) {
-		if (SDL_PollEvent(&event)) {
+		/* redraw */
+		if (redraw) {
+			SDL_SetRenderDrawColor(mrc,0,0,0,255);
+			SDL_RenderClear(mrc);
+			img.copy();
+			string text(caption + ": " + str);
+			font.write(img.getWidth()/2,img.getHeight()/2,text);
+			SDL_RenderPresent(mrc);
+			redraw = false;
+		}
+
+		if (SDL_WaitEventTimeout(&event, IDLE_TIMEOUT)) {
+			redraw = true;
 			switch (event.type) {
 			case SDL_QUIT:
 				done = true;
@@ -751,17 +888,11 @@ int runEditDialog(Font &font, const string &caption, string &str)
 			case SDL_TEXTINPUT:
 				str += event.text.text;
 				break;
+			case SDL_MOUSEMOTION:
+				redraw = false;
+				break;
 			}
 		}
-
-		/* redraw */
-		SDL_SetRenderDrawColor(mrc,0,0,0,255);
-		SDL_RenderClear(mrc);
-		img.copy();
-		string text(caption + ": " + str);
-		font.write(img.getWidth()/2,img.getHeight()/2,text);
-		SDL_RenderPresent(mrc);
-		SDL_Delay(10);
 		SDL_FlushEvent(SDL_MOUSEMOTION);
 	}
 	SDL_StopTextInput();
@@ -803,12 +934,17 @@ int waitForConfirmation()
 
 	SDL_StartTextInput();
 	while (!done) {
-		if (SDL_PollEvent(&event)) {
+		if (SDL_WaitEventTimeout(&event, IDLE_TIMEOUT)) {
 			switch (event.type) {
 			case SDL_QUIT:
 				done = true;
 				ret = -1;
 				break;
+			case SDL_WINDOWEVENT:
+				/* window contents might be lost */
+				sshot.copy();
+				SDL_RenderPresent(mrc);
+				break;
 			case SDL_KEYDOWN:
 				switch (event.key.keysym.scancode) {
 				case SDL_SCANCODE_ESCAPE: /* ESC = cancel */
@@ -834,10 +970,6 @@ int waitForConfirmation()
 				break;
 			}
 		}
-
-		SDL_Delay(20);
-		sshot.copy();
-		SDL_RenderPresent(mrc);
 		SDL_FlushEvent(SDL_MOUSEMOTION);
 	}
 	SDL_StopTextInput();
@@ -22,13 +22,43 @@
 #include <SDL2/SDL_mixer.h>
 #include "tools.h"
 
+/** Render statistics. Per frame counters are increased by Image, GridImage
+ * and Font and cleared by View with startFrame(). Times are in ms. */
+class RenderStats {
+public:
+	Uint32 drawCalls; /* SDL_RenderCopy issued by Image, GridImage, Font */
+	Uint32 targetSwitches;
+	Uint32 texCreated;
+	Uint32 texDestroyed;
+	Uint32 textRenders; /* TTF rasterisations */
+	int texLive; /* not reset per frame */
+	Uint32 sprites;
+	double simTime, renderTime, presentTime;
+
+	RenderStats() : texLive(0) {
+		startFrame();
+	}
+	void startFrame() {
+		drawCalls = targetSwitches = texCreated = texDestroyed = 0;
+		textRenders = sprites = 0;
+		simTime = renderTime = presentTime = 0;
+	}
+	/** Return ms passed since performance counter value start. */
+	static double since(Uint64 start) {
+		return (SDL_GetPerformanceCounter() - start) * 1000.0 /
+					SDL_GetPerformanceFrequency();
+	}
+};
+extern RenderStats renderStats;
+
 class MainWindow {
 public:
 	SDL_Window* mw;
 	SDL_Renderer* mr;
 	int w, h;
+	int vsync; /* renderer presents in sync with display */
 
-	MainWindow(const char *title, int _w, int _h, int _full = 0);
+	MainWindow(const char *title, int _w, int _h, int _full = 0, int _vsync = 0);
 	~MainWindow();
 	int getWidth() { return w; }
 	int getHeight() { return h; }
@@ -37,6 +67,14 @@ public:
 			return SDL_GetWindowDisplayIndex(mw);
 		return 0;
 	}
+	/** Refresh rate of current display, 60 if unknown. */
+	int getRefreshRate() {
+		SDL_DisplayMode mode;
+		if (SDL_GetCurrentDisplayMode(getDisplayIndex(),&mode) < 0 ||
+							mode.refresh_rate <= 0)
+			return 60;
+		return mode.refresh_rate;
+	}
 	void refresh();
 
 	static int getModeNames(vector<string> &list) {
@@ -116,6 +154,8 @@ public:
 				src->format->BytesPerPixel );
 		return pixel;
 	}
+	static SDL_Surface *loadSurface(const string& fname);
+	static SDL_Surface *createShadowSurface(SDL_Surface *s);
 	static void setRenderScaleQuality(int level) {
 		SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY,to_string(level).c_str());
 	}
@@ -125,11 +165,20 @@ public:
 		create(_w,_h);
 	}
 	~Image() {
-		if (tex)
+		destroy();
+	}
+	void destroy() {
+		if (tex) {
 			SDL_DestroyTexture(tex);
+			renderStats.texDestroyed++;
+			renderStats.texLive--;
+			tex = NULL;
+		}
+		w = h = 0;
 	}
 	int create(int w=0, int h=0);
 	int createFromScreen();
+	SDL_Surface *readSurface();
 	int load(const string& fname);
 	int load(SDL_Surface *s);
 	int load(Image *s, int x, int y, int w, int h);
@@ -145,6 +194,9 @@ public:
 	int getHeight() {return h;}
 	void setAlpha(int alpha) { SDL_SetTextureAlphaMod(tex, alpha); }
 	void clearAlpha() { setAlpha(255); }
+	void setColorMod(Uint8 r, Uint8 g, Uint8 b) {
+		SDL_SetTextureColorMod(tex, r, g, b);
+	}
 	void setBlendMode(int on) {
 		SDL_SetTextureBlendMode(tex,
 				on?SDL_BLENDMODE_BLEND:SDL_BLENDMODE_NONE);
@@ -159,7 +211,7 @@ public:
 		fill(x,y,w,h,c);
 	}
 	void scale(int nw, int nh);
-	int createShadow(Image &img);
+	int createShadow(SDL_Surface *s);
 };
 
 class GridImage : public Image
@@ -177,7 +229,7 @@ public:
 	void copy(int gx, int gy, int dx, int dy, int dw, int dh);
 	void copy(int gx, int gy, int sx, int sy, int sw, int sh, int dx, int dy);
 	void scale(int ncw, int nch);
-	int createShadow(GridImage &img);
+	int createShadow(SDL_Surface *s, int _gw, int _gh);
 };
 
 #define ALIGN_X_LEFT	1
@@ -223,6 +275,7 @@ public:
 		*w = *h = 0;
 		SDL_Surface *surf = TTF_RenderUTF8_Blended_Wrapped(
 						font, str.c_str(), clr, maxw);
+		renderStats.textRenders++;
 		if (surf) { /* any way to do this without rendering? */
 			*w = surf->w;
 			*h = surf->h;
@@ -263,6 +316,26 @@ public:
 	}
 };
 
+/** Pace frames to a target rate. Most of the remaining frame time is
+ * slept away, the last bit is spun on the performance counter as
+ * SDL_Delay() is too coarse. If vsync is enabled and the rate is not
+ * below the display rate, presenting already blocks so we don't wait. */
+enum {
+	FP_SPINMS = 2
+};
+class FramePacer {
+	Uint64 freq;
+	Uint64 period; /* in performance counter ticks, 0 = no limit */
+	Uint64 next; /* when current frame ends, 0 = not started */
+	int rate;
+	bool vsync;
+public:
+	FramePacer() : freq(0), period(0), next(0), rate(-1), vsync(false) {}
+	void setRate(int r, bool vs, int displayRate);
+	void reset() { next = 0; }
+	void wait();
+};
+
 class Label {
 	bool empty;
 	Image img;
@@ -362,6 +435,16 @@ public:
 	const Uint8 *update();
 };
 
+/** Static screens (menu, dialogs, pause) block on events and redraw only
+ * on input or animation. Timeout in ms to wake up anyway. */
+enum {
+	IDLE_TIMEOUT = 500
+};
+
+/** Set render target of main renderer. Use this instead of
+ * SDL_SetRenderTarget() to have target switches counted. */
+int setRenderTarget(SDL_Texture *t);
+
 /** Run a standalone dialog for editing a UTF8 string. ESC cancels editing
  * (string is not changed), Enter confirms changes. Return 1 if string was
  * changed, 0 if not changed. */
@@ -23,98 +23,89 @@
 extern SDL_Renderer *mrc;
 extern Brick_Conv brick_conv_table[BRICK_COUNT];
 
-SetInfo::SetInfo(const string &n, Theme &theme)
+/** Set levelset info from index entry e (NULL for special sets). */
+SetInfo::SetInfo(const string &n, const SetIndexEntry *e) : lastUse(0)
 {
 	name = n;
 	levels = 0;
 	version = "1.00"; /* default if not found */
 	author = "?";
 
-	/* create empty preview */
+	if (n[0] == '!') { /* special levels */
+		version = "1.00";
+		author = "LGames";
+		levels = 1;
+		return;
+	}
+	if (e == NULL) {
+		_logerr("Levelset %s not found, no preview created\n",n.c_str());
+		return;
+	}
+	version = e->version;
+	author = e->author;
+	levels = e->levels;
+	firstLevel = e->firstLevel;
+}
+
+/** Render preview with wallpaper wid, frame and bricks of first level. */
+void SetInfo::createPreview(Theme &theme, uint wid)
+{
 	uint sw = theme.menuBackground.getWidth();
 	uint sh = theme.menuBackground.getHeight();
 	uint bw = theme.bricks.getGridWidth();
 	uint bh = theme.bricks.getGridHeight();
 	uint soff = bh/3;
+	SDL_Texture *oldTarget = SDL_GetRenderTarget(mrc);
+
 	preview.create(MAPWIDTH*theme.bricks.getGridWidth(),
 			MAPHEIGHT*theme.bricks.getGridHeight());
-	SDL_SetRenderTarget(mrc, preview.getTex());
-	Image& wallpaper = theme.wallpapers[rand()%theme.numWallpapers];
+	setRenderTarget(preview.getTex());
+	Image& wallpaper = theme.getWallpaper(wid);
 	for (uint wy = 0; wy < sh; wy += wallpaper.getHeight())
 		for (uint wx = 0; wx < sw; wx += wallpaper.getWidth())
 			wallpaper.copy(wx,wy);
 	theme.frameShadow.copy(soff,soff);
 
-	if (n[0] == '!') { /* special levels */
-		version = "1.00";
-		author = "LGames";
-		levels = 1;
+	if (name[0] == '!') { /* special levels */
 		/* finalize empty level */
 		theme.fMenuNormal.setAlign(ALIGN_X_CENTER | ALIGN_Y_CENTER);
-		if (n == TOURNAMENT)
+		if (name == TOURNAMENT)
 			theme.fMenuNormal.write(preview.getWidth()/2,preview.getHeight()/2,_("Superset with ALL levels"));
 		else
 			theme.fMenuNormal.write(preview.getWidth()/2,preview.getHeight()/2,_("Mini Game"));
 		theme.frame.copy(0,0);
-		SDL_SetRenderTarget(mrc, NULL);
-		return;
-	}
-
-	/* get normal levelset info */
-	string fpath = getFullLevelsetPath(n);
-	string lines[5+EDIT_HEIGHT];
-	ifstream ifs(fpath);
-	uint offset = 0;
-
-	if (!ifs.is_open()) {
-		_logerr("Levelset %s not found, no preview created\n",n.c_str());
-		theme.frame.copy(0,0);
-		SDL_SetRenderTarget(mrc, NULL);
+		setRenderTarget(oldTarget);
 		return;
 	}
-	for (uint i = 0; i < 5+EDIT_HEIGHT; i++)
-		readLine(ifs,lines[i]);
-	if (lines[0].find("Version") != string::npos) {
-		version = trimString(lines[0].substr(lines[0].find(':')+1));
-		offset = 1;
-	}
-	author = lines[1 + offset];
-
-	/* count levels */
-	levels = 1;
-	while (readLine(ifs, lines[0]))
-		if (lines[0].find("Level:") != string::npos)
-			levels++;
-	ifs.close();
 
 	/* add bricks of first level
 	 * XXX direct access to brick conversion table from libgame */
-	for (uint j = 0; j < EDITHEIGHT; j++)
-		for (uint i = 0; i < EDITWIDTH; i++) {
+	for (uint j = 0; j < firstLevel.size(); j++)
+		for (uint i = 0; i < EDITWIDTH && i < firstLevel[j].size(); i++) {
 			int k = -1;
 			for ( k = 0; k < BRICK_COUNT; k++ )
-				if (lines[4+offset+j][i] == brick_conv_table[k].c)
+				if (firstLevel[j][i] == brick_conv_table[k].c)
 					break;
 			if (k < BRICK_COUNT && k != INVIS_BRICK_ID)
 				theme.bricksShadow.copy(brick_conv_table[k].id,0,
 						(i+1)*bw+bh/3, (1+j)*bh+bh/3);
 		}
-	for (uint j = 0; j < EDITHEIGHT; j++)
-		for (uint i = 0; i < EDITWIDTH; i++) {
+	for (uint j = 0; j < firstLevel.size(); j++)
+		for (uint i = 0; i < EDITWIDTH && i < firstLevel[j].size(); i++) {
 			int k = -1;
 			for ( k = 0; k < BRICK_COUNT; k++ )
-				if (lines[4+offset+j][i] == brick_conv_table[k].c)
+				if (firstLevel[j][i] == brick_conv_table[k].c)
 					break;
 			if (k < BRICK_COUNT && k != INVIS_BRICK_ID)
 				theme.bricks.copy(brick_conv_table[k].id,0,
 							(i+1)*bw, (1+j)*bh);
 		}
 	theme.frame.copy(0,0);
-	SDL_SetRenderTarget(mrc, NULL);
+	setRenderTarget(oldTarget);
 }
 
 
-/** Create levelset list and previews + layout. */
+/** Create levelset list and layout. Previews are created on demand. */
 void SelectDialog::init(int sd_type)
 {
 	uint sw = theme.menuBackground.getWidth();
@@ -169,11 +160,25 @@ void SelectDialog::init(int sd_type)
 
 	background.createFromScreen();
 
+	/* get levelset infos from index, in custom only mode names
+	 * are listed without ~ so add it for lookup */
+	vector<string> keys;
+	for (auto& e : list) {
+		if (e == "LBreakoutHD")
+			continue;
+		keys.push_back((sd_type == SDT_CUSTOMONLY) ? "~" + e : e);
+	}
+	setIndex.update(keys);
+
 	entries.clear();
+	numPreviews = 0;
+	useCounter = 0;
+	wallpaperId = rand() % theme.numWallpapers;
+	uint kid = 0;
 	for (auto& e : list) {
 		if (e == "LBreakoutHD")
 			continue;
-		SetInfo *si = new SetInfo(e, theme);
+		SetInfo *si = new SetInfo(e, setIndex.get(keys[kid++]));
 		entries.push_back(unique_ptr<SetInfo>(si));
 	}
 	/* select first entry if any */
@@ -219,7 +224,7 @@ void SelectDialog::render()
 
 	if (sel >= 0) {
 		SetInfo *si = entries[sel].get();
-		si->preview.copy(px,py,pw,ph);
+		getPreview(sel).copy(px,py,pw,ph);
 		string str = si->name + " v" + si->version + _(" by ") + si->author;
 		font.setAlign(ALIGN_X_CENTER | ALIGN_Y_TOP);
 		font.setColor(theme.menuFontColorNormal);
@@ -229,6 +234,53 @@ void SelectDialog::render()
 	}
 }
 
+/** Return preview of entry id. Create it if needed and drop least
+ * recently used previews if there are too many. */
+Image &SelectDialog::getPreview(uint id)
+{
+	SetInfo *si = entries[id].get();
+
+	si->lastUse = ++useCounter;
+	if (si->hasPreview())
+		return si->preview;
+
+	si->createPreview(theme, wallpaperId);
+	numPreviews++;
+	while (numPreviews > SD_MAXPREVIEWS) {
+		SetInfo *lru = NULL;
+		for (auto &e : entries)
+			if (e.get() != si && e->hasPreview() &&
+					(lru == NULL || e->lastUse < lru->lastUse))
+				lru = e.get();
+		if (lru == NULL)
+			break;
+		lru->freePreview();
+		numPreviews--;
+	}
+	return si->preview;
+}
+
+/** Create one missing preview next to selection (or first entry of
+ * viewport) before it is needed. Return true if one was created. */
+bool SelectDialog::prefetchPreview()
+{
+	int center = (sel >= 0) ? sel : (int)pos;
+
+	for (int d = 0; d <= SD_PREFETCHRANGE; d++)
+		for (int s = 1; s >= -1; s -= 2) {
+			int id = center + s*d;
+			if (id < 0 || id >= (int)entries.size() ||
+					entries[id]->hasPreview())
+				continue;
+			/* don't push the selection out of the LRU */
+			if (sel >= 0)
+				entries[sel]->lastUse = ++useCounter;
+			getPreview(id);
+			return true;
+		}
+	return false;
+}
+
 /* Return 1 if selection made, 0 otherwise */
 int SelectDialog::run()
 {
@@ -237,76 +289,81 @@ int SelectDialog::run()
 	int ret = 0;
 
 	render();
+	SDL_RenderPresent(mrc);
 	while (!quitReceived && !leave) {
-		/* handle events */
-		if (SDL_WaitEvent(&ev)) {
-			if (ev.type == SDL_QUIT)
-				quitReceived = true;
-			if (ev.type == SDL_KEYDOWN) {
-				switch (ev.key.keysym.scancode) {
-				case SDL_SCANCODE_ESCAPE:
-					leave = true;
-					break;
-				case SDL_SCANCODE_PAGEUP:
-					changeSelection(-vlen);
-					break;
-				case SDL_SCANCODE_PAGEDOWN:
-					changeSelection(vlen);
-					break;
-				case SDL_SCANCODE_UP:
-					changeSelection(-1);
-					break;
-				case SDL_SCANCODE_DOWN:
-					changeSelection(1);
-					break;
-				default:
-					break;
-				}
-			}
-			if (ev.type == SDL_MOUSEMOTION) {
-				int oldsel = sel;
-				if (ev.motion.x >= lx && ev.motion.y >= ly &&
-						ev.motion.x < (int)(lx + cw) &&
-						ev.motion.y < int(ly + ch*vlen)) {
-					sel = pos + (ev.motion.y - ly)/ch;
-					if ((uint)sel >= entries.size())
-						sel = entries.size()-1;
-				} else if (ev.motion.y < ly)
-					sel = SEL_PREV;
-				else if (ev.motion.y > int(ly + ch*vlen))
-					sel = SEL_NEXT;
-				else
-					sel = SEL_NONE;
-				if (sel != oldsel)
-					mixer.play(theme.sMenuMotion);
-			}
-			if (ev.type == SDL_MOUSEWHEEL) {
-				if (ev.wheel.y < 0) {
-					goNextPage();
-					sel = SEL_NONE;
-				} else if (ev.wheel.y > 0) {
-					goPrevPage();
-					sel = SEL_NONE;
-				}
+		/* handle events, create previews ahead while idle */
+		if (!SDL_PollEvent(&ev)) {
+			if (prefetchPreview())
+				continue;
+			if (!SDL_WaitEventTimeout(&ev, IDLE_TIMEOUT))
+				continue;
+		}
+		if (ev.type == SDL_QUIT)
+			quitReceived = true;
+		if (ev.type == SDL_KEYDOWN) {
+			switch (ev.key.keysym.scancode) {
+			case SDL_SCANCODE_ESCAPE:
+				leave = true;
+				break;
+			case SDL_SCANCODE_PAGEUP:
+				changeSelection(-vlen);
+				break;
+			case SDL_SCANCODE_PAGEDOWN:
+				changeSelection(vlen);
+				break;
+			case SDL_SCANCODE_UP:
+				changeSelection(-1);
+				break;
+			case SDL_SCANCODE_DOWN:
+				changeSelection(1);
+				break;
+			default:
+				break;
 			}
-			if (ev.type == SDL_MOUSEBUTTONDOWN) {
-				if (sel == SEL_PREV)
-					goPrevPage();
-				else if (sel == SEL_NEXT)
-					goNextPage();
-				else if (sel != SEL_NONE) {
-					ret = 1;
-					leave = true;
-				}
-				if (sel != SEL_NONE)
-					mixer.play(theme.sMenuClick);
+		}
+		if (ev.type == SDL_MOUSEMOTION) {
+			int oldsel = sel;
+			if (ev.motion.x >= lx && ev.motion.y >= ly &&
+					ev.motion.x < (int)(lx + cw) &&
+					ev.motion.y < int(ly + ch*vlen)) {
+				sel = pos + (ev.motion.y - ly)/ch;
+				if ((uint)sel >= entries.size())
+					sel = entries.size()-1;
+			} else if (ev.motion.y < ly)
+				sel = SEL_PREV;
+			else if (ev.motion.y > int(ly + ch*vlen))
+				sel = SEL_NEXT;
+			else
+				sel = SEL_NONE;
+			if (sel != oldsel)
+				mixer.play(theme.sMenuMotion);
+		}
+		if (ev.type == SDL_MOUSEWHEEL) {
+			if (ev.wheel.y < 0) {
+				goNextPage();
+				sel = SEL_NONE;
+			} else if (ev.wheel.y > 0) {
+				goPrevPage();
+				sel = SEL_NONE;
 			}
-			if (ev.type == SDL_KEYDOWN && sel >= 0 &&
-					ev.key.keysym.scancode == SDL_SCANCODE_RETURN) {
+		}
+		if (ev.type == SDL_MOUSEBUTTONDOWN) {
+			if (sel == SEL_PREV)
+				goPrevPage();
+			else if (sel == SEL_NEXT)
+				goNextPage();
+			else if (sel != SEL_NONE) {
 				ret = 1;
 				leave = true;
-				mixer.play(theme.sMenuClick);
 			}
+			if (sel != SEL_NONE)
+				mixer.play(theme.sMenuClick);
+		}
+		if (ev.type == SDL_KEYDOWN && sel >= 0 &&
+				ev.key.keysym.scancode == SDL_SCANCODE_RETURN) {
+			ret = 1;
+			leave = true;
+			mixer.play(theme.sMenuClick);
 		}
 		/* render */
 		render();
@@ -22,16 +22,23 @@ class SetInfo {
 	string version;
 	string author;
 	uint levels;
-	Image preview;
+	vector<string> firstLevel; /* brick lines for preview */
+	Image preview; /* created on demand */
+	uint lastUse;
 public:
-	SetInfo(const string &name, Theme &theme);
-
+	SetInfo(const string &name, const SetIndexEntry *e);
+	void createPreview(Theme &theme, uint wid);
+	bool hasPreview() { return preview.getTex() != NULL; }
+	void freePreview() { preview.destroy(); }
 };
 
 enum {
 	SDT_ALL = 0,
 	SDT_CUSTOMONLY,
 
+	SD_MAXPREVIEWS = 8, /* textures kept */
+	SD_PREFETCHRANGE = 2, /* entries before/after selection */
+
 	SEL_NONE = -1,
 	SEL_PREV = -2,
 	SEL_NEXT = -3
@@ -40,6 +47,7 @@ enum {
 class SelectDialog {
 	Theme &theme;
 	Mixer &mixer;
+	LevelsetIndex &setIndex;
 	bool quitReceived;
 	vector<unique_ptr<SetInfo>> entries;
 	int sel; /* actual selection */
@@ -53,9 +61,14 @@ class SelectDialog {
 	uint pw, ph; /* preview geometry */
 
 	Image background;
+	uint numPreviews;
+	uint useCounter; /* for LRU of previews */
+	uint wallpaperId; /* same for all previews */
 
 	void render();
 	void renderPreview();
+	Image &getPreview(uint id);
+	bool prefetchPreview();
 	void goNextPage() {
 		if (pos == max)
 			return;
@@ -93,7 +106,8 @@ class SelectDialog {
 		}
 	}
 public:
-	SelectDialog(Theme &t, Mixer &m) : theme(t), mixer(m), quitReceived(false)
+	SelectDialog(Theme &t, Mixer &m, LevelsetIndex &si)
+			: theme(t), mixer(m), setIndex(si), quitReceived(false)
 	{
 		sel = SEL_NONE;
 		pos = max = vlen = 0;
@@ -101,6 +115,7 @@ public:
 		lx = ly = 0;
 		cw = ch = 0;
 		px = py = pw = ph = 0;
+		numPreviews = useCounter = wallpaperId = 0;
 	}
 	void init(int sd_type = SDT_ALL);
 	int run();
@@ -0,0 +1,213 @@
+/*
+ * setindex.cpp
+ */
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "tools.h"
+#include "../libgame/levels.h"
+#include "setindex.h"
+
+/** Load index from config dir. Format is one line per field:
+ * name, stamp, hash, version, author, level count, level hashes
+ * (separated by spaces), EDITHEIGHT brick rows. */
+LevelsetIndex::LevelsetIndex() : changed(false)
+{
+	string line;
+
+	if (string(CONFIGDIR) == ".")
+		fname = "./levelsets.idx";
+	else
+		fname = getHomeDir() + "/" + CONFIGDIR + "/levelsets.idx";
+
+	ifstream ifs(fname);
+	if (!ifs.is_open()) {
+		_loginfo("No levelset index %s yet\n",fname.c_str());
+		return;
+	}
+	if (!readLine(ifs,line) || line != SETINDEX_MAGIC) {
+		_loginfo("Levelset index %s outdated, rebuilding\n",fname.c_str());
+		changed = true;
+		return;
+	}
+	string name;
+	while (readLine(ifs,name)) {
+		SetIndexEntry e;
+		readLine(ifs,e.stamp);
+		readLine(ifs,e.hash);
+		readLine(ifs,e.version);
+		readLine(ifs,e.author);
+		readLine(ifs,line);
+		e.levels = atoi(line.c_str());
+		readLine(ifs,line);
+		const char *ptr = line.c_str();
+		char *end;
+		while (1) {
+			unsigned long long h = strtoull(ptr, &end, 16);
+			if (end == ptr)
+				break;
+			e.levelHashes.push_back(h);
+			ptr = end;
+		}
+		for (uint j = 0; j < EDITHEIGHT; j++) {
+			if (!readLine(ifs,line))
+				break;
+			e.firstLevel.push_back(line);
+		}
+		if (e.firstLevel.size() != EDITHEIGHT) {
+			_logerr("Levelset index %s corrupted, rebuilding\n",fname.c_str());
+			entries.clear();
+			changed = true;
+			break;
+		}
+		e.found = false;
+		entries[name] = e;
+	}
+	ifs.close();
+	_logdebug(1,"Loaded levelset index %s (%d sets)\n",fname.c_str(),(int)entries.size());
+}
+
+void LevelsetIndex::save()
+{
+	if (!changed)
+		return;
+
+	ofstream ofs(fname);
+	if (!ofs.is_open()) {
+		_logerr("Could not write levelset index %s\n",fname.c_str());
+		return;
+	}
+	ofs << SETINDEX_MAGIC << "\n";
+	for (auto &it : entries) {
+		const SetIndexEntry &e = it.second;
+		ofs << it.first << "\n" << e.stamp << "\n" << e.hash << "\n";
+		ofs << e.version << "\n" << e.author << "\n" << e.levels << "\n";
+		for (uint i = 0; i < e.levelHashes.size(); i++)
+			ofs << (i?" ":"") << hashToString(e.levelHashes[i]);
+		ofs << "\n";
+		for (auto &row : e.firstLevel)
+			ofs << row << "\n";
+	}
+	ofs.close();
+	changed = false;
+	_logdebug(1,"Saved levelset index %s\n",fname.c_str());
+}
+
+/** Read info from levelset file. Return 1 on success, 0 otherwise. */
+int LevelsetIndex::scan(const string &name, SetIndexEntry &e)
+{
+	string fpath = getFullLevelsetPath(name);
+	string line;
+	uint lid = 0; /* line id */
+	uint offset = 0;
+	uint64_t hash = FNV_OFFSET;
+
+	_logdebug(1,"Scanning levelset %s\n",fpath.c_str());
+
+	e.stamp = fileStamp(fpath);
+	e.version = "1.00"; /* default if not found */
+	e.author = "?";
+	e.levels = 0;
+	e.firstLevel.assign(EDITHEIGHT, string(EDITWIDTH,'.'));
+
+	ifstream ifs(fpath);
+	if (!ifs.is_open()) {
+		_logerr("Levelset %s not found\n",name.c_str());
+		return 0;
+	}
+	while (readLine(ifs,line)) {
+		hash = fnv1a(line.c_str(), line.size(), hash);
+		hash = fnv1a("\n", 1, hash);
+
+		if (lid == 0 && line.find("Version") != string::npos) {
+			e.version = trimString(line.substr(line.find(':')+1));
+			offset = 1;
+		} else if (lid == 1 + offset)
+			e.author = line;
+		else if (lid >= 4 + offset && lid < 4 + offset + EDITHEIGHT)
+			e.firstLevel[lid - 4 - offset] = line;
+		if (line.find("Level:") != string::npos)
+			e.levels++;
+		lid++;
+	}
+	ifs.close();
+	e.hash = hashToString(hash);
+
+	/* get level hashes as computed by game on load */
+	FILE *file = levelset_open(name.c_str(), (char*)"rb");
+	if (file) {
+		int version, update;
+		Level *l;
+		levelset_get_version(file, &version, &update);
+		while ((l = level_load(file)) != NULL) {
+			e.levelHashes.push_back(l->hash);
+			level_delete(l);
+		}
+		fclose(file);
+	}
+	return 1;
+}
+
+/** Return info of levelset name. Entry is (re)scanned if missing or
+ * outdated. NULL is returned for special sets (! in front) and if file
+ * can't be read. Pointer is valid until next call to update(). */
+const SetIndexEntry *LevelsetIndex::get(const string &name)
+{
+	if (name.empty() || name[0] == '!')
+		return NULL;
+
+	auto it = entries.find(name);
+	if (it != entries.end() &&
+			it->second.stamp == fileStamp(getFullLevelsetPath(name))) {
+		it->second.found = true;
+		return &it->second;
+	}
+
+	SetIndexEntry e;
+	if (!scan(name, e)) {
+		if (it != entries.end()) {
+			entries.erase(it);
+			changed = true;
+		}
+		return NULL;
+	}
+	e.found = true;
+	entries[name] = e;
+	changed = true;
+	return &entries[name];
+}
+
+/** Validate index for names of levelsets (as read from directories),
+ * rescan outdated ones and drop sets that no longer exist. Names may be
+ * a subset of all sets. Save if changed. */
+void LevelsetIndex::update(const vector<string> &names)
+{
+	for (auto &it : entries)
+		it.second.found = false;
+	for (auto &n : names)
+		get(n);
+	for (auto it = entries.begin(); it != entries.end(); ) {
+		if (!it->second.found &&
+				fileStamp(getFullLevelsetPath(it->first)).empty()) {
+			it = entries.erase(it);
+			changed = true;
+		} else
+			++it;
+	}
+	save();
+}
+
+/** Drop entry after levelset was written so it is rescanned when needed
+ * even if file stamp did not change (same second and size). */
+void LevelsetIndex::invalidate(const string &name)
+{
+	if (entries.erase(name) > 0)
+		changed = true;
+}
@@ -0,0 +1,50 @@
+/*
+ * setindex.h
+ */
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SRC_SETINDEX_H_
+#define SRC_SETINDEX_H_
+
+#define SETINDEX_MAGIC "LBreakoutHD levelset index 2"
+
+/** Info of a levelset file as needed by menus. */
+typedef struct {
+	string stamp; /* modification time and size of file */
+	string hash; /* of normalized file content */
+	string version;
+	string author;
+	uint levels;
+	vector<unsigned long long> levelHashes; /* content hash of each level */
+	vector<string> firstLevel; /* brick rows of first level */
+	bool found; /* seen during last update */
+} SetIndexEntry;
+
+/** Persistent index of levelset infos in config dir so that menus don't
+ * have to parse all levelset files whenever they are opened. Entries are
+ * keyed by levelset name (~ in front for custom sets), validated by file
+ * stamp and rescanned if outdated. */
+class LevelsetIndex {
+	string fname;
+	map<string, SetIndexEntry> entries;
+	bool changed;
+
+	int scan(const string &name, SetIndexEntry &e);
+public:
+	LevelsetIndex();
+	~LevelsetIndex() { save(); }
+	void save();
+	const SetIndexEntry *get(const string &name);
+	void update(const vector<string> &names);
+	void invalidate(const string &name);
+};
+
+#endif /* SRC_SETINDEX_H_ */
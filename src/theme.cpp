@@ -16,6 +16,7 @@
 #include "sdl.h"
 #include "mixer.h"
 #include "clientgame.h"
+#include "assets.h"
 #include "theme.h"
 
 extern SDL_Renderer *mrc;
@@ -28,6 +29,7 @@ void Theme::load(string name, uint screenWidth, uint screenHeight,
 {
 	string path, fpath;
 	uint iw, ih;
+	SDL_Surface *surf;
 
 	if (name[0] == '~')
 		path = getHomeDir() + "/" + CONFIGDIR + "/themes/" + name.substr(1);
@@ -142,39 +144,194 @@ void Theme::load(string name, uint screenWidth, uint screenHeight,
 	/* adjust shadow offset to screen geometry */
 	shadowOffset = shadowOffset * brickScreenHeight / brickFileHeight;
 
-	/* load bricks */
-	if (fileExists(path + "/bricks.png"))
-		bricks.load(path + "/bricks.png",brickFileWidth,brickFileHeight);
+	/* up to 10 wallpapers, either all from theme or all standard.
+	 * they are only loaded when used, see getWallpaper(). */
+	string wpath = stdPath;
+	wpFileBrickWidth = sbfw;
+	wpFileBrickHeight = sbfh;
+	wpBrickWidth = brickScreenWidth;
+	wpBrickHeight = brickScreenHeight;
+	if (fileExists(path + "/back0.png") || fileExists(path + "/back0.jpg")) {
+		wpath = path;
+		wpFileBrickWidth = brickFileWidth;
+		wpFileBrickHeight = brickFileHeight;
+	}
+	if (wpLoader)
+		wpLoader->finish();
+	wpPrefetchId = -1;
+	for (int i = 0; i < WPCACHESIZE; i++) {
+		wallpapers[i].destroy();
+		wpSlotIds[i] = -1;
+		wpSlotUsed[i] = 0;
+	}
+	wallpaperNames.clear();
+	for (int i = 0; i < MAXWALLPAPERS; i++) {
+		string wfname = wpath + "/back" + to_string(i);
+		if (fileExists(wfname + ".png"))
+			wfname += ".png";
+		else if (fileExists(wfname + ".jpg"))
+			wfname += ".jpg";
+		else
+			break;
+		wallpaperNames.push_back(wfname);
+	}
+	numWallpapers = wallpaperNames.size();
+
+	/* menu background */
+	string mbfname = stdPath + "/menuback.jpg";
+	bool mbStd = false;
+	if (fileExists(path + "/menuback.png"))
+		mbfname = path + "/menuback.png";
+	else if (fileExists(path + "/menuback.jpg"))
+		mbfname = path + "/menuback.jpg";
 	else
-		bricks.load(stdPath + "/bricks.png",sbfw,sbfh);
-	bricks.scale(brickScreenWidth,brickScreenHeight);
+		mbStd = true;
+
+	/* sounds */
+	struct {
+		Sound *snd;
+		const char *fname;
+	} sounds[] = {
+		{ &sReflectBrick, "reflectbrick.wav" },
+		{ &sReflectPaddle, "reflectpaddle.wav" },
+		{ &sBrickHit, "brickhit.wav" },
+		{ &sExplosion, "explosion.wav" },
+		{ &sEnergyHit, "energyhit.wav" },
+		{ &sShot, "shot.wav" },
+		{ &sAttach, "attach.wav" },
+		{ &sClick, "click.wav" },
+		{ &sDamn, "damn.wav" },
+		{ &sDammit, "dammit.wav" },
+		{ &sExcellent, "excellent.wav" },
+		{ &sVeryGood, "verygood.wav" },
+		{ &sMenuClick, "menuclick.wav" },
+		{ &sMenuMotion, "menumotion.wav" },
+		{ &sExtras[EX_SCORE200], "score.wav" },
+		{ &sExtras[EX_SCORE500], "score.wav" },
+		{ &sExtras[EX_SCORE1000], "score.wav" },
+		{ &sExtras[EX_SCORE2000], "score.wav" },
+		{ &sExtras[EX_SCORE5000], "score.wav" },
+		{ &sExtras[EX_SCORE10000], "score.wav" },
+		{ &sExtras[EX_GOLDSHOWER], "score.wav" },
+		{ &sExtras[EX_SHORTEN], "shrink.wav" },
+		{ &sExtras[EX_LENGTHEN], "expand.wav" },
+		{ &sExtras[EX_LIFE], "gainlife.wav" },
+		{ &sExtras[EX_SLIME], "attach.wav" },
+		{ &sExtras[EX_METAL], "energyhit.wav" },
+		{ &sExtras[EX_BALL], "extraball.wav" },
+		{ &sExtras[EX_WALL], "wall.wav" },
+		{ &sExtras[EX_FROZEN], "freeze.wav" },
+		{ &sExtras[EX_WEAPON], "standard.wav" },
+		{ &sExtras[EX_RANDOM], "standard.wav" },
+		{ &sExtras[EX_FAST], "speedup.wav" },
+		{ &sExtras[EX_SLOW], "speeddown.wav" },
+		{ &sExtras[EX_JOKER], "joker.wav" },
+		{ &sExtras[EX_DARKNESS], "darkness.wav" },
+		{ &sExtras[EX_CHAOS], "chaos.wav" },
+		{ &sExtras[EX_GHOST_PADDLE], "ghost.wav" },
+		{ &sExtras[EX_DISABLE], "disable.wav" },
+		{ &sExtras[EX_TIME_ADD], "timeadd.wav" },
+		{ &sExtras[EX_EXPL_BALL], "explball.wav" },
+		{ &sExtras[EX_BONUS_MAGNET], "bonusmagnet.wav" },
+		{ &sExtras[EX_MALUS_MAGNET], "malusmagnet.wav" },
+		{ &sExtras[EX_WEAK_BALL], "weakball.wav" },
+		{ &sLooseLife, "looselife.wav" }
+	};
+
+	/* scaled images are cached per theme and resolution, anything
+	 * else that changes scaling results goes into the stamp */
+	AssetCache cache;
+	string cdir = (string(CONFIGDIR) == ".") ? "." : getHomeDir() + "/" + CONFIGDIR;
+	cache.init(cdir + "/cache", name, screenWidth, screenHeight,
+			to_string(brickScreenWidth) + "x" + to_string(brickScreenHeight) +
+			"|" + to_string(antialiasing) +
+			"|" + fileStamp(path + "/theme.ini") +
+			"|" + fileStamp(stdPath + "/theme.ini"));
+
+	/* decode all image and sound files in parallel, textures are
+	 * created below on this thread when the results are taken.
+	 * images found in cache don't need to be decoded. */
+	AssetLoader al;
+	loader = &al;
+	const char *imgIds[] = { "bricks", "extras", "paddle", "ball", "shot",
+			"weapon", "life", "shine", "explosions" };
+	for (auto id : imgIds) {
+		fpath = testRc(path,string(id) + ".png");
+		if (!cache.isValid(id,fpath))
+			al.addImage(fpath);
+	}
+	if (fileExists(path + "/frame.png")) {
+		if (!cache.isValid("frame",path + "/frame.png"))
+			al.addImage(path + "/frame.png");
+	} else if (fileExists(path + "/fr_left.png")) {
+		al.addImage(path + "/fr_left.png");
+		al.addImage(path + "/fr_right.png");
+		al.addImage(path + "/fr_top.png");
+	}
+	string warpfname = oldTheme ? stdPath + "/warp.png" : testRc(path,"warp.png");
+	if (!cache.isValid("warp",warpfname))
+		al.addImage(warpfname);
+	al.addImage(mbfname);
+	for (auto &s : sounds)
+		al.addSound(testRc(path,s.fname));
+	al.start();
+
+	/* load bricks */
+	fpath = testRc(path,"bricks.png");
+	if (!cache.load("bricks", fpath, bricks, bricksShadow)) {
+		if (fileExists(path + "/bricks.png"))
+			loadWithShadow(loadSurface(path + "/bricks.png"),
+					bricks, bricksShadow,
+					brickFileWidth, brickFileHeight,
+					brickScreenWidth, brickScreenHeight);
+		else
+			loadWithShadow(loadSurface(stdPath + "/bricks.png"),
+					bricks, bricksShadow, sbfw, sbfh,
+					brickScreenWidth, brickScreenHeight);
+		cache.save("bricks", fpath, bricks, bricksShadow);
+	}
 
 	/* load extras */
-	if (fileExists(path + "/extras.png")) {
-		if (oldTheme) {
-			SDL_Surface *surf = IMG_Load(string(path + "/extras.png").c_str());
-			/* last extra column is for color key, none otherwise */
-			if (Image::getWidth(path + "/extras.png") & 1) {
-				Uint32 ckey = Image::getSurfacePixel(surf,surf->w-1,0);
-				SDL_SetColorKey(surf,SDL_TRUE,ckey);
-			}
-			extras.load(surf, brickFileWidth, brickFileHeight);
-			SDL_FreeSurface(surf);
+	fpath = testRc(path,"extras.png");
+	if (!cache.load("extras", fpath, extras, extrasShadow)) {
+		if (fileExists(path + "/extras.png")) {
+			if (oldTheme) {
+				surf = takeSurface(path + "/extras.png");
+				/* last extra column is for color key, none otherwise */
+				if (surf && (surf->w & 1)) {
+					Uint32 ckey = Image::getSurfacePixel(surf,surf->w-1,0);
+					SDL_SetColorKey(surf,SDL_TRUE,ckey);
+				}
+			} else
+				surf = loadSurface(path + "/extras.png");
+			loadWithShadow(surf, extras, extrasShadow,
+					brickFileWidth, brickFileHeight,
+					brickScreenWidth, brickScreenHeight);
 		} else
-			extras.load(path + "/extras.png",brickFileWidth,brickFileHeight);
-	} else
-		extras.load(stdPath + "/extras.png",sbfw,sbfh);
-	extras.scale(brickScreenWidth,brickScreenHeight);
+			loadWithShadow(loadSurface(stdPath + "/extras.png"),
+					extras, extrasShadow, sbfw, sbfh,
+					brickScreenWidth, brickScreenHeight);
+		cache.save("extras", fpath, extras, extrasShadow);
+	}
 
 	/* either load frame.png
 	 * or create frame from left,top,right part
 	 * or create standard frame with wall bricks */
 	if (fileExists(path + "/frame.png")) {
-		frame.load(path + "/frame.png");
-		if (brickFileHeight != brickScreenHeight) {
-			int nw = frame.getWidth() * brickScreenWidth / brickFileWidth;
-			int nh = frame.getHeight() * brickScreenHeight / brickFileHeight;
-			frame.scale(nw, nh);
+		if (!cache.load("frame", path + "/frame.png", frame, frameShadow)) {
+			SDL_Surface *surf = loadSurface(path + "/frame.png");
+			if (surf) {
+				frame.load(surf);
+				frameShadow.createShadow(surf);
+				SDL_FreeSurface(surf);
+			}
+			if (brickFileHeight != brickScreenHeight) {
+				int nw = frame.getWidth() * brickScreenWidth / brickFileWidth;
+				int nh = frame.getHeight() * brickScreenHeight / brickFileHeight;
+				frame.scale(nw, nh);
+				frameShadow.scale(nw, nh);
+			}
+			cache.save("frame", path + "/frame.png", frame, frameShadow);
 		}
 	} else if (fileExists(path + "/fr_left.png")) {
 		frame.create(screenWidth,screenHeight);
@@ -182,12 +339,10 @@ void Theme::load(string name, uint screenWidth, uint screenHeight,
 
 		/* we need to set fr_right:w-1,0 as colorkey so we have to use
 		 * surfaces here... */
-		SDL_Surface *sfleft = IMG_Load(string(path + "/fr_left.png").c_str());
-		SDL_Surface *sfright = IMG_Load(string(path + "/fr_right.png").c_str());
-		SDL_Surface *sftop = IMG_Load(string(path + "/fr_top.png").c_str());
-		if (sfleft == NULL || sfright == NULL || sftop == NULL)
-			_logsdlerr();
-		else {
+		SDL_Surface *sfleft = takeSurface(path + "/fr_left.png");
+		SDL_Surface *sfright = takeSurface(path + "/fr_right.png");
+		SDL_Surface *sftop = takeSurface(path + "/fr_top.png");
+		if (sfleft && sfright && sftop) {
 			/* convert all surfaces to same pixel format so ckey matches */
 			SDL_Surface *oldsurf = sfleft;
 			sfleft = SDL_ConvertSurface(sfleft,sfright->format,0);
@@ -206,7 +361,7 @@ void Theme::load(string name, uint screenWidth, uint screenHeight,
 			ftop.load(sftop);
 
 			SDL_Texture *oldTex = SDL_GetRenderTarget(mrc);
-			SDL_SetRenderTarget(mrc,frame.getTex());
+			setRenderTarget(frame.getTex());
 
 			fleft.copy(0,0,brickScreenWidth,screenHeight);
 			ftop.copy(brickScreenWidth,0,(MAPWIDTH-2)*brickScreenWidth,brickScreenHeight);
@@ -222,7 +377,7 @@ void Theme::load(string name, uint screenWidth, uint screenHeight,
 			addBox(frame, boardX, brickScreenHeight*18, boardWidth,
 							5*brickScreenHeight);
 
-			SDL_SetRenderTarget(mrc,oldTex);
+			setRenderTarget(oldTex);
 		}
 		if (sfleft)
 			SDL_FreeSurface(sfleft);
@@ -230,13 +385,14 @@ void Theme::load(string name, uint screenWidth, uint screenHeight,
 			SDL_FreeSurface(sfright);
 		if (sftop)
 			SDL_FreeSurface(sftop);
+		createMaskShadow(frame, frameShadow);
 	} else {
 		/* do it straight in screen resolution */
 		frame.create(screenWidth,screenHeight);
 		frame.fill(0,0,0,0);
 
 		SDL_Texture *oldTex = SDL_GetRenderTarget(mrc);
-		SDL_SetRenderTarget(mrc,frame.getTex());
+		setRenderTarget(frame.getTex());
 
 		/* darken board for better reading text */
 		SDL_SetRenderDrawColor(mrc,0,0,0,160);
@@ -262,7 +418,8 @@ void Theme::load(string name, uint screenWidth, uint screenHeight,
 			bricks.copy(0, 0, screenWidth - brickScreenWidth, j*brickScreenHeight);
 		}
 
-		SDL_SetRenderTarget(mrc,oldTex);
+		setRenderTarget(oldTex);
+		createMaskShadow(frame, frameShadow);
 	}
 
 	/* paddle is 90% of brick height */
@@ -270,57 +427,40 @@ void Theme::load(string name, uint screenWidth, uint screenHeight,
 		fpath = path + "/paddle.png";
 	else
 		fpath = stdPath + "/paddle.png";
-	ih = Image::getHeight(fpath) / 4;
-	if (oldTheme && fileExists(path + "/paddle.png")) {
-		/* color key wasn't quite 0x0... */
-		SDL_Surface *surf = IMG_Load(string(path + "/paddle.png").c_str());
-		if (surf) {
-			Uint32 ckey = Image::getSurfacePixel(surf,0,0);
-			SDL_SetColorKey(surf,SDL_TRUE,ckey);
-			paddles.load(surf, ih, ih);
-			SDL_FreeSurface(surf);
-		}
-	} else
-		paddles.load(fpath, ih, ih);
-	paddles.scale(9*brickScreenHeight/10, 9*brickScreenHeight/10);
+	if (!cache.load("paddle", fpath, paddles, paddlesShadow)) {
+		/* color key of old themes wasn't quite 0x0... */
+		surf = loadSurface(fpath, oldTheme && fileExists(path + "/paddle.png"));
+		ih = surf ? surf->h / 4 : 0;
+		loadWithShadow(surf, paddles, paddlesShadow, ih, ih,
+				9*brickScreenHeight/10, 9*brickScreenHeight/10);
+		cache.save("paddle", fpath, paddles, paddlesShadow);
+	}
 
 	/* balls are 60% of brick height */
 	if (fileExists(path + "/ball.png"))
 		fpath = path + "/ball.png";
 	else
 		fpath = stdPath + "/ball.png";
-	ih = Image::getHeight(fpath);
-	if (oldTheme && fileExists(path + "/ball.png")) {
-		/* color key wasn't quite 0x0... */
-		SDL_Surface *surf = IMG_Load(string(path + "/ball.png").c_str());
-		if (surf) {
-			Uint32 ckey = Image::getSurfacePixel(surf,0,0);
-			SDL_SetColorKey(surf,SDL_TRUE,ckey);
-			balls.load(surf, ih, ih);
-			SDL_FreeSurface(surf);
-		}
-	} else
-		balls.load(fpath,ih,ih);
-	balls.scale(6*brickScreenHeight/10,6*brickScreenHeight/10);
+	if (!cache.load("ball", fpath, balls, ballsShadow)) {
+		surf = loadSurface(fpath, oldTheme && fileExists(path + "/ball.png"));
+		ih = surf ? surf->h : 0;
+		loadWithShadow(surf, balls, ballsShadow, ih, ih,
+				6*brickScreenHeight/10, 6*brickScreenHeight/10);
+		cache.save("ball", fpath, balls, ballsShadow);
+	}
 
 	/* shots are 50% of brick height */
 	if (fileExists(path + "/shot.png"))
 		fpath = path + "/shot.png";
 	else
 		fpath = stdPath + "/shot.png";
-	ih = Image::getHeight(fpath);
-	if (oldTheme && fileExists(path + "/shot.png")) {
-		/* color key wasn't quite 0x0... */
-		SDL_Surface *surf = IMG_Load(string(path + "/shot.png").c_str());
-		if (surf) {
-			Uint32 ckey = Image::getSurfacePixel(surf,0,0);
-			SDL_SetColorKey(surf,SDL_TRUE,ckey);
-			shot.load(surf, ih, ih);
-			SDL_FreeSurface(surf);
-		}
-	} else
-		shot.load(fpath,ih,ih);
-	shot.scale(5*brickScreenHeight/10,5*brickScreenHeight/10);
+	if (!cache.load("shot", fpath, shot, shotShadow)) {
+		surf = loadSurface(fpath, oldTheme && fileExists(path + "/shot.png"));
+		ih = surf ? surf->h : 0;
+		loadWithShadow(surf, shot, shotShadow, ih, ih,
+				5*brickScreenHeight/10, 5*brickScreenHeight/10);
+		cache.save("shot", fpath, shot, shotShadow);
+	}
 
 	/* weapon is 90% brick height (old weapons get scaled as width was 70%) */
 	if (fileExists(path + "/weapon.png"))
@@ -329,33 +469,54 @@ void Theme::load(string name, uint screenWidth, uint screenHeight,
 		fpath = stdPath + "/weapon.png";
 		stdSettings.get("weaponAnim.frames",weaponFrameNum);
 	}
-	iw = Image::getWidth(fpath) / weaponFrameNum;
-	ih = Image::getHeight(fpath);
-	weapon.load(fpath,iw,ih);
-	weapon.scale(9*brickScreenHeight/10,9*brickScreenHeight/10);
+	if (!cache.load("weapon", fpath, weapon)) {
+		if ((surf = loadSurface(fpath))) {
+			weapon.load(surf, surf->w / weaponFrameNum, surf->h);
+			SDL_FreeSurface(surf);
+		}
+		weapon.scale(9*brickScreenHeight/10,9*brickScreenHeight/10);
+		cache.save("weapon", fpath, weapon);
+	}
 
 	/* life symbol is brick size, vertically arranged,
 	 * first is off, second is on */
-	if (fileExists(path + "/life.png"))
-		life.load(path + "/life.png",brickFileWidth,brickFileHeight);
-	else
-		life.load(stdPath+ "/life.png",sbfw,sbfh);
-	life.scale(brickScreenWidth,brickScreenHeight);
+	fpath = testRc(path,"life.png");
+	if (!cache.load("life", fpath, life)) {
+		if ((surf = loadSurface(fpath))) {
+			if (fileExists(path + "/life.png"))
+				life.load(surf,brickFileWidth,brickFileHeight);
+			else
+				life.load(surf,sbfw,sbfh);
+			SDL_FreeSurface(surf);
+		}
+		life.scale(brickScreenWidth,brickScreenHeight);
+		cache.save("life", fpath, life);
+	}
 
 	/* shine animation is one row of brick size frames */
-	if (fileExists(path + "/shine.png"))
-		shine.load(path + "/shine.png",brickFileWidth,brickFileHeight);
-	else
-		shine.load(stdPath+ "/shine.png",sbfw,sbfh);
-	shine.scale(brickScreenWidth,brickScreenHeight);
+	fpath = testRc(path,"shine.png");
+	if (!cache.load("shine", fpath, shine)) {
+		if ((surf = loadSurface(fpath))) {
+			if (fileExists(path + "/shine.png"))
+				shine.load(surf,brickFileWidth,brickFileHeight);
+			else
+				shine.load(surf,sbfw,sbfh);
+			SDL_FreeSurface(surf);
+		}
+		shine.scale(brickScreenWidth,brickScreenHeight);
+		cache.save("shine", fpath, shine);
+	}
 
 	/* warp symbol is brick size */
 	/* ignore old warp icon as it's geometry sucks big time */
-	if (!oldTheme)
-		warpIcon.load(testRc(path,"warp.png"));
-	else
-		warpIcon.load(stdPath + "/warp.png");
-	warpIcon.scale(brickScreenWidth,brickScreenHeight);
+	if (!cache.load("warp", warpfname, warpIcon)) {
+		if ((surf = loadSurface(warpfname))) {
+			warpIcon.load(surf);
+			SDL_FreeSurface(surf);
+		}
+		warpIcon.scale(brickScreenWidth,brickScreenHeight);
+		cache.save("warp", warpfname, warpIcon);
+	}
 
 	/* explosions are square, scaled according to brick ratio */
 	if (fileExists(path + "/explosions.png"))
@@ -364,53 +525,23 @@ void Theme::load(string name, uint screenWidth, uint screenHeight,
 		fpath = stdPath + "/explosions.png";
 		stdSettings.get("explAnim.frames",explFrameNum);
 	}
-	iw = Image::getWidth(fpath) / explFrameNum;
-	explosions.load(fpath,iw,iw);
-	if (fileExists(path + "/explosions.png"))
-		explosions.scale(explosions.getGridWidth() * brickScreenWidth / brickFileWidth,
-				explosions.getGridHeight() * brickScreenHeight / brickFileHeight);
-	else
-		explosions.scale(explosions.getGridWidth() * brickScreenWidth / sbfw,
-				explosions.getGridHeight() * brickScreenHeight / sbfh);
-
-	/* load backgrounds always without color key workaround */
-	Image::useColorKeyBlack = false;
-
-	/* load and scale up to 10 wallpapers */
-	string wpath = stdPath;
-	uint wbfh = sbfh, wbfw = sbfw; /* for scaling */
-	if (fileExists(path + "/back0.png") || fileExists(path + "/back0.jpg")) {
-		wpath = path;
-		wbfh = brickFileHeight;
-		wbfw = brickFileWidth;
-	}
-	numWallpapers = 0;
-	for (int i = 0; i < MAXWALLPAPERS; i++) {
-		string wfname = wpath + "/back" + to_string(i);
-		if (fileExists(wfname + ".png"))
-			wfname += ".png";
-		else if (fileExists(wfname + ".jpg"))
-			wfname += ".jpg";
-		else
-			break;
-		wallpapers[i].load(wfname);
-		if (wbfh != brickScreenHeight) {
-			int nw, nh;
-			nw = wallpapers[i].getWidth() * brickScreenWidth / wbfw;
-			nh = wallpapers[i].getHeight() * brickScreenHeight / wbfh;
-			wallpapers[i].scale(nw, nh);
+	if (!cache.load("explosions", fpath, explosions)) {
+		if ((surf = loadSurface(fpath))) {
+			iw = surf->w / explFrameNum;
+			explosions.load(surf,iw,iw);
+			SDL_FreeSurface(surf);
 		}
-		wallpapers[i].setBlendMode(0);
-		numWallpapers++;
+		if (fileExists(path + "/explosions.png"))
+			explosions.scale(explosions.getGridWidth() * brickScreenWidth / brickFileWidth,
+					explosions.getGridHeight() * brickScreenHeight / brickFileHeight);
+		else
+			explosions.scale(explosions.getGridWidth() * brickScreenWidth / sbfw,
+					explosions.getGridHeight() * brickScreenHeight / sbfh);
+		cache.save("explosions", fpath, explosions);
 	}
 
-	/* create shadow images */
-	frameShadow.createShadow(frame);
-	bricksShadow.createShadow(bricks);
-	paddlesShadow.createShadow(paddles);
-	ballsShadow.createShadow(balls);
-	extrasShadow.createShadow(extras);
-	shotShadow.createShadow(shot);
+	/* load backgrounds always without color key workaround */
+	Image::useColorKeyBlack = false;
 
 	/* fonts */
 	if (fileExists(path + "/" + fontSmallName))
@@ -435,12 +566,11 @@ void Theme::load(string name, uint screenWidth, uint screenHeight,
 	fSmall.setColor(fontColorNormal);
 
 	/* menu stuff */
-	if (fileExists(path + "/menuback.png"))
-		menuBackground.load(path + "/menuback.png");
-	else if (fileExists(path + "/menuback.jpg"))
-		menuBackground.load(path + "/menuback.jpg");
-	else {
-		menuBackground.load(stdPath + "/menuback.jpg");
+	if ((surf = loadSurface(mbfname))) {
+		menuBackground.load(surf);
+		SDL_FreeSurface(surf);
+	}
+	if (mbStd) {
 		stdSettings.get("menu.centerX",menuX);
 		stdSettings.get("menu.centerY",menuY);
 		stdSettings.get("menu.itemWidth",menuItemWidth);
@@ -475,66 +605,156 @@ void Theme::load(string name, uint screenWidth, uint screenHeight,
 	fMenuFocus.setColor(menuFontColorFocus);
 
 	/* sounds */
-	sReflectBrick.load(testRc(path,"reflectbrick.wav"));
-	sReflectPaddle.load(testRc(path,"reflectpaddle.wav"));
-	sBrickHit.load(testRc(path,"brickhit.wav"));
-	sExplosion.load(testRc(path,"explosion.wav"));
-	sEnergyHit.load(testRc(path,"energyhit.wav"));
-	sShot.load(testRc(path,"shot.wav"));
-	sAttach.load(testRc(path,"attach.wav"));
-	sClick.load(testRc(path,"click.wav"));
-	sDamn.load(testRc(path,"damn.wav"));
-	sDammit.load(testRc(path,"dammit.wav"));
-	sExcellent.load(testRc(path,"excellent.wav"));
-	sVeryGood.load(testRc(path,"verygood.wav"));
-	sMenuClick.load(testRc(path,"menuclick.wav"));
-	sMenuMotion.load(testRc(path,"menumotion.wav"));
-	sExtras[EX_SCORE200].load(testRc(path,"score.wav"));
-	sExtras[EX_SCORE500].load(testRc(path,"score.wav"));
-	sExtras[EX_SCORE1000].load(testRc(path,"score.wav"));
-	sExtras[EX_SCORE2000].load(testRc(path,"score.wav"));
-	sExtras[EX_SCORE5000].load(testRc(path,"score.wav"));
-	sExtras[EX_SCORE10000].load(testRc(path,"score.wav"));
-	sExtras[EX_GOLDSHOWER].load(testRc(path,"score.wav"));
-	sExtras[EX_SHORTEN].load(testRc(path,"shrink.wav"));
-	sExtras[EX_LENGTHEN].load(testRc(path,"expand.wav"));
-	sExtras[EX_LIFE].load(testRc(path,"gainlife.wav"));
-	sExtras[EX_SLIME].load(testRc(path,"attach.wav"));
-	sExtras[EX_METAL].load(testRc(path,"energyhit.wav"));
-	sExtras[EX_BALL].load(testRc(path,"extraball.wav"));
-	sExtras[EX_WALL].load(testRc(path,"wall.wav"));
-	sExtras[EX_FROZEN].load(testRc(path,"freeze.wav"));
-	sExtras[EX_WEAPON].load(testRc(path,"standard.wav"));
-	sExtras[EX_RANDOM].load(testRc(path,"standard.wav"));
-	sExtras[EX_FAST].load(testRc(path,"speedup.wav"));
-	sExtras[EX_SLOW].load(testRc(path,"speeddown.wav"));
-	sExtras[EX_JOKER].load(testRc(path,"joker.wav"));
-	sExtras[EX_DARKNESS].load(testRc(path,"darkness.wav"));
-	sExtras[EX_CHAOS].load(testRc(path,"chaos.wav"));
-	sExtras[EX_GHOST_PADDLE].load(testRc(path,"ghost.wav"));
-	sExtras[EX_DISABLE].load(testRc(path,"disable.wav"));
-	sExtras[EX_TIME_ADD].load(testRc(path,"timeadd.wav"));
-	sExtras[EX_EXPL_BALL].load(testRc(path,"explball.wav"));
-	sExtras[EX_BONUS_MAGNET].load(testRc(path,"bonusmagnet.wav"));
-	sExtras[EX_MALUS_MAGNET].load(testRc(path,"malusmagnet.wav"));
-	sExtras[EX_WEAK_BALL].load(testRc(path,"weakball.wav"));
-	sLooseLife.load(testRc(path,"looselife.wav"));
+	for (auto &s : sounds)
+		s.snd->load(al.takeChunk(testRc(path,s.fname)));
+
+	al.finish();
+	loader = NULL;
 }
 
+Theme::~Theme()
+{
+	if (wpLoader)
+		delete wpLoader;
+}
+
+/** Return wallpaper. Only the WPCACHESIZE most recently used wallpapers
+ * are kept as textures, others are loaded (or taken from prefetch) and
+ * scaled on demand. */
+Image &Theme::getWallpaper(uint id)
+{
+	int slot = 0;
+
+	if (id >= numWallpapers)
+		id = 0;
+	for (int i = 0; i < WPCACHESIZE; i++) {
+		if (wpSlotIds[i] == (int)id) {
+			wpSlotUsed[i] = ++wpUseCounter;
+			return wallpapers[i];
+		}
+		if (wpSlotUsed[i] < wpSlotUsed[slot])
+			slot = i;
+	}
+
+	/* replace least recently used wallpaper */
+	if (wpLoader == NULL)
+		wpLoader = new AssetLoader();
+	if (wpPrefetchId == (int)id)
+		wpPrefetchId = -1;
+	wallpapers[slot].destroy();
+	wpSlotIds[slot] = id;
+	wpSlotUsed[slot] = ++wpUseCounter;
+	if (id >= wallpaperNames.size())
+		return wallpapers[slot];
+	SDL_Surface *surf = wpLoader->takeSurface(wallpaperNames[id]);
+	if (surf == NULL)
+		return wallpapers[slot];
+	wallpapers[slot].load(surf);
+	SDL_FreeSurface(surf);
+	if (wpFileBrickHeight != wpBrickHeight) {
+		int nw, nh;
+		nw = wallpapers[slot].getWidth() * wpBrickWidth / wpFileBrickWidth;
+		nh = wallpapers[slot].getHeight() * wpBrickHeight / wpFileBrickHeight;
+		wallpapers[slot].scale(nw, nh);
+	}
+	wallpapers[slot].setBlendMode(0);
+	return wallpapers[slot];
+}
+
+/** Start decoding wallpaper in background so that getWallpaper() for it
+ * only needs to create the texture. A previous prefetch that was not
+ * used yet is stored in the cache first, usually it has just become
+ * the current wallpaper. */
+void Theme::prefetchWallpaper(uint id)
+{
+	if (id >= wallpaperNames.size() || wpPrefetchId == (int)id)
+		return;
+	for (int i = 0; i < WPCACHESIZE; i++)
+		if (wpSlotIds[i] == (int)id)
+			return;
+	if (wpPrefetchId != -1)
+		getWallpaper(wpPrefetchId);
+	if (wpLoader == NULL)
+		wpLoader = new AssetLoader();
+	wpLoader->finish();
+	wpLoader->addImage(wallpaperNames[id]);
+	wpLoader->start();
+	wpPrefetchId = id;
+}
+
+/** Add box for board. */
 void Theme::addBox(Image &img, int x, int y, int w, int h)
 {
 	SDL_Texture *oldTex = SDL_GetRenderTarget(mrc);
 
-	SDL_SetRenderTarget(mrc,img.getTex());
+	setRenderTarget(img.getTex());
 
 	SDL_SetRenderDrawColor(mrc,0,0,0,160);
 	SDL_Rect drect = {x,y,w,h};
 	SDL_RenderFillRect(mrc,&drect);
 
 	SDL_SetRenderDrawColor(mrc,fontColorNormal.r,fontColorNormal.g,
-					fontColorNormal.b,fontColorNormal.a);
+				fontColorNormal.b,fontColorNormal.a);
 	SDL_Point pts[5] = { {x,y} , {x+w-1,y}, {x+w-1,y+h-1}, {x,y+h-1}, {x,y} };
 	SDL_RenderDrawLines(mrc,pts,5);
 
-	SDL_SetRenderTarget(mrc,oldTex);
+	setRenderTarget(oldTex);
+}
+
+/** Create shadow of composed image img. img is copied as black mask
+ * and shadow alpha is applied once when drawing, so overlapping parts
+ * don't get darker. */
+void Theme::createMaskShadow(Image &img, Image &shadow)
+{
+	SDL_Texture *oldTex = SDL_GetRenderTarget(mrc);
+
+	shadow.create(img.getWidth(), img.getHeight());
+	shadow.fill(0,0,0,0);
+	setRenderTarget(shadow.getTex());
+	img.setColorMod(0,0,0);
+	img.copy(0,0);
+	img.setColorMod(255,255,255);
+	setRenderTarget(oldTex);
+	shadow.setAlpha(128);
+}
+
+/** Get decoded surface from loader or load it directly if not loading
+ * a theme. No color key is set. */
+SDL_Surface *Theme::takeSurface(const string &fname)
+{
+	if (loader)
+		return loader->takeSurface(fname);
+	SDL_Surface *surf = IMG_Load(fname.c_str());
+	if (surf == NULL)
+		_logsdlerr();
+	return surf;
+}
+
+/** Load surface from file. If ckeyTopLeft is set, use top left pixel as
+ * color key (old themes). Black is color key if Image::useColorKeyBlack
+ * is set. */
+SDL_Surface *Theme::loadSurface(const string &fname, bool ckeyTopLeft)
+{
+	SDL_Surface *surf = takeSurface(fname);
+	if (surf && Image::useColorKeyBlack)
+		SDL_SetColorKey(surf, SDL_TRUE, 0x0);
+	if (surf && ckeyTopLeft) {
+		Uint32 ckey = Image::getSurfacePixel(surf,0,0);
+		SDL_SetColorKey(surf,SDL_TRUE,ckey);
+	}
+	return surf;
+}
+
+/** Load grid image and its shadow from the same surface and scale both
+ * to cell size cw x ch. Surface is freed. */
+void Theme::loadWithShadow(SDL_Surface *surf, GridImage &img, GridImage &shadow,
+				uint gw, uint gh, uint cw, uint ch)
+{
+	if (surf == NULL)
+		return;
+	img.load(surf, gw, gh);
+	shadow.createShadow(surf, gw, gh);
+	SDL_FreeSurface(surf);
+	img.scale(cw, ch);
+	shadow.scale(cw, ch);
 }
@@ -20,9 +20,11 @@ class Menu;
 class SelectDialog;
 class SetInfo;
 class Editor;
+class AssetLoader;
 
 enum {
-	MAXWALLPAPERS= 10
+	MAXWALLPAPERS= 10,
+	WPCACHESIZE = 2 /* wallpapers kept as texture */
 };
 
 class Theme {
@@ -64,8 +66,16 @@ class Theme {
 	SDL_Color menuFontColorNormal, menuFontColorFocus;
 
 	Image menuBackground;
-	Image wallpapers[MAXWALLPAPERS];
+	vector<string> wallpaperNames;
 	uint numWallpapers;
+	uint wpFileBrickWidth, wpFileBrickHeight; /* for scaling */
+	uint wpBrickWidth, wpBrickHeight;
+	Image wallpapers[WPCACHESIZE]; /* loaded on demand */
+	int wpSlotIds[WPCACHESIZE];
+	uint wpSlotUsed[WPCACHESIZE];
+	uint wpUseCounter;
+	AssetLoader *wpLoader; /* decodes prefetched wallpaper */
+	int wpPrefetchId;
 	Image frame, frameShadow;
 	GridImage bricks, bricksShadow;
 	GridImage paddles, paddlesShadow;
@@ -86,14 +96,18 @@ class Theme {
 	Sound sClick, sMenuClick, sMenuMotion;
 	Sound sLooseLife, sExtras[EX_NUMBER];
 
+	AssetLoader *loader; /* only set while loading */
+
 	void addBox(Image &img, int x, int y, int w, int h);
-	const string &testRc(const string &path, const string &fname) {
-		static string fpath; /* not thread safe */
+	void createMaskShadow(Image &img, Image &shadow);
+	SDL_Surface *takeSurface(const string &fname);
+	SDL_Surface *loadSurface(const string &fname, bool ckeyTopLeft = false);
+	void loadWithShadow(SDL_Surface *surf, GridImage &img, GridImage &shadow,
+				uint gw, uint gh, uint cw, uint ch);
+	string testRc(const string &path, const string &fname) {
 		if (fileExists(path + "/" + fname))
-			fpath = path + "/" + fname;
-		else
-			fpath = stdPath + "/" + fname;
-		return fpath;
+			return path + "/" + fname;
+		return stdPath + "/" + fname;
 	}
 public:
 	Theme() : oldTheme(true), boardX(0), boardWidth(0),
@@ -105,13 +119,24 @@ public:
 			shineFrameNum(0), shineAnimDelay(0),
 			menuX(0), menuY(0), menuItemWidth(0), menuItemHeight(0),
 			menuFontNormalSize(0), menuFontFocusSize(0),
-			numWallpapers(0)
+			numWallpapers(0),
+			wpFileBrickWidth(1), wpFileBrickHeight(1),
+			wpBrickWidth(1), wpBrickHeight(1),
+			wpUseCounter(0), wpLoader(NULL), wpPrefetchId(-1),
+			loader(NULL)
 		{
 		stdPath = string(DATADIR) + "/themes/Standard";
+		for (int i = 0; i < WPCACHESIZE; i++) {
+			wpSlotIds[i] = -1;
+			wpSlotUsed[i] = 0;
+		}
 	}
+	~Theme();
 	void load(string name, uint screenWidth, uint screenHeight,
 				uint brickScreenWidth, uint brickScreenHeight,
 				int antialiasing);
+	Image &getWallpaper(uint id);
+	void prefetchWallpaper(uint id);
 };
 
 #endif /* SRC_THEME_H_ */
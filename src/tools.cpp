@@ -158,6 +158,29 @@ bool fileIsWriteable(const string& name) {
 	}
 	return false;
 }
+uint64_t fnv1a(const void *data, size_t len, uint64_t h)
+{
+	const unsigned char *p = (const unsigned char*)data;
+	for (size_t i = 0; i < len; i++) {
+		h ^= p[i];
+		h *= FNV_PRIME;
+	}
+	return h;
+}
+string hashToString(uint64_t h)
+{
+	char buf[17];
+	snprintf(buf, sizeof(buf), "%016llx", (unsigned long long)h);
+	return buf;
+}
+/** Return modification time and size of file as string to detect changes
+ * or empty string if file does not exist. */
+string fileStamp(const string& name) {
+	struct stat info;
+	if (stat(name.c_str(), &info) != 0)
+		return "";
+	return to_string((long long)info.st_mtime) + "." + to_string((long long)info.st_size);
+}
 
 /** Not the nicest but hands down most efficient way to do it. */
 void strprintf(string& str, const char *fmt, ... )
@@ -175,6 +198,56 @@ void strprintf(string& str, const char *fmt, ... )
 		free(buf);
 }
 
+void FrameTimeHistogram::add(double ms)
+{
+	int i = ms * FTH_BINSPERMS;
+
+	if (i < 0)
+		i = 0;
+	if (i >= FTH_BINNUM)
+		i = FTH_BINNUM - 1;
+	bins[i]++;
+	count++;
+	if (ms > max)
+		max = ms;
+}
+
+/** Return upper bound of bin containing the p-th percentile (p=0..100). */
+double FrameTimeHistogram::getPercentile(uint p)
+{
+	if (count == 0)
+		return 0;
+
+	uint n = (uint64_t)count * p / 100, sum = 0;
+	if (n == 0)
+		n = 1;
+	for (int i = 0; i < FTH_BINNUM; i++) {
+		sum += bins[i];
+		if (sum >= n)
+			return min(max, (double)(i + 1) / FTH_BINSPERMS);
+	}
+	return max;
+}
+
+/** Count frames taking longer than ms (with bin resolution). */
+uint FrameTimeHistogram::getHitches(double ms)
+{
+	uint num = 0;
+	for (int i = ms * FTH_BINSPERMS + 1; i < FTH_BINNUM; i++)
+		num += bins[i];
+	return num;
+}
+
+/** A hitch is a frame taking more than twice the median frame time. */
+void FrameTimeHistogram::getReport(string &str)
+{
+	double p50 = getPercentile(50);
+	strprintf(str, "frames: %d, p50: %.1f ms, p95: %.1f ms, "
+			"p99: %.1f ms, max: %.1f ms, hitches: %d",
+			count, p50, getPercentile(95), getPercentile(99),
+			max, getHitches(2 * p50));
+}
+
 /** Read all file names from directory exluding .* and Makefile.*
  * Return number of read items, -1 on error.
  */
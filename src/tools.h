@@ -19,13 +19,16 @@ using namespace std;
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <dirent.h>
 #ifdef WIN32
   #include <stdint.h>
   typedef uint32_t uint;
 #endif
+#include <stdint.h>
 #include <list>
+#include <map>
 #include <string>
 #include <vector>
 #include <memory>
@@ -108,6 +111,13 @@ bool dirExists(const string& name);
 bool makeDir(const string &name);
 bool fileExists(const string& name);
 bool fileIsWriteable(const string& name);
+string fileStamp(const string& name);
+
+/** FNV-1a hash of data. Pass previous result as h to continue hashing. */
+#define FNV_PRIME 1099511628211ULL
+#define FNV_OFFSET 14695981039346656037ULL
+uint64_t fnv1a(const void *data, size_t len, uint64_t h = FNV_OFFSET);
+string hashToString(uint64_t h);
 
 /** Count continuously from start to end. Delay is in milliseconds for
  * changing counter by one (e.g. delay=1000 means it takes one second per step. */
@@ -180,6 +190,31 @@ public:
 
 void strprintf(string& str, const char *fmt, ... );
 
+/** Histogram of frame times in 0.1 ms bins. Frames taking longer than the
+ * last bin are counted there, but the max is always exact. */
+enum {
+	FTH_BINSPERMS = 10,
+	FTH_BINNUM = 250 * FTH_BINSPERMS
+};
+class FrameTimeHistogram {
+	uint bins[FTH_BINNUM];
+	uint count;
+	double max;
+public:
+	FrameTimeHistogram() { reset(); }
+	void reset() {
+		memset(bins, 0, sizeof(bins));
+		count = 0;
+		max = 0;
+	}
+	void add(double ms);
+	uint getCount() { return count; }
+	double getMax() { return max; }
+	double getPercentile(uint p);
+	uint getHitches(double ms);
+	void getReport(string &str);
+};
+
 /** Simple vector object. There is already struct Vector in libgame
  * so we call it just Vec. */
 class Vec {
@@ -24,15 +24,16 @@
 #include "view.h"
 
 extern SDL_Renderer *mrc;
-extern int last_ball_brick_reflect_x;
+extern GAME_TLS int last_ball_brick_reflect_x;
 
 View::View(Config &cfg, ClientGame &_cg)
-	: config(cfg), mw(NULL), editor(theme,mixer),
+	: config(cfg), mw(NULL), editor(theme,mixer,_cg.getSetIndex()),
 	  curMenu(NULL), graphicsMenu(NULL), resumeMenuItem(NULL),
-	  selectDlg(theme, mixer), lblCredits1(true), lblCredits2(true),
-	  cgame(_cg), quitReceived(false),
+	  selectDlg(theme, mixer, _cg.getSetIndex()), lblCredits1(true), lblCredits2(true),
+	  cgame(_cg), quitReceived(false), demoMode(false),
+	  timeScale(1), timeSteps(0), timeAccelerated(false),
 	  showWarpIcon(false), warpIconX(0), warpIconY(0),
-	  fpsCycles(0), fpsStart(0), fps(0)
+	  fpsCycles(0), fpsStart(0), fps(0), frameStart(0)
 {
 	_loginfo("Initializing SDL\n");
 	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_JOYSTICK) < 0)
@@ -158,7 +159,8 @@ void View::init(string t, uint r)
 	/* (re)create main window */
 	if (mw)
 		delete mw;
-	mw = new MainWindow("LBreakoutHD", ww, wh, (r==0) );
+	mw = new MainWindow("LBreakoutHD", ww, wh, (r==0), config.vsync);
+	pacer.reset();
 
 	/* load theme (scaled if necessary) */
 	theme.load(t, sw, sh, brickScreenWidth, brickScreenHeight, config.antialiasing);
@@ -181,7 +183,10 @@ void View::init(string t, uint r)
 	/* create render images and positions */
 	imgBackground.create(sw,sh);
 	imgBackground.setBlendMode(0);
-	curWallpaperId = rand() % theme.numWallpapers;
+	imgStatic.create(sw,sh);
+	imgStatic.setBlendMode(0);
+	nextWallpaperId = rand() % theme.numWallpapers;
+	theme.prefetchWallpaper(nextWallpaperId);
 	imgScore.create(brickScreenWidth*3, brickScreenHeight);
 	imgScoreX = theme.boardX + (theme.boardWidth - imgScore.getWidth())/2;
 	imgScoreY = brickScreenHeight * 15 + brickScreenHeight/2;
@@ -196,10 +201,10 @@ void View::init(string t, uint r)
 	imgFloor.create(EDITWIDTH*brickScreenWidth,brickScreenHeight);
 	imgFloorX = brickScreenWidth;
 	imgFloorY = (MAPHEIGHT-1)*brickScreenHeight;
-	SDL_SetRenderTarget(mrc, imgFloor.getTex());
+	setRenderTarget(imgFloor.getTex());
 	for (int i = 0; i < EDITWIDTH; i++)
 		theme.bricks.copy(1, 0, i*brickScreenWidth, 0);
-	SDL_SetRenderTarget(mrc, NULL);
+	setRenderTarget(NULL);
 	warpIconX = (MAPWIDTH - 2)*brickScreenWidth;
 	warpIconY = (MAPHEIGHT - 1)*brickScreenHeight;
 }
@@ -239,26 +244,23 @@ void View::run()
 	int flags;
 	PaddleInputState pis;
 	Ticks ticks;
-	Ticks renderTicks;
-	int maxDelay, delay = 0;
 	Uint32 ms;
 	bool leave = false;
 	bool resumeLater = false;
 	double rx = 0;
 	vector<string> text;
 
-	curWallpaperId = rand() % theme.numWallpapers;
+	nextWallpaper();
 	showWarpIcon = false;
 
 	fpsStart = SDL_GetTicks();
 	fpsCycles = 0;
+	timeScale = 1;
+	timeAccelerated = false;
 
-	if (config.fps == 1)
-		maxDelay = 5;
-	else if (config.fps == 2)
-		maxDelay = 10;
-	else
-		maxDelay = 0;
+	if (config.stats_csv)
+		openStatsFile();
+	startFrameTimes();
 
 	initTitleLabel();
 	lblInfo.clearText();
@@ -266,13 +268,21 @@ void View::run()
 	renderBackgroundImage();
 	renderBricksImage();
 	renderScoreImage();
+	renderExtrasImage();
+	renderStaticImage(CGF_UPDATEBACKGROUND);
 	render();
 
 	grabInput(1);
+	updatePacer();
+	pacer.reset();
 
 	while (!leave) {
-		renderTicks.reset();
 		flags = 0;
+		lastStats = renderStats;
+		renderStats.startFrame();
+		if (frameStart)
+			frameTimes.add(RenderStats::since(frameStart));
+		frameStart = SDL_GetPerformanceCounter();
 
 		/* handle events */
 		if (SDL_PollEvent(&ev)) {
@@ -281,7 +291,16 @@ void View::run()
 				leave = true;
 				resumeLater = true;
 			}
-			if (ev.type == SDL_KEYUP) {
+			if (demoMode) {
+				/* any input ends demo */
+				if (ev.type == SDL_KEYDOWN ||
+						ev.type == SDL_MOUSEBUTTONDOWN ||
+						ev.type == SDL_JOYBUTTONDOWN)
+					leave = true;
+				if (ev.type == SDL_MOUSEMOTION &&
+						abs(ev.motion.xrel) + abs(ev.motion.yrel) > DEMO_MOTIONLIMIT)
+					leave = true;
+			} else if (ev.type == SDL_KEYUP) {
 				switch (ev.key.keysym.scancode) {
 				case SDL_SCANCODE_F5:
 					gamepad.close();
@@ -290,10 +309,37 @@ void View::run()
 				case SDL_SCANCODE_P:
 					showInfo(_("Pause"),WT_PAUSE);
 					ticks.reset();
+					frameStart = 0;
 					break;
 				case SDL_SCANCODE_F:
 					config.show_fps = !config.show_fps;
 					break;
+				case SDL_SCANCODE_F2:
+					config.show_stats = !config.show_stats;
+					break;
+				case SDL_SCANCODE_F3:
+					config.stats_csv = !config.stats_csv;
+					if (config.stats_csv)
+						openStatsFile();
+					else
+						statsFile.close();
+					break;
+				case SDL_SCANCODE_F4:
+					reportFrameTimes();
+					break;
+#ifdef WITH_BUG_REPORT
+				case SDL_SCANCODE_F6:
+					/* 1x, 2x, ..., 64x, as fast as possible */
+					if (timeScale == 0)
+						timeScale = 1;
+					else if (timeScale == TS_MAX)
+						timeScale = 0;
+					else
+						timeScale *= 2;
+					if (timeScale != 1)
+						timeAccelerated = true;
+					break;
+#endif
 				case SDL_SCANCODE_R:
 					if (cgame.getCurrentPlayer()->getLives() > 1 ) {
 						text.clear();
@@ -302,6 +348,7 @@ void View::run()
 						if (showInfo(text, WT_YESNO)) {
 							flags |= CGF_RESTARTLEVEL;
 							ticks.reset();
+							frameStart = 0;
 						}
 					} else
 						showInfo("No life left to restart.", WT_ANYKEY);
@@ -310,6 +357,7 @@ void View::run()
 					if (!cgame.isBonusLevel()) {
 						runBrickDestroyDlg();
 						ticks.reset();
+						frameStart = 0;
 					}
 					break;
 				case SDL_SCANCODE_ESCAPE:
@@ -321,6 +369,7 @@ void View::run()
 						resumeLater = true;
 					}
 					ticks.reset();
+					frameStart = 0;
 					break;
 				default:
 					break;
@@ -386,9 +435,12 @@ void View::run()
 			pis.warp = 1;
 		if (gpadstate[GPAD_BUTTON0 + config.gp_maxballspeed])
 			pis.speedUp = 1;
+		if (demoMode)
+			pis.reset();
 
 		/* get passed time */
 		ms = ticks.get();
+		Uint64 perfStart = SDL_GetPerformanceCounter();
 
 		/* update animations and particles */
 		energyBallAlphaCounter.update(ms);
@@ -414,12 +466,14 @@ void View::run()
 		if (flags & CGF_RESTARTLEVEL)
 			flags = cgame.restartLevel();
 		else
-			flags = cgame.update(ms, rx, pis);
+			flags = updateGame(ms, rx, pis);
 		if (flags & CGF_LIFELOST) {
 			mixer.playx(theme.sLooseLife,0);
 			if (config.speech && config.badspeech && (rand()%2))
 				mixer.play((rand()%2)?theme.sDamn:theme.sDammit);
 		}
+		if (demoMode)
+			flags &= ~(CGF_LASTLIFELOST | CGF_PLAYERMESSAGE);
 		if (flags & CGF_LASTLIFELOST) {
 			text.clear();
 			text.push_back(cgame.getPlayerMessage());
@@ -440,14 +494,19 @@ void View::run()
 		if (flags & CGF_GAMEOVER)
 			break;
 		if ((flags & CGF_NEWLEVEL) || (flags & CGF_RESTARTLEVEL)) {
+			if (flags & CGF_NEWLEVEL) {
+				reportFrameTimes();
+				startFrameTimes();
+			}
 			flags |= CGF_UPDATEBACKGROUND | CGF_UPDATEBRICKS |
 					CGF_UPDATESCORE | CGF_UPDATEEXTRAS;
-			curWallpaperId = rand() % theme.numWallpapers;
+			nextWallpaper();
 			if (flags & CGF_NEWLEVEL)
 				if (!(flags & CGF_LIFELOST) && config.speech && (rand()%2))
 					mixer.play((rand()%2)?theme.sVeryGood:theme.sExcellent);
 			dim();
 			ticks.reset();
+			frameStart = 0;
 			if (!(flags & CGF_LIFELOST)) {
 				initTitleLabel();
 				showWarpIcon = false;
@@ -463,6 +522,9 @@ void View::run()
 			renderExtrasImage();
 		if (flags & CGF_UPDATESCORE)
 			renderScoreImage();
+		if (flags & (CGF_UPDATEBACKGROUND | CGF_UPDATEBRICKS |
+				CGF_UPDATEEXTRAS | CGF_UPDATESCORE))
+			renderStaticImage(flags);
 		if (flags & CGF_NEWANIMATIONS)
 			createSprites();
 		if (flags & CGF_WARPOK)
@@ -472,10 +534,18 @@ void View::run()
 
 		/* handle sounds by accessing game->mod */
 		playSounds();
+		renderStats.simTime = RenderStats::since(perfStart);
 
 		/* render */
+		renderStats.sprites = sprites.size();
+		perfStart = SDL_GetPerformanceCounter();
 		render();
+		renderStats.renderTime = RenderStats::since(perfStart);
+		perfStart = SDL_GetPerformanceCounter();
 		SDL_RenderPresent(mrc);
+		renderStats.presentTime = RenderStats::since(perfStart);
+		if (config.stats_csv)
+			writeStatsFile();
 
 		/* stats */
 		fpsCycles++;
@@ -487,14 +557,16 @@ void View::run()
 		}
 
 		/* limit frame rate */
-		delay = maxDelay - renderTicks.get(true);
-		if (delay > 0)
-			SDL_Delay(delay);
+		pacer.wait();
 		SDL_FlushEvent(SDL_MOUSEMOTION); /* prevent event loop from dying */
 	}
+	statsFile.close();
+	reportFrameTimes();
 
-	if (editor.testRequested()) {
+	if (editor.testRequested() || demoMode) {
 		/* do nothing */
+	} else if (timeAccelerated) {
+		_loginfo("Game was accelerated: no hiscore entry, not saved\n");
 	} else if (resumeLater)
 		saveGame();
 	else {
@@ -531,9 +603,7 @@ void View::render()
 		theme.shot.setAlpha(128);
 		theme.weapon.setAlpha(128);
 	} else {
-		imgBackground.copy(0,0);
-		imgScore.copy(imgScoreX,imgScoreY);
-		imgExtras.copy(imgExtrasX,imgExtrasY);
+		imgStatic.copy(0,0);
 		theme.paddles.clearAlpha();
 		theme.shot.clearAlpha();
 		theme.weapon.clearAlpha();
@@ -542,9 +612,6 @@ void View::render()
 	/* balls - shadows */
 	renderBalls(true);
 
-	if (!cgame.darknessActive())
-		imgBricks.copy(imgBricksX,imgBricksY);
-
 	/* extras - shadows */
 	list_reset(game->extras);
 	while ( ( extra = (Extra*)list_next( game->extras) ) != 0 ) {
@@ -688,22 +755,37 @@ void View::render()
 		theme.fSmall.write(0,0,to_string((int)fps));
 		//theme.fSmall.write(0,theme.fSmall.getLineHeight(),to_string((int)(cgame.getPaddleVelocity()*1000)));
 	}
+	if (config.show_stats)
+		renderStatsOverlay();
+	if (timeScale != 1) {
+		theme.fSmall.setAlign(ALIGN_X_RIGHT | ALIGN_Y_TOP);
+		theme.fSmall.write(brickScreenWidth * MAPWIDTH, 0, timeScale ?
+				"x" + to_string(timeScale) : string("max"));
+	}
 
 	if (viewport.w)
 		SDL_RenderSetViewport(mrc, NULL);
 }
 
+/** Use prefetched wallpaper for current level and prefetch another one. */
+void View::nextWallpaper()
+{
+	curWallpaperId = nextWallpaperId;
+	nextWallpaperId = rand() % theme.numWallpapers;
+	theme.prefetchWallpaper(nextWallpaperId);
+}
+
 /** Take background image, add frame and static hiscore chart */
 void View::renderBackgroundImage() {
 	int bw = theme.bricks.getGridWidth();
 	int bh = theme.bricks.getGridHeight();
 	SDL_Texture *tex = imgBackground.getTex();
 
-	SDL_SetRenderTarget(mrc,tex);
+	setRenderTarget(tex);
 	SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_BLEND);
 
 	/* wallpaper background */
-	Image& wallpaper = theme.wallpapers[curWallpaperId];
+	Image& wallpaper = theme.getWallpaper(curWallpaperId);
 	for (int wy = 0; wy < imgBackground.getHeight(); wy += wallpaper.getHeight())
 		for (int wx = 0; wx < imgBackground.getWidth(); wx += wallpaper.getWidth())
 			wallpaper.copy(wx,wy);
@@ -739,10 +821,38 @@ void View::renderBackgroundImage() {
 	for (uint i = 0; i < cp->getMaxLives(); i++)
 		theme.life.copy(0, i < cp->getLives(), 0, (MAPHEIGHT-i-1)*bh);
 
-	SDL_SetRenderTarget(mrc,NULL);
+	setRenderTarget(NULL);
 	SDL_SetTextureBlendMode(tex, SDL_BLENDMODE_NONE);
 }
 
+/** Compose background, bricks, score and extras into one image to be
+ * copied at once. Background and bricks require a full update, score and
+ * extras are only updated in their own region. */
+void View::renderStaticImage(int flags)
+{
+	setRenderTarget(imgStatic.getTex());
+	if (flags & (CGF_UPDATEBACKGROUND | CGF_UPDATEBRICKS)) {
+		imgBackground.copy(0,0);
+		imgScore.copy(imgScoreX,imgScoreY);
+		imgExtras.copy(imgExtrasX,imgExtrasY);
+		imgBricks.copy(imgBricksX,imgBricksY);
+	} else {
+		if (flags & CGF_UPDATESCORE) {
+			imgBackground.copy(imgScoreX,imgScoreY,
+					imgScore.getWidth(),imgScore.getHeight(),
+					imgScoreX,imgScoreY);
+			imgScore.copy(imgScoreX,imgScoreY);
+		}
+		if (flags & CGF_UPDATEEXTRAS) {
+			imgBackground.copy(imgExtrasX,imgExtrasY,
+					imgExtras.getWidth(),imgExtras.getHeight(),
+					imgExtrasX,imgExtrasY);
+			imgExtras.copy(imgExtrasX,imgExtrasY);
+		}
+	}
+	setRenderTarget(NULL);
+}
+
 /* Render at given region. */
 void View::renderHiscore(Font &fTitle, Font &fEntry, int x, int y, int w, int h, bool detailed)
 {
@@ -797,7 +907,7 @@ void View::renderBricksImage()
 	int bh = theme.bricks.getGridHeight();
 
 	imgBricks.fill(0,0,0,0);
-	SDL_SetRenderTarget(mrc, imgBricks.getTex());
+	setRenderTarget(imgBricks.getTex());
 
 	for (int i = 1; i < MAPWIDTH-1; i++)
 		for (int j = 1; j < MAPHEIGHT; j++) {
@@ -813,16 +923,16 @@ void View::renderBricksImage()
 				theme.bricks.copy(b->id, 0, (i-1)*bw, (j-1)*bh);
 		}
 
-	SDL_SetRenderTarget(mrc, NULL);
+	setRenderTarget(NULL);
 }
 void View::renderScoreImage()
 {
 	imgScore.fill(0,0,0,0);
-	SDL_SetRenderTarget(mrc, imgScore.getTex());
+	setRenderTarget(imgScore.getTex());
 	theme.fNormal.setAlign(ALIGN_X_CENTER | ALIGN_Y_CENTER);
 	theme.fNormal.write(imgScore.getWidth()/2, imgScore.getHeight()/2,
 				to_string(cgame.getCurrentPlayer()->getScore()));
-	SDL_SetRenderTarget(mrc, NULL);
+	setRenderTarget(NULL);
 }
 void View::renderExtrasImage()
 {
@@ -834,7 +944,7 @@ void View::renderExtrasImage()
 	uint yoff = bh + ystart;
 	uint x = xstart, y = ystart;
 
-	SDL_SetRenderTarget(mrc, imgExtras.getTex());
+	setRenderTarget(imgExtras.getTex());
 	SDL_SetRenderDrawColor(mrc,0,0,0,0);
 	SDL_RenderClear(mrc);
 
@@ -886,7 +996,7 @@ void View::renderExtrasImage()
 		renderActiveExtra(EX_GHOST_PADDLE, game->paddles[0]->extra_time[EX_GHOST_PADDLE], x, y);
 
 	theme.extras.clearAlpha();
-	SDL_SetRenderTarget(mrc, NULL);
+	setRenderTarget(NULL);
 }
 
 /** Render to current target: extra image and time in seconds */
@@ -1143,7 +1253,8 @@ void View::createMenus()
 {
 	Menu *mNewGame, *mOptions, *mAudio, *mGraphics, *mControls, *mAdv, *mEditor;
 	const char *diffNames[] = {_("Kids"),_("Very Easy"),_("Easy"),_("Medium"),_("Hard") } ;
-	const char *fpsLimitNames[] = {_("No Limit"),_("200 FPS"),_("100 FPS") } ;
+	const char *fpsLimitNames[] = {_("No Limit"),_("Display Rate"),
+			_("60 FPS"),_("120 FPS"),_("144 FPS"),_("240 FPS") } ;
 	const int bufSizes[] = { 256, 512, 1024, 2048, 4096 };
 	const int channelNums[] = { 8, 16, 32 };
 
@@ -1233,8 +1344,11 @@ void View::createMenus()
 			_("Apply the above settings."),AID_APPLYTHEMEMODE));
 	mGraphics->add(new MenuItemSep());
 	mGraphics->add(new MenuItemList(_("Frame Limit"),
-			_("Maximum number of frames per second.\nBe careful: The higher the limit the more insensitive your mouse might become to slow movements (because relative motion is used and program cycles are shorter).\n200 FPS should be a good value."),
-			AID_NONE,config.fps,fpsLimitNames,3));
+			_("Maximum number of frames per second.\nBe careful: The higher the limit the more insensitive your mouse might become to slow movements (because relative motion is used and program cycles are shorter).\n'Display Rate' should be a good value."),
+			AID_NONE,config.fps,fpsLimitNames,FPS_LIMITNUM));
+	mGraphics->add(new MenuItemSwitch(_("VSync"),
+			_("Synchronize frames with display refresh to prevent tearing. (not applied yet, use 'Apply Theme&Mode')"),
+			AID_NONE,config.vsync));
 	mGraphics->add(new MenuItemSep());
 	mGraphics->add(new MenuItemBack(mOptions));
 
@@ -1272,6 +1386,9 @@ void View::createMenus()
 	mAdv->add(new MenuItemList(_("Ball Turbo"),
 			_("'Auto' will automatically speed up your balls (the farther away from the paddle the more).\n'Manually' puts them to maximum speed while key is pressed (default key is c)."),
 			AID_NONE,config.ball_auto_turbo,_("Manually"),_("Auto")));
+	mAdv->add(new MenuItemSwitch(_("Aim Assist"),
+			_("Show the predicted path of balls up to the third contact with bricks or the paddle level."),
+			AID_NONE,config.aim_assist));
 	mAdv->add(new MenuItemList(_("Return Balls"),
 			_("'Auto' returns all idle balls (no effective brick hits) after 10 seconds to the paddle.\n'Manually' requires you to press a key (default key is Backspace).\n'Auto' is more convenient but 'Manually' might be required for (badly designed) levels where balls need to bounce around a lot."),
 			AID_NONE,config.return_on_click,_("Auto"),_("Manually")));
@@ -1285,6 +1402,9 @@ void View::createMenus()
 	mAdv->add(new MenuItemList(_("BCC Type"),
 			_("Ball Collision Check: Get ball targets either by trajectory or clipping."),
 			AID_NONE,config.bcc_type,_("Trajectory"),_("Clipping")));
+	mAdv->add(new MenuItemList(_("Ball Physics"),
+			_("'Fixed Point' moves and reflects balls with integer math only so that games and replays are exactly the same on any computer. Ball targets are then always found by clipping."),
+			AID_NONE,config.fixed_physics,_("Float"),_("Fixed Point")));
 	mAdv->add(new MenuItemSep());
 	mAdv->add(new MenuItemBack(mOptions));
 
@@ -1365,17 +1485,24 @@ void View::runMenu()
 	MenuItemSub *subItem;
 	MenuItemBack *backItem;
 	bool changingKey = false, newEvent = false, changedKey = false;
+	bool animating = false;
 	int aid = AID_NONE;
+	Uint32 idleStart = SDL_GetTicks();
 
 	curMenu = rootMenu.get();
 	curMenu->resetSelection();
 	renderMenu();
+	pacer.reset();
 
 	while (!quitReceived) {
-		/* handle events */
-		newEvent = false;
-		if (SDL_PollEvent(&ev)) {
-			newEvent = true;
+		/* handle events, block if menu is idle as nothing changes */
+		animating = curMenu->isAnimating();
+		if (animating)
+			newEvent = SDL_PollEvent(&ev);
+		else
+			newEvent = SDL_WaitEventTimeout(&ev, IDLE_TIMEOUT);
+		if (newEvent) {
+			idleStart = SDL_GetTicks();
 			changedKey = false;
 			if (ev.type == SDL_QUIT)
 				quitReceived = true;
@@ -1470,9 +1597,10 @@ void View::runMenu()
 				}
 				break;
 			case AID_STARTORIGINAL:
-				cgame.init("LBreakoutHD");
-				dim();
-				run();
+				if (initGame("LBreakoutHD")) {
+					dim();
+					run();
+				}
 				ticks.reset();
 				break;
 			case AID_STARTCUSTOM:
@@ -1483,9 +1611,10 @@ void View::runMenu()
 					 * seed to get different order of levels */
 					if (selectDlg.get() == TOURNAMENT)
 						config.freakout_seed = rand();
-					cgame.init(selectDlg.get());
-					dim();
-					run();
+					if (initGame(selectDlg.get())) {
+						dim();
+						run();
+					}
 					ticks.reset();
 				} else if (selectDlg.quitRcvd())
 					quitReceived = true;
@@ -1506,11 +1635,22 @@ void View::runMenu()
 			}
 		}
 
-		/* render */
-		renderMenu();
-		SDL_RenderPresent(mrc);
-		if (config.fps)
-			SDL_Delay(10);
+		/* show demo if idle in main menu for a while */
+		if (!newEvent && !changingKey && curMenu == rootMenu.get() &&
+				SDL_GetTicks() - idleStart >= DEMO_IDLETIME) {
+			runDemo();
+			idleStart = SDL_GetTicks();
+			ticks.reset();
+			newEvent = true; /* force render */
+		}
+
+		/* render only on input or animation */
+		if (newEvent || animating) {
+			renderMenu();
+			SDL_RenderPresent(mrc);
+			updatePacer();
+			pacer.wait();
+		}
 		SDL_FlushEvent(SDL_MOUSEMOTION); /* prevent event loop from dying */
 	}
 	dim();
@@ -1558,6 +1698,7 @@ void View::saveGame()
 		return;
 	}
 
+	ofs << "version=" << SAVEGAME_VERSION << "\n";
 	ofs << "levelset=" << cgame.getLevelsetName() << "\n";
 	ofs << "difficulty=" << config.diff << "\n";
 	ofs << "curplayer=" << cgame.getCurrentPlayerId() << "\n";
@@ -1585,6 +1726,8 @@ int View::resumeGame()
 
 	FileParser fp(saveFileName);
 	string setname;
+	uint version = 1;
+	bool restart = false;
 
 	if (!fp.get("levelset",setname)) {
 		_logerr("Save game corrupted, no levelset name.\n");
@@ -1598,14 +1741,24 @@ int View::resumeGame()
 	for (int i = 0; i < config.player_count; i++)
 		fp.get(string("player") + to_string(i) + ".name",config.player_names[i]);
 
+	/* freakout levels of old saves are in a different order since
+	 * duplicate levels are skipped, so start over with score and lives */
+	fp.get("version",version);
+	if (version < 2 && setname == TOURNAMENT) {
+		_loginfo("Saved freakout game is from an older version, restarting at first level\n");
+		restart = true;
+	}
+
 	/* initialize game to level of current player */
 	uint pid = 0;
 	fp.get("curplayer",pid);
 	if (pid >= MAX_PLAYERS)
 		pid = 0;
 	uint levid = 0;
-	fp.get(string("player") + to_string(pid) + ".level",levid);
-	cgame.init(setname,levid);
+	if (!restart)
+		fp.get(string("player") + to_string(pid) + ".level",levid);
+	if (!initGame(setname,levid))
+		return 0;
 
 	/* adjust players */
 	for (int i = 0; i < config.player_count; i++) {
@@ -1613,7 +1766,8 @@ int View::resumeGame()
 		uint level = 0, lives = 3;
 		int score = 0;
 		fp.get(prefix + "score",score);
-		fp.get(prefix + "level",level);
+		if (!restart)
+			fp.get(prefix + "level",level);
 		fp.get(prefix + "lives",lives);
 		cgame.resumePlayer(i,lives,score,level);
 	}
@@ -1622,6 +1776,70 @@ int View::resumeGame()
 	return 1;
 }
 
+/** Initialize game while levelset is loaded in background. If this
+ * takes a while, show a loading screen over current screen content.
+ * Return true if game can be run. */
+bool View::initGame(const string &setname, int levelid)
+{
+	Font &font = theme.fNormal;
+	Image img;
+	SDL_Event ev;
+	Uint32 start = SDL_GetTicks();
+	bool shown = false;
+	int tw, th;
+
+	cgame.startInit(setname);
+	while (!cgame.initReady()) {
+		/* keep window responsive, quit is handled by menu */
+		if (SDL_WaitEventTimeout(&ev, LS_POLLTIME) && ev.type == SDL_QUIT)
+			quitReceived = true;
+
+		Uint32 ms = SDL_GetTicks() - start;
+		if (ms >= LS_DELAY) {
+			if (!shown) {
+				darkenScreen();
+				img.createFromScreen();
+				shown = true;
+			}
+			/* dots are animated so keep text left aligned */
+			string text = _("Loading levels");
+			font.getTextSize(text + "...", &tw, &th);
+			text += string(ms / LS_DOTDELAY % 4, '.');
+			img.copy();
+			font.setAlign(ALIGN_X_LEFT | ALIGN_Y_CENTER);
+			font.write((mw->getWidth() - tw) / 2, mw->getHeight()/2, text);
+			SDL_RenderPresent(mrc);
+		}
+	}
+	if (cgame.finishInit(levelid) < 0) {
+		_logerr("Could not start game with levelset %s\n",setname.c_str());
+		return false;
+	}
+	return true;
+}
+
+/** Let autopilot play original levels as single player until any
+ * input. No hiscores are entered and no game is saved. */
+void View::runDemo()
+{
+	int count = config.player_count;
+
+	config.player_count = 1;
+	bool ok = initGame("LBreakoutHD");
+	config.player_count = count;
+	if (!ok)
+		return;
+
+	_loginfo("Starting demo\n");
+	cgame.setAutopilot(BOT_HARD);
+	demoMode = true;
+	dim();
+	run();
+	demoMode = false;
+	cgame.setAutopilot(-1);
+	waitForInputRelease();
+}
+
 void View::showFinalHiscores()
 {
 	int x, y, w, h;
@@ -1652,21 +1870,21 @@ int View::waitForKey(int type)
 	SDL_PumpEvents();
 	SDL_FlushEvents(SDL_FIRSTEVENT,SDL_LASTEVENT);
 	while (!leave) {
-		/* handle events */
-		if (SDL_PollEvent(&ev)) {
+		/* handle events, screen is static so only redraw if needed */
+		if (SDL_WaitEventTimeout(&ev, IDLE_TIMEOUT)) {
 			if (ev.type == SDL_QUIT)
 				quitReceived = leave = true;
-			else if (ev.type == SDL_KEYUP) {
+			else if (ev.type == SDL_WINDOWEVENT) {
+				/* window contents might be lost */
+				sshot.copy();
+				SDL_RenderPresent(mrc);
+			} else if (ev.type == SDL_KEYUP) {
 				if (type == WT_ANYKEY || (type == WT_PAUSE &&
 						ev.key.keysym.scancode == SDL_SCANCODE_P))
 					leave = true;
 			} else if (ev.type == SDL_MOUSEBUTTONUP && type == WT_ANYKEY)
 				leave = true;
 		}
-
-		SDL_Delay(20);
-		sshot.copy();
-		SDL_RenderPresent(mrc);
 		SDL_FlushEvent(SDL_MOUSEMOTION);
 	}
 	SDL_FlushEvents(SDL_FIRSTEVENT,SDL_LASTEVENT);
@@ -1691,6 +1909,32 @@ void View::initTitleLabel()
 	lblTitleCounter.init(SCT_ONCE, 0, 5, 1000);
 }
 
+/** Draw predicted path of ball as dotted line until third contact. */
+void View::renderBallPath(Ball *ball)
+{
+	BallContact contacts[3];
+	int bradius = balls_get_radius();
+	int count = ball_predict(ball, contacts, 3);
+	Vec pos(ball->cur.x + bradius, ball->cur.y + bradius);
+
+	SDL_SetRenderDrawBlendMode(mrc,SDL_BLENDMODE_BLEND);
+	SDL_SetRenderDrawColor(mrc,255,255,255,128);
+	for (int i = 0; i < count; i++) {
+		Vec dest(contacts[i].x + bradius, contacts[i].y + bradius);
+		Vec dmod(dest.getX() - pos.getX(), dest.getY() - pos.getY());
+		double pathlen = dmod.getLength();
+		dmod.normalize();
+		for (int j = 0; j < pathlen; j += 2*bradius) {
+			SDL_Rect dotrect = {(int)v2s(pos.getX())-1,
+					(int)v2s(pos.getY())-1,2,2};
+			SDL_RenderFillRect(mrc, &dotrect);
+			pos.add(2*bradius, dmod);
+		}
+		pos = dest;
+	}
+	SDL_SetRenderDrawBlendMode(mrc,SDL_BLENDMODE_NONE);
+}
+
 void View::renderBalls(bool shadow)
 {
 	Game *game = cgame.getGameContext();
@@ -1713,6 +1957,8 @@ void View::renderBalls(bool shadow)
 		} else {
 			theme.balls.setAlpha(alpha);
 			theme.balls.copy(type,0,px,py);
+			if (config.aim_assist)
+				renderBallPath(ball);
 #ifdef WITH_BUG_REPORT
 			if (ball->target.exists) {
 				/* draw trajectory as dotted line, start at target
@@ -1755,11 +2001,14 @@ void View::updateResumeGameTooltip()
 	/* XXX multiple locations... */
 	const char *diffNames[] = {_("Kids"),_("Very Easy"),_("Easy"),_("Medium"),_("Hard") } ;
 	string text, str;
-	uint diff, pnum;
+	uint diff, pnum, version = 1;
+	bool restart;
 	FileParser fp(saveFileName);
 	fp.get("levelset",text);
 	fp.get("difficulty",diff);
 	fp.get("players",pnum);
+	fp.get("version",version);
+	restart = (version < 2 && text == TOURNAMENT); /* see resumeGame() */
 	text += " - ";
 	if (diff < DIFF_COUNT)
 		text += diffNames[diff];
@@ -1774,7 +2023,8 @@ void View::updateResumeGameTooltip()
 		int score = 0;
 		fp.get(prefix + "name",name);
 		fp.get(prefix + "score",score);
-		fp.get(prefix + "level",level);
+		if (!restart)
+			fp.get(prefix + "level",level);
 		fp.get(prefix + "lives",lives);
 		text += name + ": " + to_string(score) + _("  (Lvl: ")
 				+ to_string(level+1) + ")";
@@ -1978,3 +2228,172 @@ void View::getNewShinePosition()
 		pos--; /* should always terminate but we make sure */
 	}
 }
+
+/** Update game by 'ms' of real time multiplied by timeScale. If
+ * accelerated, the game is updated in steps of TS_STEP ms to keep
+ * collision checks as precise as at normal speed; as fast as possible
+ * runs steps until TS_BUDGET ms of real time are used. Stops early if
+ * the view has to handle a level change, life loss or message or after
+ * TS_MAX_STEPS updates. Only the modifications of the last step are
+ * available for sounds and sprites. */
+int View::updateGame(Uint32 ms, double rx, PaddleInputState &pis)
+{
+	Uint64 start = SDL_GetPerformanceCounter();
+	Uint64 budget = SDL_GetPerformanceFrequency() * TS_BUDGET / 1000;
+	Uint32 left = ms * timeScale, step;
+	int flags = 0;
+
+	timeSteps = 1;
+	if (timeScale == 1)
+		return cgame.update(ms, rx, pis);
+
+	for (timeSteps = 0; ; ) {
+		if (timeScale == 0) {
+			if (timeSteps > 0 && SDL_GetPerformanceCounter() - start >= budget)
+				break;
+			step = TS_STEP;
+		} else {
+			if (left == 0)
+				break;
+			step = (left < TS_STEP) ? left : TS_STEP;
+			left -= step;
+		}
+		if (timeSteps == TS_MAX_STEPS)
+			break;
+		flags |= cgame.update(step, rx, pis);
+		timeSteps++;
+		if (config.rel_motion)
+			rx = 0; /* relative motion is only applied once */
+		if (flags & (CGF_NEWLEVEL | CGF_GAMEOVER | CGF_LIFELOST |
+				CGF_PLAYERMESSAGE))
+			break;
+	}
+	return flags;
+}
+
+/** Render statistics of last frame to upper left corner (below fps).
+ * The overlay itself is not counted in the statistics it shows. */
+void View::renderStatsOverlay()
+{
+	RenderStats frame = renderStats; /* counters before overlay */
+	vector<string> lines;
+	string str;
+	int x = 0, y = 0;
+
+	strprintf(str, "draw calls: %d", lastStats.drawCalls);
+	lines.push_back(str);
+	strprintf(str, "target switches: %d", lastStats.targetSwitches);
+	lines.push_back(str);
+	strprintf(str, "textures: +%d -%d (%d)", lastStats.texCreated,
+				lastStats.texDestroyed, lastStats.texLive);
+	lines.push_back(str);
+	strprintf(str, "text renders: %d", lastStats.textRenders);
+	lines.push_back(str);
+	strprintf(str, "sprites: %d", lastStats.sprites);
+	lines.push_back(str);
+	strprintf(str, "sim: %.2f ms (%d steps)", lastStats.simTime, timeSteps);
+	lines.push_back(str);
+	strprintf(str, "render: %.2f ms", lastStats.renderTime);
+	lines.push_back(str);
+	strprintf(str, "present: %.2f ms", lastStats.presentTime);
+	lines.push_back(str);
+
+	if (config.show_fps)
+		y += theme.fSmall.getLineHeight();
+	theme.fSmall.setAlign(ALIGN_X_LEFT | ALIGN_Y_TOP);
+	for (auto &l : lines) {
+		theme.fSmall.write(x, y, l);
+		y += theme.fSmall.getLineHeight();
+	}
+
+	frame.texLive = renderStats.texLive;
+	renderStats = frame;
+}
+
+/** Open CSV file in config directory for render statistics. New rows
+ * are appended, header is only written for a new file. */
+void View::openStatsFile()
+{
+	string fname = config.dname + "/stats.csv";
+	bool isNew = !fileExists(fname);
+
+	if (statsFile.is_open())
+		return;
+	statsFile.open(fname, ios::app);
+	if (!statsFile.is_open()) {
+		_logerr("Could not open stats file %s\n", fname.c_str());
+		config.stats_csv = 0;
+		return;
+	}
+	_loginfo("Writing render statistics to %s\n", fname.c_str());
+	if (isNew)
+		statsFile << "ticks,drawcalls,targetswitches,texcreated,"
+				"texdestroyed,texlive,textrenders,sprites,"
+				"sim,render,present\n";
+}
+
+/** Append render statistics of current frame to CSV file. */
+void View::writeStatsFile()
+{
+	if (!statsFile.is_open())
+		return;
+	statsFile << SDL_GetTicks() << ","
+			<< renderStats.drawCalls << ","
+			<< renderStats.targetSwitches << ","
+			<< renderStats.texCreated << ","
+			<< renderStats.texDestroyed << ","
+			<< renderStats.texLive << ","
+			<< renderStats.textRenders << ","
+			<< renderStats.sprites << ","
+			<< renderStats.simTime << ","
+			<< renderStats.renderTime << ","
+			<< renderStats.presentTime << "\n";
+}
+
+/** Clear frame times and remember level name for report. */
+void View::startFrameTimes()
+{
+	string author;
+
+	frameTimes.reset();
+	frameStart = 0;
+	cgame.getCurrentLevelNameAndAuthor(frameTimesLevel, author);
+}
+
+/** Print frame time report of current level to stdout and append it to
+ * frametimes.log in config directory if enabled. */
+void View::reportFrameTimes()
+{
+	string str;
+
+	if (frameTimes.getCount() == 0)
+		return;
+
+	frameTimes.getReport(str);
+	_loginfo("Frame times for %s: %s\n", frameTimesLevel.c_str(), str.c_str());
+	if (!config.frametime_log)
+		return;
+
+	string fname = config.dname + "/frametimes.log";
+	ofstream ofs(fname, ios::app);
+	if (!ofs.is_open()) {
+		_logerr("Could not open %s\n", fname.c_str());
+		return;
+	}
+	ofs << cgame.getLevelsetName() << ": " << frameTimesLevel << ": " << str << "\n";
+}
+
+/** Set frame pacer according to frame limit and vsync settings. */
+void View::updatePacer()
+{
+	const int rates[FPS_LIMITNUM] = { 0, 0, 60, 120, 144, 240 };
+	int displayRate = mw->getRefreshRate();
+	int rate = 0;
+
+	if (config.fps == FPS_DISPLAY)
+		rate = displayRate;
+	else if (config.fps > 0 && config.fps < FPS_LIMITNUM)
+		rate = rates[config.fps];
+	/* vsync is only active if window was created with it */
+	pacer.setRate(rate, config.vsync && mw->vsync, displayRate);
+}
@@ -30,10 +30,37 @@ enum {
 	MIX_CHANNELNUM = 16,
 	MIX_CUNKSIZE = 2048,
 
+	/* frame limits (config.fps) */
+	FPS_NOLIMIT = 0,
+	FPS_DISPLAY,
+	FPS_60,
+	FPS_120,
+	FPS_144,
+	FPS_240,
+	FPS_LIMITNUM,
+
 	/* waitForKey types */
 	WT_ANYKEY = 0,
 	WT_YESNO,
-	WT_PAUSE
+	WT_PAUSE,
+
+	/* loading screen */
+	LS_DELAY = 100, /* show only if loading takes longer */
+	LS_DOTDELAY = 250,
+	LS_POLLTIME = 10, /* max wait for events before checking loader */
+
+	/* attract mode */
+	DEMO_IDLETIME = 30000, /* menu idle time before demo starts */
+	DEMO_MOTIONLIMIT = 4, /* mouse motion in pixels ignored as jitter */
+
+	/* saved game format, 2 = freakout without duplicate levels */
+	SAVEGAME_VERSION = 2,
+
+	/* time-accelerated simulation (bug report builds only) */
+	TS_MAX = 64, /* highest speed multiplier, next is as fast as possible */
+	TS_STEP = 10, /* ms per game update when accelerated */
+	TS_BUDGET = 12, /* ms of real time per frame for as fast as possible */
+	TS_MAX_STEPS = 200 /* game updates per frame, e.g. after a long frame */
 };
 
 class View {
@@ -45,6 +72,7 @@ class View {
 	SDL_Rect viewport; /* used if width not 0 */
 	Gamepad gamepad;
 	Editor editor;
+	FramePacer pacer;
 
 	/* menu */
 	unique_ptr<Menu> rootMenu;
@@ -62,11 +90,16 @@ class View {
 	Uint32 brickScreenWidth, brickScreenHeight;
 	int scaleFactor; // *100, e.g., 140 means 1.4
 	bool quitReceived;
+	bool demoMode; /* game is played by autopilot until any input */
+	int timeScale; /* game speed multiplier, 0 = as fast as possible */
+	int timeSteps; /* game updates in last frame */
+	bool timeAccelerated; /* game was sped up: no hiscore entry or save */
 	/* render parts */
 	Label lblTitle;
 	SmoothCounter lblTitleCounter;
 	Label lblInfo; /* for mini games */
 	int curWallpaperId;
+	int nextWallpaperId; /* prefetched for next level */
 	Image imgBackground;
 	Image imgBricks;
 	int imgBricksX, imgBricksY;
@@ -74,6 +107,7 @@ class View {
 	int imgScoreX, imgScoreY;
 	Image imgExtras;
 	int imgExtrasX, imgExtrasY;
+	Image imgStatic; /* background, bricks, score and extras composed */
 	Image imgFloor; /* extra wall at bottom */
 	int imgFloorX, imgFloorY;
 	FrameCounter weaponFrameCounter;
@@ -89,18 +123,26 @@ class View {
 	/* stats */
 	Uint32 fpsCycles, fpsStart;
 	double fps;
+	RenderStats lastStats; /* render stats of last complete frame */
+	ofstream statsFile;
+	FrameTimeHistogram frameTimes; /* of current level */
+	Uint64 frameStart; /* 0 if current frame is not measured */
+	string frameTimesLevel;
 
 	int v2s(int i) { return i * scaleFactor / 100; }
 	int s2v(int i) { return i * 100 / scaleFactor; }
 	double v2s(double d) { return d * scaleFactor / 100; }
 	double s2v(double d) { return d * 100 / scaleFactor; }
 	void renderBackgroundImage();
+	void nextWallpaper();
 	void renderHiscore(Font &fTitle, Font &fEntry, int x, int y, int w, int h, bool detailed);
 	void renderBricksImage();
 	void renderScoreImage();
 	void renderExtrasImage();
+	void renderStaticImage(int flags);
 	void renderActiveExtra(int id, int ms, int x, int y);
 	void renderBalls(bool shadow = false);
+	void renderBallPath(Ball *ball);
 	void dim();
 	bool showInfo(const string &line, int type=WT_ANYKEY);
 	bool showInfo(const vector<string> &text, int type=WT_ANYKEY);
@@ -113,6 +155,8 @@ class View {
 	void grabInput(int grab);
 	void saveGame();
 	int resumeGame();
+	bool initGame(const string &setname, int levelid = 0);
+	void runDemo();
 	void showFinalHiscores();
 	int waitForKey(int type);
 	void darkenScreen(int alpha = 32);
@@ -122,6 +166,13 @@ class View {
 	void runBrickDestroyDlg();
 	void waitForInputRelease();
 	void getNewShinePosition();
+	void updatePacer();
+	void renderStatsOverlay();
+	int updateGame(Uint32 ms, double rx, PaddleInputState &pis);
+	void openStatsFile();
+	void writeStatsFile();
+	void startFrameTimes();
+	void reportFrameTimes();
 	void handleEditor(int type);
 public:
 	View(Config &cfg, ClientGame &_cg);